@@ -234,6 +234,8 @@ enum class Algo {
   kStd,
   kVQSort,
   kHeap,
+  kVQRadix,
+  kVQSample,
 };
 
 const char* AlgoName(Algo algo) {
@@ -268,6 +270,10 @@ const char* AlgoName(Algo algo) {
       return "vq";
     case Algo::kHeap:
       return "heap";
+    case Algo::kVQRadix:
+      return "vqradix";
+    case Algo::kVQSample:
+      return "vqsample";
   }
   return "unreachable";
 }
@@ -589,6 +595,20 @@ void CallHeapSort(KeyType* HWY_RESTRICT keys, const size_t num_keys) {
   }
 }
 
+template <class Order>
+void CallHeapSort(K32V32* HWY_RESTRICT keys, const size_t num_keys) {
+  using detail::SharedTraits;
+  using detail::TraitsLane;
+  uint64_t* lanes = reinterpret_cast<uint64_t*>(keys);
+  if (Order().IsAscending()) {
+    const SharedTraits<TraitsLane<detail::OrderAscendingKV64>> st;
+    return detail::HeapSort(st, lanes, num_keys);
+  } else {
+    const SharedTraits<TraitsLane<detail::OrderDescendingKV64>> st;
+    return detail::HeapSort(st, lanes, num_keys);
+  }
+}
+
 #if VQSORT_ENABLED
 template <class Order>
 void CallHeapSort(hwy::uint128_t* HWY_RESTRICT keys, const size_t num_keys) {
@@ -621,6 +641,112 @@ void CallHeapSort(K64V64* HWY_RESTRICT keys, const size_t num_keys) {
 }
 #endif  // VQSORT_ENABLED
 
+// Radix sorts regardless of how many passes are required, for comparison with
+// vqsort, which only does so if its sample predicts a speedup. Returns false if
+// the key type is not supported by radix sort.
+template <class Traits, typename T,
+          hwy::EnableIf<detail::RadixOrder<Traits>::kEnabled>* = nullptr>
+bool CallRadixSortTraits(Traits st, T* HWY_RESTRICT keys, size_t num_keys) {
+  const SortTag<T> d;
+  auto buf = hwy::AllocateAligned<T>(Lanes(d));
+  constexpr size_t kAllDigits = sizeof(T) * 8 / RadixConstants::kDigitBits;
+  return detail::RadixSort(d, st, keys, num_keys, buf.get(), kAllDigits);
+}
+
+template <class Traits, typename T,
+          hwy::EnableIf<!detail::RadixOrder<Traits>::kEnabled>* = nullptr>
+bool CallRadixSortTraits(Traits /* st */, T* HWY_RESTRICT /* keys */,
+                         size_t /* num_keys */) {
+  return false;
+}
+
+template <class Order, typename KeyType, HWY_IF_NOT_LANE_SIZE(KeyType, 16)>
+bool CallRadixSort(KeyType* HWY_RESTRICT keys, const size_t num_keys) {
+  using detail::SharedTraits;
+  using detail::TraitsLane;
+  if (Order().IsAscending()) {
+    const SharedTraits<TraitsLane<detail::OrderAscending<KeyType>>> st;
+    return CallRadixSortTraits(st, keys, num_keys);
+  } else {
+    const SharedTraits<TraitsLane<detail::OrderDescending<KeyType>>> st;
+    return CallRadixSortTraits(st, keys, num_keys);
+  }
+}
+
+template <class Order>
+bool CallRadixSort(K32V32* HWY_RESTRICT /* keys */, size_t /* num_keys */) {
+  return false;
+}
+
+template <class Order>
+bool CallRadixSort(hwy::uint128_t* HWY_RESTRICT /* keys */,
+                   size_t /* num_keys */) {
+  return false;
+}
+
+template <class Order>
+bool CallRadixSort(K64V64* HWY_RESTRICT /* keys */, size_t /* num_keys */) {
+  return false;
+}
+
+// Samplesorts regardless of the input size and whether vqsort would do so on
+// this target (see UseSampleSort). Returns false if the key type is not
+// supported or the sample has too few distinct keys.
+template <class Traits, typename T,
+          hwy::EnableIf<detail::SampleSortOrder<Traits>::kEnabled>* = nullptr>
+bool CallSampleSortTraits(Traits st, T* HWY_RESTRICT keys, size_t num_keys) {
+#if VQSORT_ENABLED
+  const CappedTag<T, detail::kMaxSortLanes> d;
+  auto buf = hwy::AllocateAligned<T>(SortConstants::BufNum<T>(Lanes(d)));
+  detail::Generator rng(keys, num_keys);
+  detail::NoStats stats;
+  return num_keys >= 2 &&
+         detail::SampleSortWithBuf(d, st, keys, num_keys, buf.get(),
+                                   Sorter::Tuning(), rng, stats);
+#else
+  (void)st;
+  (void)keys;
+  (void)num_keys;
+  return false;
+#endif
+}
+
+template <class Traits, typename T,
+          hwy::EnableIf<!detail::SampleSortOrder<Traits>::kEnabled>* = nullptr>
+bool CallSampleSortTraits(Traits /* st */, T* HWY_RESTRICT /* keys */,
+                          size_t /* num_keys */) {
+  return false;
+}
+
+template <class Order, typename KeyType, HWY_IF_NOT_LANE_SIZE(KeyType, 16)>
+bool CallSampleSort(KeyType* HWY_RESTRICT keys, const size_t num_keys) {
+  using detail::SharedTraits;
+  using detail::TraitsLane;
+  if (Order().IsAscending()) {
+    const SharedTraits<TraitsLane<detail::OrderAscending<KeyType>>> st;
+    return CallSampleSortTraits(st, keys, num_keys);
+  } else {
+    const SharedTraits<TraitsLane<detail::OrderDescending<KeyType>>> st;
+    return CallSampleSortTraits(st, keys, num_keys);
+  }
+}
+
+template <class Order>
+bool CallSampleSort(K32V32* HWY_RESTRICT /* keys */, size_t /* num_keys */) {
+  return false;
+}
+
+template <class Order>
+bool CallSampleSort(hwy::uint128_t* HWY_RESTRICT /* keys */,
+                    size_t /* num_keys */) {
+  return false;
+}
+
+template <class Order>
+bool CallSampleSort(K64V64* HWY_RESTRICT /* keys */, size_t /* num_keys */) {
+  return false;
+}
+
 template <class Order, typename KeyType>
 void Run(Algo algo, KeyType* HWY_RESTRICT inout, size_t num,
          SharedState& shared, size_t thread) {
@@ -702,6 +828,20 @@ void Run(Algo algo, KeyType* HWY_RESTRICT inout, size_t num,
     case Algo::kHeap:
       return CallHeapSort<Order>(inout, num);
 
+    case Algo::kVQRadix:
+      // Other key types are not supported by radix sort; use vqsort instead.
+      if (!CallRadixSort<Order>(inout, num)) {
+        return shared.tls[thread].sorter(inout, num, Order());
+      }
+      return;
+
+    case Algo::kVQSample:
+      // Falls back to vqsort, as above.
+      if (!CallSampleSort<Order>(inout, num)) {
+        return shared.tls[thread].sorter(inout, num, Order());
+      }
+      return;
+
     default:
       HWY_ABORT("Not implemented");
   }
@@ -85,11 +85,11 @@ HWY_NOINLINE void BenchPartition() {
       // do so that the performance (influenced by prefetching and branch
       // prediction) is likely to predict the actual performance inside vqsort.
       const auto pivot = detail::ChoosePivot(d, st, aligned.get(), 0, num_lanes,
-                                             buf.get(), rng);
+                                             buf.get(), Sorter::Tuning(), rng);
 
       const Timestamp t0;
       detail::Partition(d, st, aligned.get(), 0, num_lanes - 1, pivot,
-                        buf.get());
+                        buf.get(), Sorter::Tuning());
       seconds.push_back(SecondsSince(t0));
       // 'Use' the result to prevent optimizing out the partition.
       sum += static_cast<double>(aligned.get()[num_lanes / 2]);
@@ -210,6 +210,8 @@ std::vector<Algo> AlgoForBench() {
 #endif
 	//Algo::kStd,
         Algo::kVQSort,  // only ~4x slower, but not required for Table 1a
+        Algo::kVQRadix,
+        Algo::kVQSample,
 #endif
   };
 }
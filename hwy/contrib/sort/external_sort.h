@@ -0,0 +1,100 @@
+// Copyright 2022 Google LLC
+// SPDX-License-Identifier: Apache-2.0
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//      http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+// Out-of-core sorting of key files larger than memory. The input is split into
+// runs that fit within a memory budget, each sorted with Sorter and written to
+// a temporary file. The runs are then merged by a tree of streaming two-way
+// merges, each of which uses the vectorized Sorter::Merge. All file accesses
+// are large and sequential.
+
+#ifndef HIGHWAY_HWY_CONTRIB_SORT_EXTERNAL_SORT_H_
+#define HIGHWAY_HWY_CONTRIB_SORT_EXTERNAL_SORT_H_
+
+#include <stddef.h>
+#include <stdint.h>
+
+#include <string>
+
+#include "hwy/base.h"
+#include "hwy/contrib/sort/vqsort.h"
+
+namespace hwy {
+
+// Statistics about one ExternalSorter call, for tuning the memory budget.
+struct ExternalSortStats {
+  // Sorted runs written to temporary files; zero if the input fit into a
+  // single run, which is written directly to the output.
+  uint64_t runs = 0;
+  // Passes over all keys during merging. More than one means the number of
+  // runs exceeded the fan-in the budget allows.
+  uint64_t merge_passes = 0;
+  // Total bytes read from and written to files, including the input file (if
+  // any), output and temporary files.
+  uint64_t bytes_read = 0;
+  uint64_t bytes_written = 0;
+};
+
+// Sorts native-endian arrays of keys of type T, which may be uint16_t,
+// uint32_t, uint64_t, int16_t, int32_t, int64_t, float, double, uint128_t,
+// K64V64 or K32V32, i.e. the types supported by Sorter::Merge. Not
+// thread-safe: use one instance per thread.
+class HWY_CONTRIB_DLLEXPORT ExternalSorter {
+ public:
+  // Budgets below this are raised to it.
+  static constexpr size_t kMinMemoryBudget = size_t{64} << 10;
+
+  // The temporary directory defaults to $TMPDIR, or else $TEMP, or else /tmp.
+  // The memory budget defaults to 256 MiB.
+  ExternalSorter();
+
+  // Directory in which to create temporary run files. They are deleted before
+  // returning, also on failure. Their total size is that of the input.
+  void SetTempDir(const char* dir) { temp_dir_ = dir; }
+  const std::string& TempDir() const { return temp_dir_; }
+
+  // Upper bound on the bytes of memory allocated for keys. Each run consists of
+  // `budget / sizeof(T)` keys. During merging, the budget is split into
+  // per-run input blocks and the buffers of the merge tree. Larger budgets
+  // reduce the number of runs and thus merge passes, and increase the size of
+  // each file access.
+  void SetMemoryBudget(size_t bytes) {
+    budget_ = HWY_MAX(bytes, kMinMemoryBudget);
+  }
+  size_t MemoryBudget() const { return budget_; }
+
+  // Sorts the keys in the file at `in_path` and writes them to `out_path`,
+  // which may be the same file. Returns false if a file could not be opened,
+  // read or written, or if the input size is not a multiple of sizeof(T). If
+  // `stats` is non-null, it is overwritten.
+  template <typename T, class Order>
+  bool SortFile(const char* in_path, const char* out_path, Order order,
+                ExternalSortStats* stats = nullptr) const;
+
+  // As above, but reads the input from keys[0, n), which are not modified. This
+  // is also useful for memory-mapped files, whose pages are only read once,
+  // and sequentially.
+  template <typename T, class Order>
+  bool Sort(const T* HWY_RESTRICT keys, size_t n, const char* out_path,
+            Order order, ExternalSortStats* stats = nullptr) const;
+
+ private:
+  Sorter sorter_;
+  std::string temp_dir_;
+  size_t budget_;
+};
+
+}  // namespace hwy
+
+#endif  // HIGHWAY_HWY_CONTRIB_SORT_EXTERNAL_SORT_H_
@@ -0,0 +1,257 @@
+// Copyright 2022 Google LLC
+// SPDX-License-Identifier: Apache-2.0
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//      http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+// Normal include guard for target-independent parts
+#ifndef HIGHWAY_HWY_CONTRIB_SORT_RADIX_INL_H_
+#define HIGHWAY_HWY_CONTRIB_SORT_RADIX_INL_H_
+
+#include <string.h>  // memcpy
+
+#include "hwy/aligned_allocator.h"
+#include "hwy/base.h"
+
+namespace hwy {
+
+// Least-significant digit radix sort: constants shared by all targets.
+struct RadixConstants {
+  // 8-bit digits keep the histograms and scatter destinations (one per bucket)
+  // within L1 and the TLB.
+  static constexpr size_t kDigitBits = 8;
+  static constexpr size_t kBuckets = size_t{1} << kDigitBits;
+
+  // Below this, the input fits in L2 and vqsort is faster than even a single
+  // scatter pass plus the O(n) allocation.
+  static constexpr size_t kMinKeys = size_t{1} << 17;
+};
+
+}  // namespace hwy
+
+#endif  // HIGHWAY_HWY_CONTRIB_SORT_RADIX_INL_H_
+
+// Per-target
+#if defined(HIGHWAY_HWY_CONTRIB_SORT_RADIX_TOGGLE) == \
+    defined(HWY_TARGET_TOGGLE)
+#ifdef HIGHWAY_HWY_CONTRIB_SORT_RADIX_TOGGLE
+#undef HIGHWAY_HWY_CONTRIB_SORT_RADIX_TOGGLE
+#else
+#define HIGHWAY_HWY_CONTRIB_SORT_RADIX_TOGGLE
+#endif
+
+#include "hwy/contrib/sort/shared-inl.h"
+#include "hwy/contrib/sort/sorting_networks-inl.h"  // SharedTraits
+#include "hwy/contrib/sort/traits-inl.h"
+#include "hwy/highway.h"
+
+HWY_BEFORE_NAMESPACE();
+namespace hwy {
+namespace HWY_NAMESPACE {
+namespace detail {
+
+// ------------------------------ RadixOrder
+
+// Radix sort requires that the bits of a lane determine its order, which is
+// the case for integer keys. Floating-point, 128-bit and key-value types are
+// only sorted by vqsort.
+template <class Traits>
+struct RadixOrder {
+  static constexpr bool kEnabled = false;
+};
+
+template <typename T>
+struct RadixOrder<SharedTraits<TraitsLane<OrderAscending<T>>>> {
+  static constexpr bool kEnabled = !IsFloat<T>() && sizeof(T) >= 4;
+
+  // XOR-ing a key with this yields an unsigned integer with the same order.
+  static constexpr MakeUnsigned<T> Flip() {
+    return IsSigned<T>() ? SignMask<T>() : MakeUnsigned<T>{0};
+  }
+};
+
+template <typename T>
+struct RadixOrder<SharedTraits<TraitsLane<OrderDescending<T>>>> {
+  static constexpr bool kEnabled = !IsFloat<T>() && sizeof(T) >= 4;
+
+  // As above, but also inverts all bits so that ascending unsigned order is
+  // descending key order.
+  static constexpr MakeUnsigned<T> Flip() {
+    return static_cast<MakeUnsigned<T>>(
+        ~(IsSigned<T>() ? SignMask<T>() : MakeUnsigned<T>{0}));
+  }
+};
+
+// ------------------------------ DifferingBits
+
+// Returns the bits that are not the same in all `keys`. `buf` must hold at
+// least one vector.
+template <class D, typename T = TFromD<D>>
+HWY_NOINLINE T DifferingBits(D d, const T* HWY_RESTRICT keys, size_t num,
+                             T* HWY_RESTRICT buf) {
+  const size_t N = Lanes(d);
+  HWY_DASSERT(num != 0);
+  const Vec<D> first = Set(d, keys[0]);
+
+  // Two accumulators hide the latency of Or.
+  Vec<D> diff0 = Zero(d);
+  Vec<D> diff1 = Zero(d);
+  size_t i = 0;
+  if (num >= 2 * N) {
+    for (; i <= num - 2 * N; i += 2 * N) {
+      diff0 = Or(diff0, Xor(first, LoadU(d, keys + i)));
+      diff1 = Or(diff1, Xor(first, LoadU(d, keys + i + N)));
+    }
+  }
+  StoreU(Or(diff0, diff1), d, buf);
+
+  T diff = 0;
+  for (size_t j = 0; j < N; ++j) {
+    diff |= buf[j];
+  }
+  for (; i < num; ++i) {
+    diff |= static_cast<T>(keys[0] ^ keys[i]);
+  }
+  return diff;
+}
+
+// Returns a bit for each digit (0 = least-significant) that varies in `diff`.
+template <typename TU>
+HWY_INLINE uint32_t VaryingDigits(TU diff) {
+  constexpr size_t kDigits = sizeof(TU) * 8 / RadixConstants::kDigitBits;
+  uint32_t digits = 0;
+  for (size_t p = 0; p < kDigits; ++p) {
+    if ((diff >> (p * RadixConstants::kDigitBits)) &
+        (RadixConstants::kBuckets - 1)) {
+      digits |= 1u << p;
+    }
+  }
+  return digits;
+}
+
+// ------------------------------ RadixSort
+
+// Sorts `keys[0..num-1]` by scattering them into `kBuckets` buckets per digit,
+// starting with the least-significant. Digits that are the same in all keys
+// (determined by a vectorized scan) are skipped. Returns false without
+// modifying `keys` if more than `max_passes` are required or the O(num)
+// scratch space cannot be allocated. `buf` must hold at least one vector.
+//
+// `st` must be one of the RadixOrder specializations for which kEnabled.
+template <class D, class Traits, typename T>
+bool RadixSort(D /* d */, Traits /* st */, T* HWY_RESTRICT keys, size_t num,
+               T* HWY_RESTRICT buf, size_t max_passes) {
+  static_assert(RadixOrder<Traits>::kEnabled, "Radix sort requires int keys");
+  using TU = MakeUnsigned<T>;
+  constexpr size_t kBuckets = RadixConstants::kBuckets;
+  constexpr size_t kDigits = sizeof(T) * 8 / RadixConstants::kDigitBits;
+  if (num < 2) return true;
+
+  // Integers of the same size may alias their unsigned counterpart.
+  TU* HWY_RESTRICT bits = reinterpret_cast<TU*>(keys);
+  const RebindToUnsigned<D> du;
+  const uint32_t varying = VaryingDigits(
+      DifferingBits(du, bits, num, reinterpret_cast<TU*>(buf)));
+  const size_t num_passes = PopCount(varying);
+  if (num_passes > max_passes) return false;
+  if (num_passes == 0) return true;  // all equal
+
+  size_t shifts[kDigits];
+  size_t pass = 0;
+  for (size_t p = 0; p < kDigits; ++p) {
+    if (varying & (1u << p)) {
+      shifts[pass++] = p * RadixConstants::kDigitBits;
+    }
+  }
+
+  auto scratch = hwy::AllocateAligned<TU>(num);
+  if (!scratch) return false;
+
+  // Histograms for all passes in a single read of the input.
+  const TU flip = RadixOrder<Traits>::Flip();
+  size_t counts[kDigits][kBuckets] = {};
+  for (size_t i = 0; i < num; ++i) {
+    const TU key = static_cast<TU>(bits[i] ^ flip);
+    for (size_t p = 0; p < num_passes; ++p) {
+      counts[p][(key >> shifts[p]) & (kBuckets - 1)] += 1;
+    }
+  }
+
+  // Stable scatter, alternating between keys and scratch.
+  TU* from = bits;
+  TU* to = scratch.get();
+  for (size_t p = 0; p < num_passes; ++p) {
+    // Exclusive prefix sum: where to write the next key of each bucket.
+    size_t next[kBuckets];
+    size_t sum = 0;
+    for (size_t b = 0; b < kBuckets; ++b) {
+      next[b] = sum;
+      sum += counts[p][b];
+    }
+
+    const size_t shift = shifts[p];
+    for (size_t i = 0; i < num; ++i) {
+      const TU key = from[i];
+      const size_t bucket = ((key ^ flip) >> shift) & (kBuckets - 1);
+      to[next[bucket]++] = key;
+    }
+    TU* tmp = from;
+    from = to;
+    to = tmp;
+  }
+
+  if (from != bits) {
+    memcpy(bits, from, num * sizeof(TU));
+  }
+  return true;
+}
+
+// ------------------------------ MaybeRadixSort
+
+// Called by Sort with the `sample_bits` from ChoosePivot. Returns whether the
+// keys were sorted, which is only the case for large inputs of integer keys for
+// which the sample predicts at most `max_passes`; see SortTuning.
+template <class D, class Traits, typename T,
+          hwy::EnableIf<RadixOrder<Traits>::kEnabled>* = nullptr>
+bool MaybeRadixSort(D d, Traits st, T* HWY_RESTRICT keys, size_t num,
+                    Vec<D> sample_bits, T* HWY_RESTRICT buf,
+                    size_t max_passes) {
+  using TU = MakeUnsigned<T>;
+  const RebindToUnsigned<D> du;
+  TU* buf_u = reinterpret_cast<TU*>(buf);
+  StoreU(BitCast(du, sample_bits), du, buf_u);
+  TU diff = 0;
+  for (size_t i = 0; i < Lanes(du); ++i) {
+    diff |= buf_u[i];
+  }
+
+  if (PopCount(VaryingDigits(diff)) > max_passes) return false;
+  // The sample may have missed some differing digits, in which case RadixSort
+  // also returns false, having only wasted a vectorized scan of the input.
+  return RadixSort(d, st, keys, num, buf, max_passes);
+}
+
+template <class D, class Traits, typename T,
+          hwy::EnableIf<!RadixOrder<Traits>::kEnabled>* = nullptr>
+bool MaybeRadixSort(D /* d */, Traits /* st */, T* HWY_RESTRICT /* keys */,
+                    size_t /* num */, Vec<D> /* sample_bits */,
+                    T* HWY_RESTRICT /* buf */, size_t /* max_passes */) {
+  return false;
+}
+
+}  // namespace detail
+// NOLINTNEXTLINE(google-readability-namespace-comments)
+}  // namespace HWY_NAMESPACE
+}  // namespace hwy
+HWY_AFTER_NAMESPACE();
+
+#endif  // HIGHWAY_HWY_CONTRIB_SORT_RADIX_TOGGLE
@@ -0,0 +1,179 @@
+// Copyright 2022 Google LLC
+// SPDX-License-Identifier: Apache-2.0
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//      http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+// Header-only sorting of fixed-size records by an embedded integer key, for
+// record layouts without a dedicated vqsort_*.cc. Usage: include this header
+// after foreach_target.h in your own translation unit, define key extraction
+// traits such as
+//
+// struct ByTimestamp {
+//   using Record = Event;  // any trivially copyable type
+//   using Key = int64_t;   // any integer type of up to 64 bits
+//   static Key KeyOf(const Record& r) { return r.timestamp; }
+// };
+//
+// and call hwy::HWY_NAMESPACE::SortRecords<ByTimestamp>(records, num, order),
+// typically from a function that you HWY_EXPORT and HWY_DYNAMIC_DISPATCH.
+//
+// Records are not moved during the sort. Instead, each key is converted to
+// bits whose unsigned order matches the requested order and packed together
+// with the record index into a u64 (keys of up to 32 bits, if the indices also
+// fit) or 128-bit key. These are sorted by vqsort, after which the records are
+// gathered in sorted order. Because the index breaks ties, the sort is stable.
+
+// Normal include guard for target-independent parts
+#ifndef HIGHWAY_HWY_CONTRIB_SORT_RECORD_SORT_INL_H_
+#define HIGHWAY_HWY_CONTRIB_SORT_RECORD_SORT_INL_H_
+
+#include <string.h>  // memcpy
+
+#include "hwy/aligned_allocator.h"
+#include "hwy/base.h"
+#include "hwy/contrib/sort/vqsort.h"  // SortAscending
+
+namespace hwy {
+namespace detail {
+
+// Returns bits of the integer `key` whose unsigned order is the same as the
+// order of `key` according to `order`.
+template <typename Key, class Order>
+MakeUnsigned<Key> RecordKeyBits(Key key, Order order) {
+  static_assert(!IsFloat<Key>(), "Record keys must be integers");
+  using TU = MakeUnsigned<Key>;
+  TU bits = static_cast<TU>(key);
+  if (IsSigned<Key>()) bits ^= SignMask<Key>();
+  if (!order.IsAscending()) bits = static_cast<TU>(~bits);
+  return bits;
+}
+
+HWY_INLINE size_t PackedIndex(uint64_t packed) {
+  return static_cast<size_t>(packed & 0xFFFFFFFFu);
+}
+HWY_INLINE size_t PackedIndex(const uint128_t& packed) {
+  return static_cast<size_t>(packed.lo);
+}
+
+// Moves each record to the position of its index in packed[0, num), via
+// `scratch`, which must hold `num` records.
+template <class Record, typename TPacked>
+void GatherRecords(const TPacked* HWY_RESTRICT packed, size_t num,
+                   Record* HWY_RESTRICT records, Record* HWY_RESTRICT scratch) {
+  for (size_t i = 0; i < num; ++i) {
+    CopyBytes<sizeof(Record)>(records + PackedIndex(packed[i]), scratch + i);
+  }
+  memcpy(records, scratch, num * sizeof(Record));
+}
+
+}  // namespace detail
+}  // namespace hwy
+
+#endif  // HIGHWAY_HWY_CONTRIB_SORT_RECORD_SORT_INL_H_
+
+// Per-target
+#if defined(HIGHWAY_HWY_CONTRIB_SORT_RECORD_SORT_TOGGLE) == \
+    defined(HWY_TARGET_TOGGLE)
+#ifdef HIGHWAY_HWY_CONTRIB_SORT_RECORD_SORT_TOGGLE
+#undef HIGHWAY_HWY_CONTRIB_SORT_RECORD_SORT_TOGGLE
+#else
+#define HIGHWAY_HWY_CONTRIB_SORT_RECORD_SORT_TOGGLE
+#endif
+
+#include <algorithm>  // std::sort
+
+#include "hwy/contrib/sort/shared-inl.h"
+#include "hwy/contrib/sort/traits-inl.h"
+#include "hwy/contrib/sort/traits128-inl.h"
+#include "hwy/contrib/sort/vqsort-inl.h"
+#include "hwy/highway.h"
+
+HWY_BEFORE_NAMESPACE();
+namespace hwy {
+namespace HWY_NAMESPACE {
+namespace detail {
+
+// Sorts packed keys, whose index (lower bits) breaks ties, in ascending order.
+HWY_INLINE void SortPackedRecords(uint64_t* HWY_RESTRICT packed, size_t num) {
+  const SortTag<uint64_t> d;
+  SharedTraits<TraitsLane<OrderAscending<uint64_t>>> st;
+  auto buf = AllocateAligned<uint64_t>(SortConstants::BufNum<uint64_t>(
+      Lanes(d)));
+  HWY_ASSERT(buf);
+  Sort(d, st, packed, num, buf.get());
+}
+
+HWY_INLINE void SortPackedRecords(uint128_t* HWY_RESTRICT packed, size_t num) {
+#if VQSORT_ENABLED
+  const SortTag<uint64_t> d;
+  SharedTraits<Traits128<OrderAscending128>> st;
+  auto buf = AllocateAligned<uint64_t>(SortConstants::BufNum<uint64_t>(
+      Lanes(d)));
+  HWY_ASSERT(buf);
+  Sort(d, st, reinterpret_cast<uint64_t*>(packed), num * 2, buf.get());
+#else
+  // PERFORMANCE WARNING: vqsort is not enabled for the non-SIMD target
+  std::sort(packed, packed + num, [](const uint128_t& a, const uint128_t& b) {
+    return a.hi != b.hi ? a.hi < b.hi : a.lo < b.lo;
+  });
+#endif
+}
+
+HWY_INLINE void PackRecord(uint64_t bits, size_t index, uint64_t& packed) {
+  packed = (bits << 32) | static_cast<uint64_t>(index);
+}
+HWY_INLINE void PackRecord(uint64_t bits, size_t index, uint128_t& packed) {
+  packed.hi = bits;
+  packed.lo = static_cast<uint64_t>(index);
+}
+
+template <class RecordTraits, typename TPacked, class Order>
+void SortRecordsPacked(typename RecordTraits::Record* HWY_RESTRICT records,
+                       size_t num, Order order) {
+  using Record = typename RecordTraits::Record;
+  auto packed = AllocateAligned<TPacked>(num);
+  auto scratch = AllocateAligned<Record>(num);
+  HWY_ASSERT(packed && scratch);
+  for (size_t i = 0; i < num; ++i) {
+    const auto bits =
+        hwy::detail::RecordKeyBits(RecordTraits::KeyOf(records[i]), order);
+    PackRecord(static_cast<uint64_t>(bits), i, packed[i]);
+  }
+  SortPackedRecords(packed.get(), num);
+  hwy::detail::GatherRecords(packed.get(), num, records, scratch.get());
+}
+
+}  // namespace detail
+
+// Sorts records[0, num) by the key returned by RecordTraits::KeyOf, in the
+// order given by `order` (SortAscending or SortDescending). Stable: records
+// with equal keys retain their relative order. Allocates O(num) memory.
+template <class RecordTraits, class Order>
+void SortRecords(typename RecordTraits::Record* HWY_RESTRICT records,
+                 size_t num, Order order) {
+  using Key = typename RecordTraits::Key;
+  static_assert(sizeof(Key) <= 8, "Record keys must be at most 64 bits");
+  if (num <= 1) return;
+  if (sizeof(Key) <= 4 && static_cast<uint64_t>(num - 1) <= 0xFFFFFFFFu) {
+    return detail::SortRecordsPacked<RecordTraits, uint64_t>(records, num,
+                                                             order);
+  }
+  detail::SortRecordsPacked<RecordTraits, uint128_t>(records, num, order);
+}
+
+// NOLINTNEXTLINE(google-readability-namespace-comments)
+}  // namespace HWY_NAMESPACE
+}  // namespace hwy
+HWY_AFTER_NAMESPACE();
+
+#endif  // HIGHWAY_HWY_CONTRIB_SORT_RECORD_SORT_TOGGLE
@@ -0,0 +1,451 @@
+// Copyright 2022 Google LLC
+// SPDX-License-Identifier: Apache-2.0
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//      http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+// Normal include guard for target-independent parts
+#ifndef HIGHWAY_HWY_CONTRIB_SORT_SAMPLESORT_INL_H_
+#define HIGHWAY_HWY_CONTRIB_SORT_SAMPLESORT_INL_H_
+
+#include <string.h>  // memcpy
+
+#include "hwy/aligned_allocator.h"
+#include "hwy/base.h"
+
+namespace hwy {
+
+// Single-threaded samplesort in the style of IPS4o: constants shared by all
+// targets.
+struct SampleSortConstants {
+  // Each distribution replaces up to this many levels of binary partitioning.
+  // The block buffers of all buckets (kMaxBuckets * kBlockBytes) fit in L2.
+  static constexpr size_t kMaxLogBuckets = 5;
+  static constexpr size_t kMaxBuckets = size_t{1} << kMaxLogBuckets;
+
+  // Sampled keys per bucket. More improve the balance of the buckets, but the
+  // sample is sorted for every distribution.
+  static constexpr size_t kOversampling = 16;
+
+  // Keys are moved in blocks of this size (one per bucket is buffered).
+  static constexpr size_t kBlockBytes = 2048;
+
+  // Smaller (sub)arrays are partitioned by vqsort: they fit in L2, so saving
+  // passes over memory does not outweigh the scalar distribution.
+  static constexpr size_t kMinKeys = size_t{1} << 20;
+
+  template <typename T>
+  static constexpr size_t BlockLanes() {
+    return kBlockBytes / sizeof(T);
+  }
+};
+
+}  // namespace hwy
+
+#endif  // HIGHWAY_HWY_CONTRIB_SORT_SAMPLESORT_INL_H_
+
+// Per-target
+#if defined(HIGHWAY_HWY_CONTRIB_SORT_SAMPLESORT_TOGGLE) == \
+    defined(HWY_TARGET_TOGGLE)
+#ifdef HIGHWAY_HWY_CONTRIB_SORT_SAMPLESORT_TOGGLE
+#undef HIGHWAY_HWY_CONTRIB_SORT_SAMPLESORT_TOGGLE
+#else
+#define HIGHWAY_HWY_CONTRIB_SORT_SAMPLESORT_TOGGLE
+#endif
+
+#include "hwy/contrib/sort/shared-inl.h"
+#include "hwy/contrib/sort/sorting_networks-inl.h"  // SharedTraits
+#include "hwy/contrib/sort/traits-inl.h"
+#include "hwy/highway.h"
+
+HWY_BEFORE_NAMESPACE();
+namespace hwy {
+namespace HWY_NAMESPACE {
+namespace detail {
+
+// ------------------------------ SampleSortOrder
+
+// The classification tree looks up splitters via TableLookupLanes, which
+// requires 32 or 64-bit lanes. 128-bit and key-value types are only sorted by
+// vqsort.
+template <class Traits>
+struct SampleSortOrder {
+  static constexpr bool kEnabled = false;
+};
+
+template <typename T>
+struct SampleSortOrder<SharedTraits<TraitsLane<OrderAscending<T>>>> {
+  static constexpr bool kEnabled = sizeof(T) >= 4;
+};
+
+template <typename T>
+struct SampleSortOrder<SharedTraits<TraitsLane<OrderDescending<T>>>> {
+  static constexpr bool kEnabled = sizeof(T) >= 4;
+};
+
+// Whether Sort samplesorts large inputs. Measured for 2M-100M keys on SKX:
+// SampleSorter is slower than AVX-512 vqsort. Other targets are unmeasured and
+// thus never samplesort; Algo::kVQSample forces it for comparison.
+template <typename T>
+constexpr bool UseSampleSort() {
+  return false;
+}
+
+// Number of levels of the classification tree, i.e. log2 of the number of
+// buckets. The widest level must fit in one vector.
+template <class D>
+HWY_INLINE size_t SampleSortLogBuckets(D d) {
+  return HWY_MIN(SampleSortConstants::kMaxLogBuckets,
+                 FloorLog2(Lanes(d)) + 1);
+}
+
+// ------------------------------ SplitterTree
+
+// Branchless search tree over 2^log_buckets - 1 splitters in sort order. Each
+// level is stored as one vector (lane j holds node j), hence descending one
+// level is a TableLookupLanes, a comparison and a shift-in of its result.
+// The bucket index of a key is the index of its leaf: bucket b receives the
+// keys after splitter b - 1 and not after splitter b.
+template <class D, class Traits>
+class SplitterTree {
+  using T = TFromD<D>;
+  using DI = RebindToSigned<D>;  // as required by IndicesFromVec
+
+ public:
+  // `levels` must hold log_buckets vectors and outlive this object.
+  SplitterTree(D d, const T* HWY_RESTRICT splitters, size_t log_buckets,
+               T* HWY_RESTRICT levels)
+      : log_buckets_(log_buckets), levels_(levels) {
+    const size_t N = Lanes(d);
+    for (size_t level = 0; level < log_buckets; ++level) {
+      T* HWY_RESTRICT lanes = levels + level * N;
+      const size_t stride = size_t{1} << (log_buckets - 1 - level);
+      for (size_t j = 0; j < N; ++j) {
+        // Lanes beyond the 2^level nodes are never looked up.
+        const size_t node = HWY_MIN(j, (size_t{1} << level) - 1);
+        lanes[j] = splitters[(2 * node + 1) * stride - 1];
+      }
+    }
+  }
+
+  // Returns the bucket index of each key in `v`.
+  HWY_INLINE Vec<DI> Classify(D d, Traits st, Vec<D> v) const {
+    const DI di;
+    const size_t N = Lanes(d);
+    Vec<DI> node = Zero(di);
+    for (size_t level = 0; level < log_buckets_; ++level) {
+      const Vec<D> lanes = Load(d, levels_ + level * N);
+      const Vec<D> splitter = TableLookupLanes(lanes, IndicesFromVec(d, node));
+      // All-ones (-1) if the key is after the splitter, i.e. in the right child.
+      const Vec<DI> right =
+          VecFromMask(di, RebindMask(di, st.Compare(d, splitter, v)));
+      node = Sub(Add(node, node), right);
+    }
+    return node;
+  }
+
+  HWY_INLINE size_t Classify1(D d, Traits st, T key) const {
+    return static_cast<size_t>(GetLane(Classify(d, st, Set(d, key))));
+  }
+
+ private:
+  size_t log_buckets_;
+  const T* HWY_RESTRICT levels_;
+};
+
+// ------------------------------ SampleSorter
+
+// Sorts by distributing keys into 2^k buckets delimited by splitters from a
+// random sample, then sorting each bucket: recursively if it is still large,
+// otherwise via `SortSmall`. This requires O(log(n) / k) passes over memory,
+// versus log2(n) for partitioning.
+//
+// The distribution is in-place except for one buffer block per bucket, as in
+// IPS4o: blocks of keys with the same bucket are first gathered at the front of
+// the array, then permuted to their bucket and finally the partial blocks and
+// bucket boundaries are fixed up.
+template <class D, class Traits, class SortSmall>
+class SampleSorter {
+  using T = TFromD<D>;
+  using TI = MakeSigned<T>;
+  using DI = RebindToSigned<D>;
+  static constexpr size_t kBlock = SampleSortConstants::BlockLanes<T>();
+  static constexpr size_t kMaxBuckets = SampleSortConstants::kMaxBuckets;
+
+ public:
+  // `sort_small(keys, num)` sorts keys[0, num).
+  SampleSorter(D d, Traits st, const SortSmall& sort_small)
+      : d_(d),
+        st_(st),
+        sort_small_(sort_small),
+        log_buckets_(SampleSortLogBuckets(d)),
+        num_buckets_(size_t{1} << log_buckets_) {
+    const size_t N = Lanes(d);
+    num_sample_ = num_buckets_ * SampleSortConstants::kOversampling;
+    // Sample, tree levels, bucket buffers, two swap blocks and overflow.
+    const size_t num_scratch = num_sample_ + log_buckets_ * N +
+                               (num_buckets_ + 3) * kBlock;
+    scratch_ = hwy::AllocateAligned<T>(num_scratch);
+    buckets_ = hwy::AllocateAligned<TI>(N);
+  }
+
+  // Returns false without modifying `keys` if scratch space could not be
+  // allocated or the sample has too few distinct keys, which are better
+  // handled by the three-way partitioning of vqsort.
+  template <class RNG>
+  bool operator()(T* HWY_RESTRICT keys, size_t num, RNG& rng) {
+    if (!scratch_ || !buckets_) return false;
+    if (!ChooseSplitters(keys, num, rng)) return false;
+
+    const SplitterTree<D, Traits> tree(d_, scratch_.get(), log_buckets_,
+                                       scratch_.get() + num_sample_);
+    size_t starts[kMaxBuckets + 1];
+    Distribute(tree, keys, num, starts);
+
+    for (size_t b = 0; b < num_buckets_; ++b) {
+      const size_t size = starts[b + 1] - starts[b];
+      if (size < 2) continue;
+      T* HWY_RESTRICT bucket = keys + starts[b];
+      if (size < SampleSortConstants::kMinKeys || !(*this)(bucket, size, rng)) {
+        sort_small_(bucket, size);
+      }
+    }
+    return true;
+  }
+
+ private:
+  // Writes the splitters, in sort order, to the front of scratch_. Returns
+  // false if they are not all distinct.
+  template <class RNG>
+  bool ChooseSplitters(const T* HWY_RESTRICT keys, size_t num, RNG& rng) {
+    T* HWY_RESTRICT sample = scratch_.get();
+    for (size_t i = 0; i < num_sample_; ++i) {
+      sample[i] = keys[static_cast<size_t>(rng() % num)];
+    }
+    sort_small_(sample, num_sample_);
+
+    // The splitters are every kOversampling-th sample key, moved to the front.
+    const size_t num_splitters = num_buckets_ - 1;
+    for (size_t i = 0; i < num_splitters; ++i) {
+      sample[i] = sample[(i + 1) * SampleSortConstants::kOversampling];
+    }
+    const CappedTag<T, 1> d1;
+    for (size_t i = 1; i < num_splitters; ++i) {
+      if (!AllTrue(d1, st_.Compare(d1, Set(d1, sample[i - 1]),
+                                   Set(d1, sample[i])))) {
+        return false;
+      }
+    }
+    return true;
+  }
+
+  // Moves keys such that keys[starts[b], starts[b + 1]) are those of bucket b.
+  void Distribute(const SplitterTree<D, Traits>& tree, T* HWY_RESTRICT keys,
+                  size_t num, size_t* HWY_RESTRICT starts) {
+    T* HWY_RESTRICT buffers =
+        scratch_.get() + num_sample_ + log_buckets_ * Lanes(d_);
+    size_t fill[kMaxBuckets] = {};
+    size_t blocks[kMaxBuckets] = {};
+    const size_t end_blocks = ClassifyIntoBlocks(tree, keys, num, buffers,
+                                                 fill, blocks);
+
+    // Bucket b receives the (block-aligned) slots [delims[b], delims[b + 1]).
+    size_t delims[kMaxBuckets + 1];
+    size_t writes[kMaxBuckets];  // next slot to write
+    size_t reads[kMaxBuckets];   // end of the not yet permuted blocks
+    size_t sum = 0;
+    for (size_t b = 0; b < num_buckets_; ++b) {
+      starts[b] = sum;
+      delims[b] = RoundUpToBlock(sum);
+      sum += blocks[b] * kBlock + fill[b];
+    }
+    HWY_DASSERT(sum == num);
+    starts[num_buckets_] = num;
+    delims[num_buckets_] = RoundUpToBlock(num);
+    for (size_t b = 0; b < num_buckets_; ++b) {
+      writes[b] = delims[b];
+      reads[b] = HWY_MIN(HWY_MAX(end_blocks, delims[b]), delims[b + 1]);
+    }
+
+    T* HWY_RESTRICT overflow = buffers + (num_buckets_ + 2) * kBlock;
+    PermuteBlocks(tree, keys, num, buffers + num_buckets_ * kBlock, overflow,
+                  writes, reads);
+    Cleanup(keys, num, buffers, overflow, fill, starts, delims, writes);
+  }
+
+  static size_t RoundUpToBlock(size_t i) {
+    return (i + kBlock - 1) / kBlock * kBlock;
+  }
+
+  // Appends each key to the buffer block of its bucket. Full blocks are
+  // written to the front of `keys`, which is safe because they only contain
+  // keys that were already read. Returns the end of the written blocks.
+  size_t ClassifyIntoBlocks(const SplitterTree<D, Traits>& tree,
+                            T* HWY_RESTRICT keys, size_t num,
+                            T* HWY_RESTRICT buffers, size_t* HWY_RESTRICT fill,
+                            size_t* HWY_RESTRICT blocks) {
+    const DI di;
+    const size_t N = Lanes(d_);
+    TI* HWY_RESTRICT buckets = buckets_.get();
+    size_t end_blocks = 0;
+    const auto append = [&](size_t b, T key) {
+      T* HWY_RESTRICT buffer = buffers + b * kBlock;
+      buffer[fill[b]++] = key;
+      if (fill[b] == kBlock) {
+        memcpy(keys + end_blocks, buffer, kBlock * sizeof(T));
+        end_blocks += kBlock;
+        blocks[b] += 1;
+        fill[b] = 0;
+      }
+    };
+
+    size_t i = 0;
+    if (num >= N) {
+      for (; i <= num - N; i += N) {
+        Store(tree.Classify(d_, st_, LoadU(d_, keys + i)), di, buckets);
+        // Writing a block only overwrites keys up to and including i + j.
+        for (size_t j = 0; j < N; ++j) {
+          append(static_cast<size_t>(buckets[j]), keys[i + j]);
+        }
+      }
+    }
+    for (; i < num; ++i) {
+      append(tree.Classify1(d_, st_, keys[i]), keys[i]);
+    }
+    return end_blocks;
+  }
+
+  // Moves each of the blocks in keys[0, end_blocks) to a slot of its bucket.
+  // Slots of bucket b in [writes[b], reads[b]) still hold unpermuted blocks;
+  // later slots (up to the next delimiter) are free. We take the last
+  // unpermuted block of each bucket and swap it into its destination until
+  // reaching a free slot.
+  void PermuteBlocks(const SplitterTree<D, Traits>& tree, T* HWY_RESTRICT keys,
+                     size_t num, T* HWY_RESTRICT swap, T* HWY_RESTRICT overflow,
+                     size_t* HWY_RESTRICT writes,
+                     size_t* HWY_RESTRICT reads) {
+    T* HWY_RESTRICT carried = swap;
+    T* HWY_RESTRICT displaced = swap + kBlock;
+    for (size_t b = 0; b < num_buckets_; ++b) {
+      while (reads[b] > writes[b]) {
+        reads[b] -= kBlock;
+        memcpy(carried, keys + reads[b], kBlock * sizeof(T));
+        size_t dest = tree.Classify1(d_, st_, carried[0]);
+        for (;;) {
+          const size_t slot = writes[dest];
+          writes[dest] += kBlock;
+          HWY_DASSERT(slot + kBlock <= RoundUpToBlock(num));
+          if (slot < reads[dest]) {
+            const size_t other = tree.Classify1(d_, st_, keys[slot]);
+            if (other == dest) continue;  // already in place
+            memcpy(displaced, keys + slot, kBlock * sizeof(T));
+            memcpy(keys + slot, carried, kBlock * sizeof(T));
+            T* HWY_RESTRICT tmp = carried;
+            carried = displaced;
+            displaced = tmp;
+            dest = other;
+          } else {
+            // Free slot. Only the last one may extend past the end of keys.
+            T* HWY_RESTRICT to = slot + kBlock > num ? overflow : keys + slot;
+            memcpy(to, carried, kBlock * sizeof(T));
+            break;
+          }
+        }
+      }
+    }
+  }
+
+  // Each bucket's permuted blocks begin at its delimiter, which may be after
+  // its start, and the last one may end after the start of the next bucket or
+  // the end of `keys` (then it is in `overflow`). The gaps receive those keys
+  // plus the partial block from `buffers`.
+  void Cleanup(T* HWY_RESTRICT keys, size_t num,
+               const T* HWY_RESTRICT buffers, const T* HWY_RESTRICT overflow,
+               const size_t* HWY_RESTRICT fill,
+               const size_t* HWY_RESTRICT starts,
+               const size_t* HWY_RESTRICT delims,
+               const size_t* HWY_RESTRICT writes) {
+    T* HWY_RESTRICT spilled = scratch_.get() + num_sample_ +
+                              log_buckets_ * Lanes(d_) +
+                              num_buckets_ * kBlock;  // first swap block
+    for (size_t b = 0; b < num_buckets_; ++b) {
+      const size_t begin = starts[b];
+      const size_t end = starts[b + 1];
+      // Move keys of this bucket beyond `end` out of the way before the next
+      // bucket overwrites them. Buckets without blocks wrote nothing, even if
+      // their delimiter is after `end`.
+      const bool has_blocks = writes[b] != delims[b];
+      size_t end_blocks = writes[b];
+      size_t num_spilled = 0;
+      if (has_blocks && end_blocks > num) {
+        end_blocks -= kBlock;
+        num_spilled = kBlock;
+        memcpy(spilled, overflow, kBlock * sizeof(T));
+      } else if (has_blocks && end_blocks > end) {
+        num_spilled = end_blocks - end;
+        memcpy(spilled, keys + end, num_spilled * sizeof(T));
+      }
+
+      // The gaps are [begin, head_end) and [tail_begin, end).
+      const size_t head_end = HWY_MIN(delims[b], end);
+      const size_t tail_begin = HWY_MAX(head_end, HWY_MIN(end_blocks, end));
+      HWY_DASSERT((head_end - begin) + (end - tail_begin) ==
+                  fill[b] + num_spilled);
+      size_t pos = begin;
+      size_t limit = head_end;
+      const auto put = [&](const T* HWY_RESTRICT from, size_t count) {
+        while (count != 0) {
+          if (pos == limit) {
+            pos = tail_begin;
+            limit = end;
+          }
+          const size_t n = HWY_MIN(count, limit - pos);
+          memcpy(keys + pos, from, n * sizeof(T));
+          pos += n;
+          from += n;
+          count -= n;
+        }
+      };
+      put(buffers + b * kBlock, fill[b]);
+      put(spilled, num_spilled);
+    }
+  }
+
+  const D d_;
+  Traits st_;
+  const SortSmall& sort_small_;
+  const size_t log_buckets_;
+  const size_t num_buckets_;
+  size_t num_sample_;
+  AlignedFreeUniquePtr<T[]> scratch_;
+  AlignedFreeUniquePtr<TI[]> buckets_;
+};
+
+// Samplesorts keys[0, num), see SampleSorter. `st` must be one of the
+// SampleSortOrder specializations for which kEnabled. Returns false without
+// modifying `keys` if samplesort is not applicable.
+template <class D, class Traits, typename T, class RNG, class SortSmall>
+bool SampleSort(D d, Traits st, T* HWY_RESTRICT keys, size_t num, RNG& rng,
+                const SortSmall& sort_small) {
+  static_assert(SampleSortOrder<Traits>::kEnabled, "Requires 32/64-bit keys");
+  if (num < SampleSortConstants::kMinKeys) return false;
+  SampleSorter<D, Traits, SortSmall> sorter(d, st, sort_small);
+  return sorter(keys, num, rng);
+}
+
+}  // namespace detail
+// NOLINTNEXTLINE(google-readability-namespace-comments)
+}  // namespace HWY_NAMESPACE
+}  // namespace hwy
+HWY_AFTER_NAMESPACE();
+
+#endif  // HIGHWAY_HWY_CONTRIB_SORT_SAMPLESORT_TOGGLE
@@ -21,6 +21,21 @@
 
 #include "hwy/base.h"
 
+// Whether Recurse writes large partitions with non-temporal stores (see
+// SortTuning::stream_partition_mib and PartitionStream in vqsort-inl.h). This
+// was slower on Skylake-X for all sizes, hence it is not compiled by default.
+#ifndef VQSORT_STREAM_PARTITION
+#define VQSORT_STREAM_PARTITION 0
+#endif
+
+// Whether Partition may stage its output in blocks of cache lines (see
+// SortTuning::block_partition and BlockWriter in vqsort-inl.h). This was slower
+// on Skylake-X for all sizes and enlarges BufNum, hence it is not compiled by
+// default.
+#ifndef VQSORT_BLOCK_PARTITION
+#define VQSORT_BLOCK_PARTITION 0
+#endif
+
 namespace hwy {
 
 // Internal constants - these are to avoid magic numbers/literals and cannot be
@@ -50,7 +65,8 @@ struct SortConstants {
   // 2x is sufficient to reach full memory bandwidth on SKX in Partition, but
   // somewhat slower for sorting than 4x.
   //
-  // To change, must also update left + 3 * N etc. in the loop.
+  // This is the default and maximum; SortTuning::partition_unroll may select
+  // 2 instead. To change, must also update left + 3 * N etc. in the loop.
   static constexpr size_t kPartitionUnroll = 4;
 
   static constexpr HWY_INLINE size_t PartitionBufNum(size_t N) {
@@ -69,16 +85,47 @@ struct SortConstants {
     return HWY_MAX(64 / sizeof_t, N);
   }
 
+  // Number of lanes up to which partitions are sorted by BaseCase when using
+  // `rows` (see SortTuning::base_case_rows) instead of kMaxRows. Large enough
+  // for ChoosePivot to sample from at least two aligned chunks.
+  static constexpr HWY_INLINE size_t TunedBaseCaseNum(size_t rows,
+                                                      size_t sizeof_t,
+                                                      size_t N) {
+    return HWY_MIN(BaseCaseNum(N), HWY_MAX(rows * HWY_MIN(N, kMaxCols),
+                                           4 * LanesPerChunk(sizeof_t, N)));
+  }
+
   static constexpr HWY_INLINE size_t PivotBufNum(size_t sizeof_t, size_t N) {
     // 3 chunks of medians, 1 chunk of median medians plus two padding vectors.
     return (3 + 1) * LanesPerChunk(sizeof_t, N) + 2 * N;
   }
 
+  // Chunks staged per side before BlockWriter (see vqsort-inl.h) writes them.
+  // Larger blocks amortize the flushing, but 4 was only slightly slower.
+  static constexpr size_t kPartitionBlockChunks = 16;
+
+  static constexpr HWY_INLINE size_t BlockBufNum(size_t sizeof_t, size_t N) {
+    // Per side, up to one block minus one lane plus one vector are staged, and
+    // another vector is required for the (Compress)StoreU. None if BlockWriter
+    // is not compiled.
+    return (VQSORT_BLOCK_PARTITION || VQSORT_STREAM_PARTITION)
+               ? 2 * (kPartitionBlockChunks * LanesPerChunk(sizeof_t, N) +
+                      2 * N)
+               : 0;
+  }
+
+  static constexpr HWY_INLINE size_t BufNumForLanes(size_t sizeof_t,
+                                                    size_t N) {
+    // One extra for padding plus another for full-vector loads.
+    return HWY_MAX(HWY_MAX(BaseCaseNum(N) + 2 * N, BlockBufNum(sizeof_t, N)),
+                   HWY_MAX(PartitionBufNum(N), PivotBufNum(sizeof_t, N)));
+  }
+
+  // Also sufficient for 128-bit vectors, which replace partial vectors that
+  // are too small for 128-bit keys (see IsTooSmallForKey in vqsort-inl.h).
   template <typename T>
   static constexpr HWY_INLINE size_t BufNum(size_t N) {
-    // One extra for padding plus another for full-vector loads.
-    return HWY_MAX(BaseCaseNum(N) + 2 * N,
-                   HWY_MAX(PartitionBufNum(N), PivotBufNum(sizeof(T), N)));
+    return BufNumForLanes(sizeof(T), HWY_MAX(N, 16 / sizeof(T)));
   }
 
   template <typename T>
@@ -87,6 +134,17 @@ struct SortConstants {
   }
 };
 
+// Returns the bits of an IEEE 754 binary16, bfloat16, binary32 or binary64
+// value with the magnitude bits flipped if it is negative. As signed integers,
+// the results are ordered like the totalOrder predicate: -NaN < -inf < -1 < -0
+// < +0 < 1 < inf < NaN. The sign bit is unchanged, hence this is its own
+// inverse. `TU` is the unsigned integer type of the same size.
+template <typename TU>
+constexpr TU TotalOrderSigned(TU bits) {
+  return static_cast<TU>(
+      bits ^ (static_cast<TU>(0 - (bits >> (sizeof(TU) * 8 - 1))) >> 1));
+}
+
 }  // namespace hwy
 
 #endif  // HIGHWAY_HWY_CONTRIB_SORT_SHARED_INL_H_
@@ -113,6 +171,7 @@ struct SortConstants {
 #define VQSORT_ENABLED 1
 #endif
 
+HWY_BEFORE_NAMESPACE();
 namespace hwy {
 namespace HWY_NAMESPACE {
 
@@ -126,8 +185,68 @@ template <typename T>
 using SortTag = ScalableTag<T>;
 #endif
 
+namespace detail {
+
+// Vector version of TotalOrderSigned for signed integer lanes.
+template <class D>
+HWY_INLINE Vec<D> TotalOrderSigned(D d, Vec<D> v) {
+  const Vec<D> negative = BroadcastSignBit(v);
+  return Xor(v, And(negative, Set(d, LimitsMax<TFromD<D>>())));
+}
+
+// Applies TotalOrderSigned to `keys[0, num)`, which are the bits of floats or
+// the result of a previous call. This allows sorting floats by totalOrder with
+// the kernels for signed integers of the same size.
+template <typename TI>
+void ConvertTotalOrder(TI* HWY_RESTRICT keys, size_t num) {
+  const ScalableTag<TI> d;
+  const size_t N = Lanes(d);
+  size_t i = 0;
+  for (; i + N <= num; i += N) {
+    StoreU(TotalOrderSigned(d, LoadU(d, keys + i)), d, keys + i);
+  }
+  const size_t remaining = num - i;
+  if (remaining != 0) {
+    const Mask<decltype(d)> mask = FirstN(d, remaining);
+    const Vec<decltype(d)> v = MaskedLoad(mask, d, keys + i);
+    BlendedStore(TotalOrderSigned(d, v), mask, d, keys + i);
+  }
+}
+
+}  // namespace detail
+
+#if VQSORT_ENABLED
+namespace detail {
+
+// The sorting networks and traits use fixed shuffles such as ConcatUpperLower,
+// which only have the intended effect for vectors of up to 512 bits. The
+// following express the same permutations in terms of lane indices, and thus
+// also work for wider (SVE/RVV) vectors, whose number of lanes is a power of
+// two.
+
+// Returns `v` with each lane i replaced by lane i ^ kXor.
+template <size_t kXor, class D>
+HWY_INLINE Vec<D> XorLanes(D d, Vec<D> v) {
+  const RebindToUnsigned<D> du;
+  using TU = TFromD<decltype(du)>;
+  const Vec<decltype(du)> idx = Xor(Iota(du, 0), Set(du, TU{kXor}));
+  return TableLookupLanes(v, IndicesFromVec(d, idx));
+}
+
+// Returns a mask of the lanes i for which (i & kBit) != 0.
+template <size_t kBit, class D>
+HWY_INLINE Mask<D> LanesWithBit(D d) {
+  const RebindToUnsigned<D> du;
+  using TU = TFromD<decltype(du)>;
+  return RebindMask(d, TestBit(Iota(du, 0), Set(du, TU{kBit})));
+}
+
+}  // namespace detail
+#endif  // VQSORT_ENABLED
+
 // NOLINTNEXTLINE(google-readability-namespace-comments)
 }  // namespace HWY_NAMESPACE
 }  // namespace hwy
+HWY_AFTER_NAMESPACE();
 
 #endif  // HIGHWAY_HWY_CONTRIB_SORT_SHARED_TOGGLE
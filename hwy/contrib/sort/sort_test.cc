@@ -18,19 +18,29 @@
 #define HWY_TARGET_INCLUDE "hwy/contrib/sort/sort_test.cc"
 #include "hwy/foreach_target.h"
 
+#include "hwy/contrib/sort/external_sort.h"
+#include "hwy/contrib/sort/thread_pool.h"
 #include "hwy/contrib/sort/vqsort.h"
 // After foreach_target
 #include "hwy/contrib/sort/algo-inl.h"
 #include "hwy/contrib/sort/traits128-inl.h"
 #include "hwy/contrib/sort/result-inl.h"
 #include "hwy/contrib/sort/vqsort-inl.h"  // BaseCase
+#include "hwy/contrib/sort/record_sort-inl.h"
 #include "hwy/tests/test_util-inl.h"
 // clang-format on
 
 #include <stdint.h>
 #include <stdio.h>
+#include <stdlib.h>  // malloc
 #include <string.h>  // memcpy
 
+#include <algorithm>
+#include <initializer_list>
+#include <limits>
+#include <random>
+#include <string>
+#include <utility>  // std::move
 #include <vector>
 
 HWY_BEFORE_NAMESPACE();
@@ -39,7 +49,9 @@ namespace HWY_NAMESPACE {
 namespace {
 
 using detail::OrderAscending;
+using detail::OrderAscendingKV64;
 using detail::OrderDescending;
+using detail::OrderDescendingKV64;
 using detail::SharedTraits;
 using detail::TraitsLane;
 #if VQSORT_ENABLED || HWY_IDE
@@ -265,8 +277,9 @@ static HWY_NOINLINE void VerifyPartition(
   }
 }
 
+// If `stream`, tests PartitionStream instead of Partition.
 template <class Traits>
-static HWY_NOINLINE void TestPartition() {
+static HWY_NOINLINE void TestPartition(const SortTuning& tuning, bool stream) {
   using LaneType = typename Traits::LaneType;
   const SortTag<LaneType> d;
   SharedTraits<Traits> st;
@@ -274,17 +287,25 @@ static HWY_NOINLINE void TestPartition() {
   const size_t N = Lanes(d);
   constexpr int kDebug = 0;
   const size_t base_case_num = SortConstants::BaseCaseNum(N);
+  // Also more than two blocks of BlockWriter, so that they are written.
+  const size_t block_ofs = 2 * SortConstants::kPartitionBlockChunks *
+                               SortConstants::LanesPerChunk(sizeof(LaneType),
+                                                            N) +
+                           N + 1;
   // left + len + align
-  const size_t total = 32 + (base_case_num + 4 * HWY_MAX(N, 4)) + 2 * N;
+  const size_t total =
+      32 + (base_case_num + HWY_MAX(4 * HWY_MAX(N, 4), block_ofs)) + 2 * N;
   auto aligned_lanes = hwy::AllocateAligned<LaneType>(total);
-  auto buf = hwy::AllocateAligned<LaneType>(SortConstants::PartitionBufNum(N));
+  auto buf =
+      hwy::AllocateAligned<LaneType>(SortConstants::BufNum<LaneType>(N));
 
   const size_t N1 = st.LanesPerKey();
   for (bool in_asc : {false, true}) {
     for (int left_i : {0, 1, 2, 3, 4, 5, 6, 7, 8, 12, 15, 22, 28, 29, 30, 31}) {
       const size_t left = static_cast<size_t>(left_i) & ~(N1 - 1);
       for (size_t ofs : {N, N + 1, N + 2, N + 3, 2 * N, 2 * N + 1, 2 * N + 2,
-                         2 * N + 3, 3 * N - 1, 4 * N - 3, 4 * N - 2}) {
+                         2 * N + 3, 3 * N - 1, 4 * N - 3, 4 * N - 2,
+                         block_ofs}) {
         const size_t len = (base_case_num + ofs) & ~(N1 - 1);
         for (LaneType pivot1 :
              {LaneType(0), LaneType(len / 3), LaneType(len / 2),
@@ -322,8 +343,17 @@ static HWY_NOINLINE void TestPartition() {
               lanes[i] = hwy::LowestValue<LaneType>();
             }
 
+#if VQSORT_STREAM_PARTITION
             size_t border =
-                detail::Partition(d, st, lanes, left, right, pivot, buf.get());
+                stream ? detail::PartitionStream(d, st, lanes, left, right,
+                                                 pivot, buf.get())
+                       : detail::Partition(d, st, lanes, left, right, pivot,
+                                           buf.get(), tuning);
+#else
+            HWY_ASSERT(!stream);  // Requires VQSORT_STREAM_PARTITION.
+            size_t border = detail::Partition(d, st, lanes, left, right, pivot,
+                                              buf.get(), tuning);
+#endif
 
             if (kDebug >= 2) {
               printf("out>>>>>>\n");
@@ -355,19 +385,110 @@ static HWY_NOINLINE void TestPartition() {
   }          // asc
 }
 
+static void TestPartitionTypes(const SortTuning& tuning, bool stream) {
+  TestPartition<TraitsLane<OrderAscending<int16_t> > >(tuning, stream);
+  TestPartition<TraitsLane<OrderDescending<int32_t> > >(tuning, stream);
+  TestPartition<TraitsLane<OrderAscending<int64_t> > >(tuning, stream);
+  TestPartition<TraitsLane<OrderDescending<float> > >(tuning, stream);
+#if HWY_HAVE_FLOAT64
+  TestPartition<TraitsLane<OrderDescending<double> > >(tuning, stream);
+#endif
+  TestPartition<Traits128<OrderAscending128> >(tuning, stream);
+  TestPartition<Traits128<OrderDescending128> >(tuning, stream);
+}
+
 HWY_NOINLINE void TestAllPartition() {
   // Only enable EMU128 on x86 - it's slow on emulators.
   if (!HWY_ARCH_X86 && (HWY_TARGET == HWY_EMU128)) return;
 
-  TestPartition<TraitsLane<OrderAscending<int16_t> > >();
-  TestPartition<TraitsLane<OrderDescending<int32_t> > >();
-  TestPartition<TraitsLane<OrderAscending<int64_t> > >();
-  TestPartition<TraitsLane<OrderDescending<float> > >();
-#if HWY_HAVE_FLOAT64
-  TestPartition<TraitsLane<OrderDescending<double> > >();
+  // Also the instantiations selected by SortTuning::partition_unroll and, if
+  // compiled, block_partition.
+  for (uint32_t unroll : {2u, 4u}) {
+    for (uint32_t block = 0; block < 1 + VQSORT_BLOCK_PARTITION; ++block) {
+      SortTuning tuning;
+      tuning.partition_unroll = unroll;
+      tuning.block_partition = block;
+      HWY_ASSERT(tuning.IsValid());
+      TestPartitionTypes(tuning, /*stream=*/false);
+    }
+  }
+
+#if VQSORT_STREAM_PARTITION
+  // Recurse only streams huge partitions, and only if enabled via
+  // SortTuning::stream_partition_mib, hence also test PartitionStream here.
+  TestPartitionTypes(SortTuning(), /*stream=*/true);
 #endif
-  TestPartition<Traits128<OrderAscending128> >();
-  TestPartition<Traits128<OrderDescending128> >();
+}
+
+template <class Traits>
+static HWY_NOINLINE void TestPartitionThreeWay() {
+  using LaneType = typename Traits::LaneType;
+  const SortTag<LaneType> d;
+  SharedTraits<Traits> st;
+  const size_t N = Lanes(d);
+  const size_t N1 = st.LanesPerKey();
+  const size_t base_case_num = SortConstants::BaseCaseNum(N);
+  auto buf = hwy::AllocateAligned<LaneType>(SortConstants::PartitionBufNum(N));
+
+  constexpr size_t kMaxDistinct = 5;
+  for (size_t len : {base_case_num / 2, base_case_num + N1,
+                     5 * base_case_num + 3 * N1}) {
+    auto aligned = hwy::AllocateAligned<LaneType>(len);
+    LaneType* lanes = aligned.get();
+    for (size_t num_distinct = 1; num_distinct <= kMaxDistinct; ++num_distinct) {
+      for (size_t pivot_idx = 0; pivot_idx < num_distinct; ++pivot_idx) {
+        size_t expected[kMaxDistinct] = {};
+        for (size_t i = 0; i < len; i += N1) {
+          const size_t key = (i / N1 * 7) % num_distinct;
+          expected[key] += 1;
+          // For 128-bit keys, also set the upper half, which is the key of
+          // key-value pairs.
+          lanes[i] = static_cast<LaneType>(key);
+          if (N1 == 2) lanes[i + 1] = static_cast<LaneType>(key);
+        }
+        const LaneType pivot2[2] = {static_cast<LaneType>(pivot_idx),
+                                    static_cast<LaneType>(pivot_idx)};
+        const auto pivot = st.SetKey(d, pivot2);
+
+        size_t bound_equal;
+        const size_t bound = detail::PartitionThreeWay(
+            d, st, lanes, 0, len, pivot, buf.get(), SortTuning(), bound_equal);
+        HWY_ASSERT(bound_equal <= bound && bound <= len);
+
+        size_t actual[kMaxDistinct] = {};
+        for (size_t i = 0; i < len; i += N1) {
+          const bool before = st.Compare1(lanes + i, pivot2);
+          const bool after = st.Compare1(pivot2, lanes + i);
+          if (i < bound) {
+            HWY_ASSERT(!after);
+            // Equal keys are only separated if the left side is large enough.
+            if (bound > base_case_num) HWY_ASSERT(before == (i < bound_equal));
+          } else {
+            HWY_ASSERT(after);
+          }
+          const size_t key = static_cast<size_t>(lanes[i]);
+          HWY_ASSERT(key < num_distinct);
+          actual[key] += 1;
+        }
+        for (size_t key = 0; key < kMaxDistinct; ++key) {
+          HWY_ASSERT(actual[key] == expected[key]);
+        }
+      }
+    }
+  }
+}
+
+HWY_NOINLINE void TestAllPartitionThreeWay() {
+  // Only enable EMU128 on x86 - it's slow on emulators.
+  if (!HWY_ARCH_X86 && (HWY_TARGET == HWY_EMU128)) return;
+
+  TestPartitionThreeWay<TraitsLane<OrderAscending<uint16_t> > >();
+  TestPartitionThreeWay<TraitsLane<OrderDescending<int32_t> > >();
+  TestPartitionThreeWay<TraitsLane<OrderAscending<uint64_t> > >();
+  TestPartitionThreeWay<TraitsLane<OrderDescending<float> > >();
+  TestPartitionThreeWay<TraitsLane<OrderAscendingKV64> >();
+  TestPartitionThreeWay<Traits128<OrderAscending128> >();
+  TestPartitionThreeWay<Traits128<OrderDescendingKV128> >();
 }
 
 // (used for sample selection for choosing a pivot)
@@ -407,11 +528,69 @@ HWY_NOINLINE void TestAllGenerator() {
   TestRandomGenerator<uint64_t>();
 }
 
+// Checks XorLanes against a scalar reference, if there are enough lanes.
+template <size_t kXor, class D>
+static void TestXorLanes(D d, const Vec<D> v, const uint64_t* in,
+                         uint64_t* out) {
+  const size_t N = Lanes(d);
+  if (N <= kXor) return;
+  Store(detail::XorLanes<kXor>(d, v), d, out);
+  for (size_t i = 0; i < N; ++i) {
+    HWY_ASSERT_EQ(in[i ^ kXor], out[i]);
+  }
+}
+
+template <size_t kBit, class D>
+static void TestLanesWithBit(D d, const Vec<D> odd, const Vec<D> even,
+                             uint64_t* out) {
+  const size_t N = Lanes(d);
+  Store(IfThenElse(detail::LanesWithBit<kBit>(d), odd, even), d, out);
+  for (size_t i = 0; i < N; ++i) {
+    HWY_ASSERT_EQ(static_cast<uint64_t>((i & kBit) ? 1 : 0), out[i]);
+  }
+}
+
+// The network shuffles of 64-bit lanes and 128-bit keys use these instead of
+// fixed shuffles for vectors wider than 512 bits. Also checks that both agree
+// for 512-bit vectors.
+HWY_NOINLINE void TestAllWideShuffles() {
+  const ScalableTag<uint64_t> d;
+  const size_t N = Lanes(d);
+  auto in = hwy::AllocateAligned<uint64_t>(N);
+  auto out = hwy::AllocateAligned<uint64_t>(N);
+  HWY_ASSERT(in && out);
+  for (size_t i = 0; i < N; ++i) {
+    in[i] = 0x100 + i;
+  }
+  const Vec<decltype(d)> v = Load(d, in.get());
+
+  TestXorLanes<1>(d, v, in.get(), out.get());
+  TestXorLanes<4>(d, v, in.get(), out.get());
+  TestXorLanes<6>(d, v, in.get(), out.get());
+  TestXorLanes<14>(d, v, in.get(), out.get());
+  TestLanesWithBit<4>(d, Set(d, 1), Zero(d), out.get());
+  TestLanesWithBit<8>(d, Set(d, 1), Zero(d), out.get());
+
+  if (N == 8) {
+    const SharedTraits<TraitsLane<OrderAscending<uint64_t> > > st;
+    const SharedTraits<Traits128<OrderAscending128> > st128;
+    HWY_ASSERT_VEC_EQ(d, detail::XorLanes<4>(d, v), st.SwapAdjacentQuads(d, v));
+    HWY_ASSERT_VEC_EQ(d, detail::XorLanes<6>(d, v), st128.ReverseKeys4(d, v));
+    const Vec<decltype(d)> odd = Set(d, 1);
+    const Vec<decltype(d)> even = Zero(d);
+    HWY_ASSERT_VEC_EQ(d, st.OddEvenQuads(d, odd, even),
+                      IfThenElse(detail::LanesWithBit<4>(d), odd, even));
+    HWY_ASSERT_VEC_EQ(d, st128.OddEvenPairs(d, odd, even),
+                      IfThenElse(detail::LanesWithBit<4>(d), odd, even));
+  }
+}
+
 #else
 static void TestAllMedian() {}
 static void TestAllBaseCase() {}
 static void TestAllPartition() {}
 static void TestAllGenerator() {}
+static void TestAllWideShuffles() {}
 #endif  // VQSORT_ENABLED
 
 // Remembers input, and compares results to that of a reference algorithm.
@@ -434,13 +613,17 @@ class CompareResults {
 #endif
     SharedState shared;
     using Order = typename Traits::Order;
-    const Traits st;
-    const size_t num_keys = copy_.size() / st.LanesPerKey();
+    Traits st;
+    constexpr size_t N1 = st.LanesPerKey();
+    const size_t num_keys = copy_.size() / N1;
     Run<Order>(reference, reinterpret_cast<KeyType*>(copy_.data()), num_keys,
                shared, /*thread=*/0);
 
-    for (size_t i = 0; i < copy_.size(); ++i) {
-      if (copy_[i] != output[i]) {
+    // Only compare keys: the order of values with equal keys (KV64/KV128) is
+    // unspecified. VerifySort checks that no lanes were lost.
+    for (size_t i = 0; i < copy_.size(); i += N1) {
+      if (st.Compare1(&copy_[i], output + i) ||
+          st.Compare1(output + i, &copy_[i])) {
         if (sizeof(KeyType) == 16) {
           fprintf(stderr,
                   "%s Asc %d mismatch at %d of %d: %" PRIu64 " %" PRIu64 "\n",
@@ -480,7 +663,7 @@ std::vector<Algo> AlgoForTest() {
 #if HAVE_SORT512
         Algo::kSort512,
 #endif
-        Algo::kHeap, Algo::kVQSort,
+        Algo::kHeap, Algo::kVQSort, Algo::kVQRadix, Algo::kVQSample,
   };
 }
 
@@ -572,6 +755,9 @@ void TestAllSort() {
     }
 #endif
 
+    TestSort<TraitsLane<OrderAscendingKV64> >(num_lanes);
+    TestSort<TraitsLane<OrderDescendingKV64> >(num_lanes);
+
 // Our HeapSort does not support 128-bit keys.
 #if VQSORT_ENABLED
     TestSort<Traits128<OrderAscending128> >(num_lanes);
@@ -583,6 +769,1389 @@ void TestAllSort() {
   }
 }
 
+// Also covers degenerate partitions: inputs with few or only one distinct key.
+template <class Traits>
+void TestSortParallel(ThreadPool& pool, size_t num_lanes) {
+  // Only enable EMU128 on x86 - it's slow on emulators.
+  if (!HWY_ARCH_X86 && (HWY_TARGET == HWY_EMU128)) return;
+
+  using LaneType = typename Traits::LaneType;
+  const SortTag<LaneType> d;
+  SharedTraits<Traits> st;
+
+  // Round up to a whole number of keys.
+  num_lanes += (st.Is128() && (num_lanes & 1));
+  auto aligned = hwy::AllocateAligned<LaneType>(num_lanes);
+  LaneType* lanes = aligned.get();
+  for (size_t distinct : {size_t{0}, size_t{8}, size_t{2}}) {
+    (void)GenerateInput(Dist::kUniform32, lanes, num_lanes);
+    // Only keep the first `distinct` lanes (0 = all); multiple of 2 so that
+    // 128-bit keys remain intact.
+    InputStats<LaneType> input_stats;
+    for (size_t i = 0; i < num_lanes; ++i) {
+      if (distinct != 0) lanes[i] = lanes[i % distinct];
+      input_stats.Notify(lanes[i]);
+    }
+
+    CompareResults<Traits> compare(lanes, num_lanes);
+    SortParallel(d, st, lanes, num_lanes, pool);
+    HWY_ASSERT(compare.Verify(lanes));
+    HWY_ASSERT(
+        VerifySort(st, input_stats, lanes, num_lanes, "TestSortParallel"));
+  }
+}
+
+void TestAllSortParallel() {
+  // Independent of the number of cores so that the parallel code paths are
+  // exercised on all machines.
+  ThreadPool pool(4);
+  for (int num : {1000, 1000 * 1000 + 7}) {
+    const size_t num_lanes = AdjustedReps(static_cast<size_t>(num));
+    TestSortParallel<TraitsLane<OrderAscending<uint16_t> > >(pool, num_lanes);
+    TestSortParallel<TraitsLane<OrderAscending<uint32_t> > >(pool, num_lanes);
+    TestSortParallel<TraitsLane<OrderDescending<int64_t> > >(pool, num_lanes);
+    TestSortParallel<TraitsLane<OrderDescending<float> > >(pool, num_lanes);
+    TestSortParallel<TraitsLane<OrderAscendingKV64> >(pool, num_lanes);
+
+#if VQSORT_ENABLED
+    TestSortParallel<Traits128<OrderAscending128> >(pool, num_lanes);
+    TestSortParallel<Traits128<OrderDescendingKV128> >(pool, num_lanes);
+#endif
+  }
+}
+
+template <class Traits>
+void TestPresorted(size_t num_lanes) {
+  // Only enable EMU128 on x86 - it's slow on emulators.
+  if (!HWY_ARCH_X86 && (HWY_TARGET == HWY_EMU128)) return;
+
+  using Order = typename Traits::Order;
+  using LaneType = typename Traits::LaneType;
+  using KeyType = typename Traits::KeyType;
+  SharedState shared;
+  const SortTag<LaneType> d;
+  SharedTraits<Traits> st;
+  constexpr size_t N1 = st.LanesPerKey();
+
+  // Round up to a whole number of keys.
+  num_lanes += (st.Is128() && (num_lanes & 1));
+  const size_t num_keys = num_lanes / N1;
+  auto aligned = hwy::AllocateAligned<LaneType>(num_lanes);
+  auto buf = hwy::AllocateAligned<LaneType>(
+      hwy::SortConstants::BufNum<LaneType>(Lanes(d)));
+  LaneType* lanes = aligned.get();
+  KeyType* keys = reinterpret_cast<KeyType*>(lanes);
+  // Length of the sorted (or reversed) prefix; the rest remains random.
+  for (size_t prefix : {num_keys, num_keys * 3 / 4, num_keys / 2, size_t{7}}) {
+    for (bool reverse : {false, true}) {
+      InputStats<LaneType> input_stats =
+          GenerateInput(Dist::kUniform32, lanes, num_lanes);
+      Run<Order>(Algo::kStd, keys, prefix, shared, /*thread=*/0);
+      if (reverse) std::reverse(keys, keys + prefix);
+      CompareResults<Traits> compare(lanes, num_lanes);
+
+      Sort(d, st, lanes, num_lanes, buf.get(), /*detect_presorted=*/true);
+      HWY_ASSERT(compare.Verify(lanes));
+      HWY_ASSERT(VerifySort(st, input_stats, lanes, num_lanes, "Presorted"));
+    }
+  }
+}
+
+void TestAllPresorted() {
+  for (int num : {1000, 100 * 1000 + 3}) {
+    const size_t num_lanes = AdjustedReps(static_cast<size_t>(num));
+    TestPresorted<TraitsLane<OrderAscending<uint16_t> > >(num_lanes);
+    TestPresorted<TraitsLane<OrderDescending<int32_t> > >(num_lanes);
+    TestPresorted<TraitsLane<OrderAscending<uint64_t> > >(num_lanes);
+    TestPresorted<TraitsLane<OrderDescending<float> > >(num_lanes);
+    TestPresorted<TraitsLane<OrderAscendingKV64> >(num_lanes);
+
+#if VQSORT_ENABLED
+    TestPresorted<Traits128<OrderDescending128> >(num_lanes);
+    TestPresorted<Traits128<OrderAscendingKV128> >(num_lanes);
+#endif
+  }
+
+  // Sorter is dynamically dispatched, hence testing one target suffices.
+  if (HWY_TARGET != HWY_STATIC_TARGET) return;
+  Sorter sorter;
+  sorter.SetDetectPresorted(true);
+  std::vector<int32_t> keys(12345);
+  for (size_t i = 0; i < keys.size(); ++i) {
+    keys[i] = static_cast<int32_t>(keys.size() - i) / 3;
+  }
+  std::vector<int32_t> expected = keys;
+  std::sort(expected.begin(), expected.end());
+  sorter(keys.data(), keys.size(), SortAscending());
+  HWY_ASSERT(keys == expected);
+}
+
+void TestAllSortStats() {
+  // Sorter is dynamically dispatched, hence testing one target suffices.
+  if (HWY_TARGET != HWY_STATIC_TARGET) return;
+  Sorter sorter;
+  SortStats stats;
+
+  // Small inputs only require the sorting network.
+  std::vector<uint32_t> keys(20);
+  for (size_t i = 0; i < keys.size(); ++i) {
+    keys[i] = static_cast<uint32_t>(keys.size() - i);
+  }
+  sorter(keys.data(), keys.size(), SortAscending(), stats);
+  HWY_ASSERT(std::is_sorted(keys.begin(), keys.end()));
+#if VQSORT_ENABLED
+  HWY_ASSERT(stats.base_cases == 1 && stats.partitions[0] == 0);
+  HWY_ASSERT(stats.max_depth == 0);
+#endif
+
+  // Random inputs partition the whole array once at depth 0.
+  const size_t num = 100 * 1000;
+  keys.resize(num);
+  (void)GenerateInput(Dist::kUniform32, keys.data(), num);
+  stats.Reset();
+  sorter(keys.data(), num, SortAscending(), stats);
+  HWY_ASSERT(std::is_sorted(keys.begin(), keys.end()));
+#if VQSORT_ENABLED
+  HWY_ASSERT(stats.partitions[0] == 1 && stats.keys_at_depth[0] == num);
+  HWY_ASSERT(stats.max_depth != 0 && stats.base_cases > 1);
+  HWY_ASSERT(stats.heap_sorts == 0);
+  for (size_t depth = 1; depth < SortStats::kMaxDepth; ++depth) {
+    HWY_ASSERT(stats.keys_at_depth[depth] <= num);
+  }
+#endif
+
+  // A single distinct key: the first (three-way) partition finishes.
+  std::fill(keys.begin(), keys.end(), 5u);
+  stats.Reset();
+  sorter(keys.data(), num, SortDescending(), stats);
+#if VQSORT_ENABLED
+  HWY_ASSERT(stats.three_way == 1 && stats.partitions[0] == 1);
+  HWY_ASSERT(stats.max_depth == 0 && stats.degenerate == 0);
+#endif
+
+  // Heavy hitters: keys equal to the pivot are excluded from the recursion.
+  for (size_t i = 0; i < num; ++i) {
+    keys[i] = (i % 4 == 0) ? static_cast<uint32_t>(i) : 7u;
+  }
+  stats.Reset();
+  sorter(keys.data(), num, SortAscending(), stats);
+  HWY_ASSERT(std::is_sorted(keys.begin(), keys.end()));
+#if VQSORT_ENABLED
+  HWY_ASSERT(stats.three_way != 0);
+#endif
+
+  // Statistics count 128-bit keys, not lanes, and accumulate across calls.
+  std::vector<uint128_t> keys128(num / 2);
+  (void)GenerateInput(Dist::kUniform32,
+                      reinterpret_cast<uint64_t*>(keys128.data()), num);
+  stats.Reset();
+  sorter(keys128.data(), keys128.size(), SortAscending(), stats);
+  sorter(keys128.data(), keys128.size(), SortDescending(), stats);
+#if VQSORT_ENABLED
+  HWY_ASSERT(stats.partitions[0] == 2 && stats.keys_at_depth[0] == num);
+#endif
+}
+
+// Counts calls from Sorter(AllocPtr, FreePtr, opaque).
+struct CountingArena {
+  static void* Alloc(void* opaque, size_t bytes) {
+    ++static_cast<CountingArena*>(opaque)->num_allocs;
+    return malloc(bytes);
+  }
+  static void Free(void* opaque, void* memory) {
+    ++static_cast<CountingArena*>(opaque)->num_frees;
+    free(memory);
+  }
+  size_t num_allocs = 0;
+  size_t num_frees = 0;
+};
+
+void VerifySortsWith(const Sorter& sorter) {
+  for (size_t num : {size_t{3}, size_t{37}, size_t{1000}, size_t{100003}}) {
+    std::vector<uint64_t> keys(num);
+    (void)GenerateInput(Dist::kUniform32, keys.data(), num);
+    sorter(keys.data(), num, SortDescending());
+    HWY_ASSERT(std::is_sorted(keys.rbegin(), keys.rend()));
+    std::vector<uint16_t> keys16(num);
+    for (size_t i = 0; i < num; ++i) {
+      keys16[i] = static_cast<uint16_t>(keys[i] * 0x9E37u);
+    }
+    sorter.PartialSort(keys16.data(), num, num / 2, SortAscending());
+    HWY_ASSERT(std::is_sorted(keys16.begin(), keys16.begin() + num / 2));
+  }
+}
+
+void TestAllSorterScratch() {
+  // Sorter is dynamically dispatched, hence testing one target suffices.
+  if (HWY_TARGET != HWY_STATIC_TARGET) return;
+  const size_t bytes = Sorter::ScratchBytes();
+  HWY_ASSERT(bytes != 0);
+
+  // Caller-owned scratch, which may be larger than required and is reused.
+  auto scratch = hwy::AllocateAligned<uint8_t>(bytes + 64);
+  HWY_ASSERT(scratch);
+  VerifySortsWith(Sorter(scratch.get(), bytes + 64));
+  VerifySortsWith(Sorter(scratch.get(), bytes));
+
+  // Allocator: one allocation for the lifetime of the Sorter, also if moved.
+  CountingArena arena;
+  {
+    Sorter sorter(&CountingArena::Alloc, &CountingArena::Free, &arena);
+    HWY_ASSERT(arena.num_allocs == 1 && arena.num_frees == 0);
+    Sorter moved(std::move(sorter));
+    VerifySortsWith(moved);
+    sorter = std::move(moved);
+    VerifySortsWith(sorter);
+    HWY_ASSERT(arena.num_allocs == 1 && arena.num_frees == 0);
+  }
+  HWY_ASSERT(arena.num_allocs == 1 && arena.num_frees == 1);
+}
+
+void TestAllSortTuning() {
+  // Sorter is dynamically dispatched, hence testing one target suffices.
+  if (HWY_TARGET != HWY_STATIC_TARGET) return;
+  const SortTuning defaults;
+  HWY_ASSERT(defaults.IsValid());
+  HWY_ASSERT(Sorter::Tuning().IsValid());
+
+  for (uint32_t rows : {4u, 8u, 16u}) {
+    for (uint32_t unroll : {2u, 4u}) {
+      for (uint32_t chunks : {3u, 9u}) {
+        for (uint32_t block = 0; block < 1 + VQSORT_BLOCK_PARTITION;
+             ++block) {
+          SortTuning tuning;
+          tuning.base_case_rows = rows;
+          tuning.partition_unroll = unroll;
+          tuning.pivot_chunks = chunks;
+          tuning.block_partition = block;
+          HWY_ASSERT(Sorter::SetTuning(tuning));
+          for (size_t num : {size_t{300}, size_t{5000}}) {
+            const size_t num_lanes = AdjustedReps(num);
+            TestSort<TraitsLane<OrderDescending<uint16_t> > >(num_lanes);
+            TestSort<TraitsLane<OrderAscending<int32_t> > >(num_lanes);
+            TestSort<TraitsLane<OrderDescending<uint64_t> > >(num_lanes);
+            TestSort<TraitsLane<OrderAscendingKV64> >(num_lanes);
+#if VQSORT_ENABLED
+            TestSort<Traits128<OrderDescending128> >(num_lanes);
+#endif
+          }
+          VerifySortsWith(Sorter());
+        }
+      }
+    }
+  }
+
+#if VQSORT_STREAM_PARTITION
+  // Streaming all partitions of at least 1 MiB.
+  {
+    SortTuning tuning;
+    tuning.stream_partition_mib = 1;
+    HWY_ASSERT(Sorter::SetTuning(tuning));
+    const size_t num_lanes = AdjustedReps(size_t{1} << 19);
+    TestSort<TraitsLane<OrderAscending<uint32_t> > >(num_lanes);
+    TestSort<TraitsLane<OrderDescending<uint64_t> > >(num_lanes);
+    TestSort<TraitsLane<OrderAscendingKV64> >(num_lanes);
+  }
+#endif
+
+  // Invalid values are rejected and do not change the tuning.
+  SortTuning invalid;
+  invalid.partition_unroll = 3;
+  HWY_ASSERT(!Sorter::SetTuning(invalid));
+  HWY_ASSERT(Sorter::Tuning().partition_unroll == 4);
+  SortTuning huge_stream;
+  huge_stream.stream_partition_mib = (1u << 20) + 1;
+  HWY_ASSERT(!huge_stream.IsValid());
+
+  // Round trip via file.
+  SortTuning tuning;
+  tuning.base_case_rows = 8;
+  tuning.pivot_chunks = 3;
+  tuning.block_partition = 1;
+  tuning.stream_partition_mib = 64;
+  tuning.radix_max_passes = 2;
+  const std::string path =
+      ExternalSorter().TempDir() + "/hwy_sort_test_tuning";
+  HWY_ASSERT(Sorter::SaveTuning(path.c_str(), tuning));
+  HWY_ASSERT(Sorter::SetTuning(defaults));
+  HWY_ASSERT(Sorter::LoadTuning(path.c_str()));
+  HWY_ASSERT(Sorter::Tuning().base_case_rows == 8);
+  HWY_ASSERT(Sorter::Tuning().partition_unroll == 4);
+  HWY_ASSERT(Sorter::Tuning().pivot_chunks == 3);
+  HWY_ASSERT(Sorter::Tuning().block_partition == 1);
+  HWY_ASSERT(Sorter::Tuning().stream_partition_mib == 64);
+  HWY_ASSERT(Sorter::Tuning().radix_max_passes == 2);
+
+  // Profiles for another instruction set or with invalid values are ignored.
+  HWY_ASSERT(Sorter::SetTuning(defaults));
+  FILE* file = fopen(path.c_str(), "w");
+  HWY_ASSERT(file != nullptr);
+  fputs("target=Unknown\nbase_case_rows=4\npartition_unroll=2\n", file);
+  HWY_ASSERT(fclose(file) == 0);
+  HWY_ASSERT(!Sorter::LoadTuning(path.c_str()));
+  HWY_ASSERT(Sorter::SaveTuning(path.c_str(), invalid));
+  HWY_ASSERT(!Sorter::LoadTuning(path.c_str()));
+  HWY_ASSERT(!Sorter::LoadTuning((path + "_missing").c_str()));
+  HWY_ASSERT(Sorter::Tuning().base_case_rows == 16);
+  HWY_ASSERT(Sorter::Tuning().partition_unroll == 4);
+  remove(path.c_str());
+}
+
+template <class Traits>
+void TestRadixSort(size_t num_lanes) {
+  // Only enable EMU128 on x86 - it's slow on emulators.
+  if (!HWY_ARCH_X86 && (HWY_TARGET == HWY_EMU128)) return;
+
+  using LaneType = typename Traits::LaneType;
+  const SortTag<LaneType> d;
+  SharedTraits<Traits> st;
+  constexpr size_t kAllDigits =
+      sizeof(LaneType) * 8 / RadixConstants::kDigitBits;
+
+  auto aligned = hwy::AllocateAligned<LaneType>(num_lanes);
+  auto buf = hwy::AllocateAligned<LaneType>(Lanes(d));
+  LaneType* lanes = aligned.get();
+  // Number of varying low bits; 0 means all keys are equal.
+  for (size_t bits : {0, 12, 31}) {
+    (void)GenerateInput(Dist::kUniform32, lanes, num_lanes);
+    const uint64_t mask = (1ull << bits) - 1;
+    // Signed keys are centered on zero so that all digits vary.
+    const LaneType base = IsSigned<LaneType>()
+                              ? static_cast<LaneType>(0 - mask / 2)
+                              : static_cast<LaneType>(0x1000);
+    InputStats<LaneType> input_stats;
+    for (size_t i = 0; i < num_lanes; ++i) {
+      lanes[i] = static_cast<LaneType>(
+          static_cast<LaneType>(static_cast<uint64_t>(lanes[i]) & mask) + base);
+      input_stats.Notify(lanes[i]);
+    }
+    const std::vector<LaneType> copy(lanes, lanes + num_lanes);
+    CompareResults<Traits> compare(lanes, num_lanes);
+
+    // Too many passes: declines without modifying the keys.
+    if (bits != 0) {
+      HWY_ASSERT(!detail::RadixSort(d, st, lanes, num_lanes, buf.get(), 1));
+      HWY_ASSERT(std::equal(copy.begin(), copy.end(), lanes));
+    }
+
+    HWY_ASSERT(
+        detail::RadixSort(d, st, lanes, num_lanes, buf.get(), kAllDigits));
+    HWY_ASSERT(compare.Verify(lanes));
+    HWY_ASSERT(VerifySort(st, input_stats, lanes, num_lanes, "RadixSort"));
+  }
+}
+
+void TestAllRadixSort() {
+  for (int num : {1000, 100 * 1000 + 3}) {
+    const size_t num_lanes = AdjustedReps(static_cast<size_t>(num));
+    TestRadixSort<TraitsLane<OrderAscending<uint32_t> > >(num_lanes);
+    TestRadixSort<TraitsLane<OrderDescending<uint32_t> > >(num_lanes);
+    TestRadixSort<TraitsLane<OrderAscending<int32_t> > >(num_lanes);
+    TestRadixSort<TraitsLane<OrderDescending<int64_t> > >(num_lanes);
+    TestRadixSort<TraitsLane<OrderAscending<uint64_t> > >(num_lanes);
+  }
+
+  // Sort only radix sorts if enabled via SortTuning.
+  const SortTag<uint64_t> d;
+  SharedTraits<TraitsLane<OrderDescending<uint64_t> > > st;
+  auto buf = hwy::AllocateAligned<uint64_t>(
+      hwy::SortConstants::BufNum<uint64_t>(Lanes(d)));
+  SortStats stats;
+
+  // Large input with only two varying digits.
+  const size_t num = RadixConstants::kMinKeys + 5;
+  std::vector<uint64_t> keys(num);
+  (void)GenerateInput(Dist::kUniform32, keys.data(), num);
+  for (uint64_t& key : keys) key = (key & 0xFFFF) | (1ull << 40);
+  const std::vector<uint64_t> input = keys;
+  SortTuning tuning;
+  for (uint32_t max_passes : {0u, 1u, 2u}) {
+    tuning.radix_max_passes = max_passes;
+    HWY_ASSERT(tuning.IsValid());
+    keys = input;
+    stats.Reset();
+    Sort(d, st, keys.data(), num, buf.get(), /*detect_presorted=*/false,
+         &stats, &tuning);
+    HWY_ASSERT(std::is_sorted(keys.rbegin(), keys.rend()));
+#if VQSORT_ENABLED
+    const bool radix = max_passes >= 2;
+    HWY_ASSERT(stats.radix_sorts == (radix ? 1u : 0u));
+    HWY_ASSERT(stats.partitions[0] == (radix ? 0u : 1u));
+#endif
+  }
+
+  // Frequent keys are better handled by three-way partitioning.
+  std::fill(keys.begin(), keys.end(), 3u);
+  stats.Reset();
+  Sort(d, st, keys.data(), num, buf.get(), /*detect_presorted=*/false, &stats,
+       &tuning);
+  HWY_ASSERT(stats.radix_sorts == 0);
+}
+
+template <class Traits>
+void TestSampleSort(size_t num_lanes) {
+  // Only enable EMU128 on x86 - it's slow on emulators.
+  if (!HWY_ARCH_X86 && (HWY_TARGET == HWY_EMU128)) return;
+
+  using LaneType = typename Traits::LaneType;
+  const SortTag<LaneType> d;
+  SharedTraits<Traits> st;
+  // Buckets are heap-sorted so that only the distribution is tested.
+  const auto sort_small = [st](LaneType* HWY_RESTRICT keys, size_t num) {
+    detail::HeapSort(st, keys, num);
+  };
+
+  auto aligned = hwy::AllocateAligned<LaneType>(num_lanes);
+  LaneType* lanes = aligned.get();
+  // Number of varying low bits; 0 means all keys are equal.
+  for (size_t bits : {0, 12, 31}) {
+    (void)GenerateInput(Dist::kUniform32, lanes, num_lanes);
+    const uint64_t mask = (1ull << bits) - 1;
+    InputStats<LaneType> input_stats;
+    for (size_t i = 0; i < num_lanes; ++i) {
+      lanes[i] = static_cast<LaneType>(static_cast<uint64_t>(lanes[i]) & mask);
+      input_stats.Notify(lanes[i]);
+    }
+    const std::vector<LaneType> copy(lanes, lanes + num_lanes);
+    CompareResults<Traits> compare(lanes, num_lanes);
+
+    // Bypasses the kMinKeys check of SampleSort to cover partial blocks.
+    detail::SampleSorter<SortTag<LaneType>, SharedTraits<Traits>,
+                         decltype(sort_small)>
+        sorter(d, st, sort_small);
+    detail::Generator rng(lanes, num_lanes);
+    if (bits == 0) {
+      // Too few distinct splitters: declines without modifying the keys.
+      HWY_ASSERT(!sorter(lanes, num_lanes, rng));
+      HWY_ASSERT(std::equal(copy.begin(), copy.end(), lanes));
+      continue;
+    }
+    HWY_ASSERT(sorter(lanes, num_lanes, rng));
+    HWY_ASSERT(compare.Verify(lanes));
+    HWY_ASSERT(VerifySort(st, input_stats, lanes, num_lanes, "SampleSort"));
+  }
+}
+
+void TestAllSampleSort() {
+  for (int num : {1000, 100 * 1000 + 3}) {
+    const size_t num_lanes = AdjustedReps(static_cast<size_t>(num));
+    TestSampleSort<TraitsLane<OrderAscending<uint32_t> > >(num_lanes);
+    TestSampleSort<TraitsLane<OrderDescending<uint32_t> > >(num_lanes);
+    TestSampleSort<TraitsLane<OrderAscending<int32_t> > >(num_lanes);
+    TestSampleSort<TraitsLane<OrderDescending<int64_t> > >(num_lanes);
+    TestSampleSort<TraitsLane<OrderAscending<uint64_t> > >(num_lanes);
+  }
+
+  // Large input whose buckets are sorted by vqsort.
+  const SortTag<uint32_t> d;
+  SharedTraits<TraitsLane<OrderAscending<uint32_t> > > st;
+  auto buf = hwy::AllocateAligned<uint32_t>(
+      hwy::SortConstants::BufNum<uint32_t>(Lanes(d)));
+  const size_t num = SampleSortConstants::kMinKeys + 5;
+  std::vector<uint32_t> keys(num);
+  (void)GenerateInput(Dist::kUniform32, keys.data(), num);
+  SortStats stats;
+  {
+    detail::Generator rng(keys.data(), num);
+    detail::StatsRecorder recorder(stats);
+    HWY_ASSERT(detail::SampleSortWithBuf(d, st, keys.data(), num, buf.get(),
+                                         SortTuning(), rng, recorder));
+  }
+  HWY_ASSERT(std::is_sorted(keys.begin(), keys.end()));
+  HWY_ASSERT(stats.sample_sorts == 1);
+
+  // Whether Sort samplesorts depends on the target.
+  (void)GenerateInput(Dist::kUniform32, keys.data(), num);
+  stats.Reset();
+  Sort(d, st, keys.data(), num, buf.get(), /*detect_presorted=*/false, &stats);
+  HWY_ASSERT(std::is_sorted(keys.begin(), keys.end()));
+#if VQSORT_ENABLED
+  const bool sample = detail::UseSampleSort<uint32_t>();
+  HWY_ASSERT(stats.sample_sorts == (sample ? 1u : 0u));
+#endif
+}
+
+template <class Traits>
+void TestPartialSort(size_t num_lanes) {
+  // Only enable EMU128 on x86 - it's slow on emulators.
+  if (!HWY_ARCH_X86 && (HWY_TARGET == HWY_EMU128)) return;
+
+  using Order = typename Traits::Order;
+  using LaneType = typename Traits::LaneType;
+  using KeyType = typename Traits::KeyType;
+  SharedState shared;
+  const SortTag<LaneType> d;
+  SharedTraits<Traits> st;
+  constexpr size_t N1 = st.LanesPerKey();
+
+  // Round up to a whole number of keys.
+  num_lanes += (st.Is128() && (num_lanes & 1));
+  const size_t num_keys = num_lanes / N1;
+  auto aligned = hwy::AllocateAligned<LaneType>(num_lanes);
+  auto expected = hwy::AllocateAligned<LaneType>(num_lanes);
+  auto buf = hwy::AllocateAligned<LaneType>(
+      hwy::SortConstants::BufNum<LaneType>(Lanes(d)));
+  LaneType* lanes = aligned.get();
+  for (size_t k : {size_t{0}, size_t{1}, size_t{7}, num_keys / 100,
+                   num_keys / 2, num_keys - 1, num_keys}) {
+    (void)GenerateInput(Dist::kUniform32, lanes, num_lanes);
+    memcpy(expected.get(), lanes, num_lanes * sizeof(LaneType));
+    Run<Order>(Algo::kStd, reinterpret_cast<KeyType*>(expected.get()),
+               num_keys, shared, /*thread=*/0);
+
+    PartialSort(d, st, lanes, num_lanes, k * N1, buf.get());
+    // Sorting the remainder must yield the expected keys, which also verifies
+    // that no keys were lost or duplicated.
+    Run<Order>(Algo::kStd, reinterpret_cast<KeyType*>(lanes + k * N1),
+               num_keys - k, shared, /*thread=*/0);
+    for (size_t i = 0; i < num_lanes; ++i) {
+      if (lanes[i] != expected[i]) {
+        HWY_ABORT("%s: k %d of %d mismatch at lane %d (%s)\n",
+                  st.KeyString().c_str(), static_cast<int>(k),
+                  static_cast<int>(num_keys), static_cast<int>(i),
+                  i < k * N1 ? "prefix" : "remainder");
+      }
+    }
+  }
+}
+
+void TestAllPartialSort() {
+  for (int num : {1000, 100 * 1000 + 3}) {
+    const size_t num_lanes = AdjustedReps(static_cast<size_t>(num));
+    TestPartialSort<TraitsLane<OrderAscending<uint16_t> > >(num_lanes);
+    TestPartialSort<TraitsLane<OrderDescending<int32_t> > >(num_lanes);
+    TestPartialSort<TraitsLane<OrderAscending<uint64_t> > >(num_lanes);
+    TestPartialSort<TraitsLane<OrderDescending<float> > >(num_lanes);
+
+#if VQSORT_ENABLED
+    TestPartialSort<Traits128<OrderAscending128> >(num_lanes);
+    TestPartialSort<Traits128<OrderDescendingKV128> >(num_lanes);
+#endif
+  }
+}
+
+template <class Traits>
+void TestSelect(size_t num_lanes) {
+  // Only enable EMU128 on x86 - it's slow on emulators.
+  if (!HWY_ARCH_X86 && (HWY_TARGET == HWY_EMU128)) return;
+
+  using Order = typename Traits::Order;
+  using LaneType = typename Traits::LaneType;
+  using KeyType = typename Traits::KeyType;
+  SharedState shared;
+  const SortTag<LaneType> d;
+  SharedTraits<Traits> st;
+  constexpr size_t N1 = st.LanesPerKey();
+
+  // Round up to a whole number of keys.
+  num_lanes += (st.Is128() && (num_lanes & 1));
+  const size_t num_keys = num_lanes / N1;
+  auto aligned = hwy::AllocateAligned<LaneType>(num_lanes);
+  auto expected = hwy::AllocateAligned<LaneType>(num_lanes);
+  auto buf = hwy::AllocateAligned<LaneType>(
+      hwy::SortConstants::BufNum<LaneType>(Lanes(d)));
+  LaneType* lanes = aligned.get();
+  for (size_t distinct : {size_t{0}, size_t{8}}) {
+    for (size_t nth : {size_t{0}, size_t{1}, num_keys / 3, num_keys / 2,
+                       num_keys - 2, num_keys - 1}) {
+      (void)GenerateInput(Dist::kUniform32, lanes, num_lanes);
+      // As in TestSortParallel, optionally only keep `distinct` lanes.
+      for (size_t i = 0; i < num_lanes; ++i) {
+        if (distinct != 0) lanes[i] = lanes[i % distinct];
+      }
+      memcpy(expected.get(), lanes, num_lanes * sizeof(LaneType));
+      Run<Order>(Algo::kStd, reinterpret_cast<KeyType*>(expected.get()),
+                 num_keys, shared, /*thread=*/0);
+
+      Select(d, st, lanes, num_lanes, nth * N1, buf.get());
+      // Sorting both sides of nth must yield the expected keys, which also
+      // verifies that they were correctly partitioned and none were lost.
+      Run<Order>(Algo::kStd, reinterpret_cast<KeyType*>(lanes), nth, shared,
+                 /*thread=*/0);
+      Run<Order>(Algo::kStd, reinterpret_cast<KeyType*>(lanes + (nth + 1) * N1),
+                 num_keys - nth - 1, shared, /*thread=*/0);
+      for (size_t i = 0; i < num_lanes; ++i) {
+        if (lanes[i] != expected[i]) {
+          HWY_ABORT("%s: nth %d of %d mismatch at lane %d\n",
+                    st.KeyString().c_str(), static_cast<int>(nth),
+                    static_cast<int>(num_keys), static_cast<int>(i));
+        }
+      }
+    }
+  }
+}
+
+void TestAllSelect() {
+  for (int num : {1000, 100 * 1000 + 3}) {
+    const size_t num_lanes = AdjustedReps(static_cast<size_t>(num));
+    TestSelect<TraitsLane<OrderDescending<uint16_t> > >(num_lanes);
+    TestSelect<TraitsLane<OrderAscending<int32_t> > >(num_lanes);
+    TestSelect<TraitsLane<OrderDescending<int64_t> > >(num_lanes);
+    TestSelect<TraitsLane<OrderAscending<float> > >(num_lanes);
+
+#if VQSORT_ENABLED
+    TestSelect<Traits128<OrderDescending128> >(num_lanes);
+    TestSelect<Traits128<OrderAscendingKV128> >(num_lanes);
+#endif
+  }
+}
+
+template <class Traits>
+void TestMerge(size_t num_lanes) {
+  // Only enable EMU128 on x86 - it's slow on emulators.
+  if (!HWY_ARCH_X86 && (HWY_TARGET == HWY_EMU128)) return;
+
+  using Order = typename Traits::Order;
+  using LaneType = typename Traits::LaneType;
+  using KeyType = typename Traits::KeyType;
+  SharedState shared;
+  const SortTag<LaneType> d;
+  SharedTraits<Traits> st;
+  constexpr size_t N1 = st.LanesPerKey();
+
+  // Round up to a whole number of keys.
+  num_lanes += (st.Is128() && (num_lanes & 1));
+  const size_t num_keys = num_lanes / N1;
+  auto aligned = hwy::AllocateAligned<LaneType>(num_lanes);
+  auto out = hwy::AllocateAligned<LaneType>(num_lanes);
+  LaneType* lanes = aligned.get();
+  for (size_t distinct : {size_t{0}, size_t{8}}) {
+    for (size_t na : {size_t{0}, size_t{1}, size_t{7}, num_keys / 3,
+                      num_keys - 1, num_keys}) {
+      (void)GenerateInput(Dist::kUniform32, lanes, num_lanes);
+      // As in TestSelect, optionally only keep `distinct` lanes.
+      InputStats<LaneType> input_stats;
+      for (size_t i = 0; i < num_lanes; ++i) {
+        if (distinct != 0) lanes[i] = lanes[i % distinct];
+        input_stats.Notify(lanes[i]);
+      }
+      CompareResults<Traits> compare(lanes, num_lanes);
+
+      // Sort both runs, then merge them.
+      LaneType* b = lanes + na * N1;
+      Run<Order>(Algo::kStd, reinterpret_cast<KeyType*>(lanes), na, shared,
+                 /*thread=*/0);
+      Run<Order>(Algo::kStd, reinterpret_cast<KeyType*>(b), num_keys - na,
+                 shared, /*thread=*/0);
+      Merge(d, st, lanes, na * N1, b, num_lanes - na * N1, out.get());
+
+      HWY_ASSERT(compare.Verify(out.get()));
+      HWY_ASSERT(VerifySort(st, input_stats, out.get(), num_lanes, "Merge"));
+    }
+  }
+}
+
+void TestAllMerge() {
+  for (int num : {100, 1000, 100 * 1000 + 3}) {
+    const size_t num_lanes = AdjustedReps(static_cast<size_t>(num));
+    TestMerge<TraitsLane<OrderAscending<uint16_t> > >(num_lanes);
+    TestMerge<TraitsLane<OrderDescending<int16_t> > >(num_lanes);
+    TestMerge<TraitsLane<OrderDescending<int32_t> > >(num_lanes);
+    TestMerge<TraitsLane<OrderAscending<uint32_t> > >(num_lanes);
+    TestMerge<TraitsLane<OrderAscending<int64_t> > >(num_lanes);
+    TestMerge<TraitsLane<OrderDescending<uint64_t> > >(num_lanes);
+    TestMerge<TraitsLane<OrderAscending<float> > >(num_lanes);
+    TestMerge<TraitsLane<OrderDescendingKV64> >(num_lanes);
+
+#if VQSORT_ENABLED
+    TestMerge<Traits128<OrderAscending128> >(num_lanes);
+    TestMerge<Traits128<OrderDescending128> >(num_lanes);
+    TestMerge<Traits128<OrderAscendingKV128> >(num_lanes);
+#endif
+  }
+}
+
+template <class Traits>
+void TestSortSegments() {
+  // Only enable EMU128 on x86 - it's slow on emulators.
+  if (!HWY_ARCH_X86 && (HWY_TARGET == HWY_EMU128)) return;
+
+  using LaneType = typename Traits::LaneType;
+  using KeyType = typename Traits::KeyType;
+  const SortTag<LaneType> d;
+  SharedTraits<Traits> st;
+  constexpr size_t N1 = st.LanesPerKey();
+
+  // Mostly small segments, including empty and single-key ones, plus one that
+  // requires partitioning. Offsets are in keys.
+  std::mt19937_64 rng(123);
+  std::vector<size_t> offsets = {0};
+  for (size_t s = 0; s < 300; ++s) {
+    const size_t num = (s == 150) ? 5000 : static_cast<size_t>(rng() % 400);
+    offsets.push_back(offsets.back() + (s % 37 == 0 ? s % 2 : num));
+  }
+  const size_t num_segments = offsets.size() - 1;
+  const size_t num_lanes = offsets.back() * N1;
+  auto aligned = hwy::AllocateAligned<LaneType>(num_lanes);
+  LaneType* lanes = aligned.get();
+  (void)GenerateInput(Dist::kUniform32, lanes, num_lanes);
+  std::vector<CompareResults<Traits>> compare;
+  for (size_t s = 0; s < num_segments; ++s) {
+    compare.emplace_back(lanes + offsets[s] * N1,
+                         (offsets[s + 1] - offsets[s]) * N1);
+  }
+
+  auto buf = hwy::AllocateAligned<LaneType>(
+      hwy::SortConstants::BufNum<LaneType>(Lanes(d)));
+  SortSegments(d, st, lanes, offsets.data(), num_segments, buf.get());
+
+  for (size_t s = 0; s < num_segments; ++s) {
+    HWY_ASSERT(compare[s].Verify(lanes + offsets[s] * N1));
+  }
+
+  // Sorter is dynamically dispatched, hence testing one target suffices.
+  if (HWY_TARGET != HWY_STATIC_TARGET) return;
+  (void)GenerateInput(Dist::kUniform32, lanes, num_lanes);
+  for (size_t s = 0; s < num_segments; ++s) {
+    compare[s] = CompareResults<Traits>(lanes + offsets[s] * N1,
+                                        (offsets[s + 1] - offsets[s]) * N1);
+  }
+  Sorter sorter;
+  KeyType* keys = reinterpret_cast<KeyType*>(lanes);
+  if (typename Traits::Order().IsAscending()) {
+    sorter.SortSegments(keys, offsets.data(), num_segments, SortAscending());
+  } else {
+    sorter.SortSegments(keys, offsets.data(), num_segments, SortDescending());
+  }
+  for (size_t s = 0; s < num_segments; ++s) {
+    HWY_ASSERT(compare[s].Verify(lanes + offsets[s] * N1));
+  }
+}
+
+void TestAllSortSegments() {
+  TestSortSegments<TraitsLane<OrderAscending<uint16_t> > >();
+  TestSortSegments<TraitsLane<OrderDescending<int16_t> > >();
+  TestSortSegments<TraitsLane<OrderDescending<int32_t> > >();
+  TestSortSegments<TraitsLane<OrderAscending<uint32_t> > >();
+  TestSortSegments<TraitsLane<OrderAscending<int64_t> > >();
+  TestSortSegments<TraitsLane<OrderDescending<uint64_t> > >();
+  TestSortSegments<TraitsLane<OrderAscending<float> > >();
+  TestSortSegments<TraitsLane<OrderDescending<double> > >();
+  TestSortSegments<TraitsLane<OrderAscendingKV64> >();
+  TestSortSegments<TraitsLane<OrderDescendingKV64> >();
+#if VQSORT_ENABLED
+  TestSortSegments<Traits128<OrderAscending128> >();
+  TestSortSegments<Traits128<OrderDescending128> >();
+  TestSortSegments<Traits128<OrderAscendingKV128> >();
+  TestSortSegments<Traits128<OrderDescendingKV128> >();
+#endif
+}
+
+// Calls `func(num)` for each of `sizes`. Sorter is dynamically dispatched,
+// hence testing one target suffices.
+template <class Func>
+void ForSorterSizes(std::initializer_list<size_t> sizes, const Func& func) {
+  if (HWY_TARGET != HWY_STATIC_TARGET) return;
+  for (size_t num : sizes) func(num);
+}
+
+// As above, for a single key, sizes below and above the base case, and one
+// large enough for several levels of recursion.
+template <class Func>
+void ForSorterSizes(const Func& func) {
+  ForSorterSizes({1, 37, 1000, 100003}, func);
+}
+
+// Aborts if any of the `num` elements differ. The comparison is bitwise, which
+// also verifies NaN payloads and the sign of zero.
+template <typename T>
+void VerifyEqual(const char* caller, const T* expected, const T* actual,
+                 size_t num) {
+  for (size_t i = 0; i < num; ++i) {
+    if (memcmp(&expected[i], &actual[i], sizeof(T)) != 0) {
+      HWY_ABORT("%s %d-byte keys: mismatch at %d of %d\n", caller,
+                static_cast<int>(sizeof(T)), static_cast<int>(i),
+                static_cast<int>(num));
+    }
+  }
+}
+
+// Returns bits whose unsigned order is the IEEE 754 totalOrder of `key`, which
+// is float16_t, bfloat16_t, float or double.
+template <typename T>
+UnsignedFromSize<sizeof(T)> TotalOrderBits(T key) {
+  using TU = UnsignedFromSize<sizeof(T)>;
+  constexpr TU kSign = static_cast<TU>(TU{1} << (sizeof(TU) * 8 - 1));
+  TU bits;
+  CopyBytes<sizeof(T)>(&key, &bits);
+  return static_cast<TU>((bits & kSign) ? ~bits : bits | kSign);
+}
+
+template <typename T, class Order>
+void TestSort8(size_t num, Order order) {
+  std::mt19937_64 rng(static_cast<uint64_t>(num));
+  std::vector<T> keys(num);
+  for (T& key : keys) {
+    key = static_cast<T>(rng() & 0xFF);
+  }
+  std::vector<T> expected = keys;
+  if (order.IsAscending()) {
+    std::sort(expected.begin(), expected.end(), std::less<T>());
+  } else {
+    std::sort(expected.begin(), expected.end(), std::greater<T>());
+  }
+
+  Sorter sorter;
+  sorter(keys.data(), num, order);
+  VerifyEqual("Sort8", expected.data(), keys.data(), num);
+}
+
+void TestAllSort8() {
+  // Sizes below and above the threshold for counting.
+  ForSorterSizes({0, 1, 37, 256, 257, 1000, 100003}, [](size_t num) {
+    TestSort8<uint8_t>(num, SortAscending());
+    TestSort8<uint8_t>(num, SortDescending());
+    TestSort8<int8_t>(num, SortAscending());
+    TestSort8<int8_t>(num, SortDescending());
+  });
+}
+
+template <typename T, class Order>
+void TestSortFloat16(size_t num, Order order) {
+  static_assert(sizeof(T) == 2, "Expected float16_t or bfloat16_t");
+  std::mt19937_64 rng(static_cast<uint64_t>(num));
+  std::vector<T> keys(num);
+  // +/-0, +/-inf and +/-NaN (if float16_t), then random bits, which include
+  // denormals and NaN.
+  const uint16_t kSpecial[] = {0x0000, 0x8000, 0x7C00, 0xFC00, 0x7E00, 0xFE00};
+  for (size_t i = 0; i < num; ++i) {
+    keys[i].bits =
+        i < 6 ? kSpecial[i] : static_cast<uint16_t>(rng() & 0xFFFF);
+  }
+  std::shuffle(keys.begin(), keys.end(), rng);
+  std::vector<T> expected = keys;
+  std::sort(expected.begin(), expected.end(), [order](T a, T b) {
+    return order.IsAscending() ? TotalOrderBits(a) < TotalOrderBits(b)
+                               : TotalOrderBits(b) < TotalOrderBits(a);
+  });
+
+  Sorter sorter;
+  sorter(keys.data(), num, order);
+  VerifyEqual("SortFloat16", expected.data(), keys.data(), num);
+}
+
+void TestAllSortFloat16() {
+  ForSorterSizes({6, 37, 1000, 100003}, [](size_t num) {
+    TestSortFloat16<float16_t>(num, SortAscending());
+    TestSortFloat16<float16_t>(num, SortDescending());
+    TestSortFloat16<bfloat16_t>(num, SortAscending());
+    TestSortFloat16<bfloat16_t>(num, SortDescending());
+  });
+}
+
+// Few distinct keys but unique values: only the keys are compared, hence the
+// all-equal detection must ignore the values.
+template <class Order>
+void TestSortKV64DuplicateKeys(size_t num, Order order) {
+  std::mt19937_64 rng(static_cast<uint64_t>(num));
+  std::vector<K32V32> kv(num);
+  for (size_t i = 0; i < num; ++i) {
+    kv[i].key = static_cast<uint32_t>(rng() % 3);
+    kv[i].value = static_cast<uint32_t>(i);
+  }
+  const auto before = [order](const K32V32& a, const K32V32& b) {
+    return order.IsAscending() ? a < b : b < a;
+  };
+  std::vector<K32V32> expected = kv;
+  std::sort(expected.begin(), expected.end(), before);
+
+  Sorter sorter;
+  sorter(kv.data(), num, order);
+  std::vector<uint32_t> values(num);
+  std::vector<uint32_t> expected_values(num);
+  for (size_t i = 0; i < num; ++i) {
+    HWY_ASSERT_EQ(expected[i].key, kv[i].key);
+    values[i] = kv[i].value;
+    expected_values[i] = expected[i].value;
+  }
+  // Values of equal keys may be permuted, but none are lost or duplicated.
+  std::sort(values.begin(), values.end());
+  std::sort(expected_values.begin(), expected_values.end());
+  HWY_ASSERT(values == expected_values);
+
+  // Same for the first half, and for the middle key.
+  std::shuffle(kv.begin(), kv.end(), rng);
+  const size_t k = num / 2;
+  sorter.PartialSort(kv.data(), num, k, order);
+  for (size_t i = 0; i < k; ++i) {
+    HWY_ASSERT_EQ(expected[i].key, kv[i].key);
+  }
+  std::shuffle(kv.begin(), kv.end(), rng);
+  sorter.Select(kv.data(), num, k, order);
+  HWY_ASSERT_EQ(expected[k].key, kv[k].key);
+  for (size_t i = 0; i < num; ++i) {
+    HWY_ASSERT(i <= k || !before(kv[i], kv[k]));
+    HWY_ASSERT(i >= k || !before(kv[k], kv[i]));
+  }
+}
+
+void TestAllSortKV64() {
+  ForSorterSizes([](size_t num) {
+    TestSortKV64DuplicateKeys(num, SortAscending());
+    TestSortKV64DuplicateKeys(num, SortDescending());
+  });
+}
+
+// K64V64 keys equal to the padding of small inputs, i.e. the last key in sort
+// order. Sorting networks only compare the keys, so their values must not be
+// replaced with padding.
+template <class Order>
+void TestSortKV128PaddingKeys(size_t num, Order order) {
+  const uint64_t last = order.IsAscending() ? ~uint64_t{0} : 0;
+  std::vector<K64V64> kv(num);
+  for (size_t i = 0; i < num; ++i) {
+    kv[i].key = (i % 3 == 0) ? static_cast<uint64_t>(i + 1) : last;
+    kv[i].value = i;
+  }
+  Sorter sorter;
+  sorter(kv.data(), num, order);
+  std::vector<uint64_t> values(num);
+  for (size_t i = 0; i < num; ++i) values[i] = kv[i].value;
+  std::sort(values.begin(), values.end());
+  for (size_t i = 0; i < num; ++i) {
+    HWY_ASSERT_EQ(static_cast<uint64_t>(i), values[i]);
+  }
+}
+
+void TestAllSortKV128() {
+  ForSorterSizes({2, 5, 13, 37, 1000}, [](size_t num) {
+    TestSortKV128PaddingKeys(num, SortAscending());
+    TestSortKV128PaddingKeys(num, SortDescending());
+  });
+}
+
+template <typename T, typename TI, class Order>
+void TestArgSort(size_t num, Order order) {
+  // Few distinct keys (including negative ones for signed/float types) so that
+  // ties are frequent, which verifies stability.
+  std::mt19937_64 rng(static_cast<uint64_t>(num));
+  std::vector<T> keys(num);
+  for (T& key : keys) {
+    key = static_cast<T>(static_cast<int64_t>(rng() % 201) - 100);
+    if (IsFloat<T>()) key = static_cast<T>(key / 4);
+  }
+  const std::vector<T> copy = keys;
+
+  std::vector<TI> expected(num);
+  for (size_t i = 0; i < num; ++i) expected[i] = static_cast<TI>(i);
+  std::stable_sort(expected.begin(), expected.end(), [&](TI a, TI b) {
+    return order.IsAscending() ? keys[a] < keys[b] : keys[b] < keys[a];
+  });
+
+  std::vector<TI> indices(num);
+  Sorter sorter;
+  sorter.ArgSort(keys.data(), num, indices.data(), order);
+  HWY_ASSERT(keys == copy);  // not modified
+  VerifyEqual(TypeName(T(), 1).c_str(), expected.data(), indices.data(), num);
+}
+
+void TestAllArgSort() {
+  ForSorterSizes([](size_t num) {
+    TestArgSort<uint16_t, uint32_t>(num, SortAscending());
+    TestArgSort<int16_t, uint64_t>(num, SortDescending());
+    TestArgSort<int32_t, uint32_t>(num, SortDescending());
+    TestArgSort<uint32_t, uint64_t>(num, SortAscending());
+    TestArgSort<int64_t, uint32_t>(num, SortAscending());
+    TestArgSort<uint64_t, uint64_t>(num, SortDescending());
+    TestArgSort<float, uint32_t>(num, SortAscending());
+    TestArgSort<double, uint64_t>(num, SortDescending());
+  });
+}
+
+template <typename T>
+T StableKey(uint64_t bits, size_t i, T* /* tag */) {
+  T key = static_cast<T>(static_cast<int64_t>(bits % 21) - 10);
+  // Mix -0 and +0, which are equal and thus must retain their order.
+  if (IsFloat<T>() && key == T(0) && (i & 1)) key = -key;
+  return key;
+}
+template <typename KV>
+KV StableKV(uint64_t bits, size_t i) {
+  KV kv;
+  kv.key = static_cast<decltype(kv.key)>(bits % 21);
+  kv.value = static_cast<decltype(kv.value)>(i);
+  return kv;
+}
+K32V32 StableKey(uint64_t bits, size_t i, K32V32* /* tag */) {
+  return StableKV<K32V32>(bits, i);
+}
+K64V64 StableKey(uint64_t bits, size_t i, K64V64* /* tag */) {
+  return StableKV<K64V64>(bits, i);
+}
+
+template <typename T, class Order>
+void TestStableSort(size_t num, Order order) {
+  std::mt19937_64 rng(static_cast<uint64_t>(num));
+  std::vector<T> keys(num);
+  for (size_t i = 0; i < num; ++i) {
+    keys[i] = StableKey(rng(), i, static_cast<T*>(nullptr));
+  }
+
+  std::vector<T> expected = keys;
+  std::stable_sort(expected.begin(), expected.end(), [&](const T& a,
+                                                         const T& b) {
+    return order.IsAscending() ? a < b : b < a;
+  });
+
+  Sorter sorter;
+  sorter.StableSort(keys.data(), num, order);
+  // Also verifies the order of -0 and +0.
+  VerifyEqual("StableSort", expected.data(), keys.data(), num);
+}
+
+void TestAllStableSort() {
+  ForSorterSizes([](size_t num) {
+    TestStableSort<uint32_t>(num, SortAscending());
+    TestStableSort<int64_t>(num, SortDescending());
+    TestStableSort<float>(num, SortAscending());
+    TestStableSort<float>(num, SortDescending());
+    TestStableSort<double>(num, SortAscending());
+    TestStableSort<double>(num, SortDescending());
+    TestStableSort<K32V32>(num, SortAscending());
+    TestStableSort<K32V32>(num, SortDescending());
+    TestStableSort<K64V64>(num, SortAscending());
+    TestStableSort<K64V64>(num, SortDescending());
+  });
+}
+
+template <typename T, class Order>
+void TestSortTotalOrder(size_t num, Order order) {
+  using TU = MakeUnsigned<T>;
+  std::mt19937_64 rng(static_cast<uint64_t>(num));
+  std::vector<T> keys(num);
+  // Special values, then mostly random bit patterns, which includes NaN with
+  // either sign and various payloads, plus a few duplicates.
+  const T specials[] = {T(0), -T(0), T(1), -T(1),
+                        std::numeric_limits<T>::infinity(),
+                        -std::numeric_limits<T>::infinity(),
+                        std::numeric_limits<T>::quiet_NaN(),
+                        -std::numeric_limits<T>::quiet_NaN(),
+                        std::numeric_limits<T>::denorm_min(),
+                        -std::numeric_limits<T>::denorm_min()};
+  for (size_t i = 0; i < num; ++i) {
+    const uint64_t r = rng();
+    if (r % 4 == 0) {
+      keys[i] = specials[(r >> 8) % (sizeof(specials) / sizeof(T))];
+    } else {
+      const TU bits = static_cast<TU>(r >> 2);
+      CopyBytes<sizeof(T)>(&bits, &keys[i]);
+    }
+  }
+
+  std::vector<T> expected = keys;
+  std::sort(expected.begin(), expected.end(), [&](T a, T b) {
+    return order.IsAscending() ? TotalOrderBits(a) < TotalOrderBits(b)
+                               : TotalOrderBits(b) < TotalOrderBits(a);
+  });
+
+  Sorter sorter;
+  sorter.SortTotalOrder(keys.data(), num, order);
+  VerifyEqual("SortTotalOrder", expected.data(), keys.data(), num);
+}
+
+void TestAllSortTotalOrder() {
+  ForSorterSizes({0, 1, 37, 1000, 300007}, [](size_t num) {
+    TestSortTotalOrder<float>(num, SortAscending());
+    TestSortTotalOrder<float>(num, SortDescending());
+    TestSortTotalOrder<double>(num, SortAscending());
+    TestSortTotalOrder<double>(num, SortDescending());
+  });
+}
+
+// Lexicographic comparison of unsigned bytes, a proper prefix first.
+bool StringLess(const std::string& a, const std::string& b) {
+  const int cmp = memcmp(a.data(), b.data(), HWY_MIN(a.size(), b.size()));
+  return cmp == 0 ? a.size() < b.size() : cmp < 0;
+}
+
+template <typename TI, class Order>
+void TestArgSortStrings(size_t num, Order order) {
+  // Few distinct bytes (including 0 and 0xFF) and long shared prefixes, so
+  // that runs of equal 8-byte prefixes, strings that differ only in trailing
+  // zeros, and duplicates are all frequent.
+  std::mt19937_64 rng(static_cast<uint64_t>(num));
+  const std::string prefixes[] = {"", "https://", "https://www.example.com/",
+                                  std::string(20, '\0')};
+  const char bytes[] = {'\0', 'a', 'b', '\x80', '\xFF'};
+  std::vector<std::string> strings(num);
+  for (std::string& s : strings) {
+    s = prefixes[rng() % 4];
+    const size_t len = static_cast<size_t>(rng() % 19);
+    for (size_t i = 0; i < len; ++i) s.push_back(bytes[rng() % 5]);
+  }
+
+  std::vector<const char*> pointers(num);
+  std::vector<size_t> lengths(num);
+  for (size_t i = 0; i < num; ++i) {
+    pointers[i] = strings[i].empty() ? nullptr : strings[i].data();
+    lengths[i] = strings[i].size();
+  }
+
+  std::vector<TI> expected(num);
+  for (size_t i = 0; i < num; ++i) expected[i] = static_cast<TI>(i);
+  std::stable_sort(expected.begin(), expected.end(), [&](TI a, TI b) {
+    return order.IsAscending() ? StringLess(strings[a], strings[b])
+                               : StringLess(strings[b], strings[a]);
+  });
+
+  std::vector<TI> indices(num);
+  Sorter sorter;
+  sorter.ArgSortStrings(pointers.data(), lengths.data(), num, indices.data(),
+                        order);
+  VerifyEqual("ArgSortStrings", expected.data(), indices.data(), num);
+}
+
+void TestAllArgSortStrings() {
+  ForSorterSizes({0, 1, 15, 37, 1000, 100003}, [](size_t num) {
+    TestArgSortStrings<uint32_t>(num, SortAscending());
+    TestArgSortStrings<uint64_t>(num, SortDescending());
+  });
+}
+
+// Payload element `i` of `size` bytes: its original index in each byte, such
+// that the gather can be verified.
+void FillPayload(size_t i, size_t size, uint8_t* bytes) {
+  for (size_t j = 0; j < size; ++j) {
+    bytes[j] = static_cast<uint8_t>((i >> (8 * (j % 4))) + j);
+  }
+}
+
+template <typename T, class Order>
+void TestSortWithPayload(size_t num, Order order) {
+  std::mt19937_64 rng(static_cast<uint64_t>(num));
+  std::vector<T> keys(num);
+  for (size_t i = 0; i < num; ++i) {
+    keys[i] = StableKey(rng(), i, static_cast<T*>(nullptr));
+  }
+
+  // Fixed and generic gather sizes.
+  const size_t sizes[3] = {4, 32, 7};
+  std::vector<uint8_t> columns[3];
+  void* payloads[3];
+  for (size_t p = 0; p < 3; ++p) {
+    columns[p].resize(num * sizes[p]);
+    for (size_t i = 0; i < num; ++i) {
+      FillPayload(i, sizes[p], columns[p].data() + i * sizes[p]);
+    }
+    payloads[p] = columns[p].data();
+  }
+
+  std::vector<uint32_t> expected(num);
+  Sorter sorter;
+  sorter.ArgSort(keys.data(), num, expected.data(), order);
+  const std::vector<T> original = keys;
+  sorter.SortWithPayload(keys.data(), num, payloads, sizes, 3, order);
+  std::vector<T> expected_keys(num);
+  for (size_t i = 0; i < num; ++i) expected_keys[i] = original[expected[i]];
+  VerifyEqual("SortWithPayload", expected_keys.data(), keys.data(), num);
+
+  std::vector<uint8_t> bytes(32);
+  for (size_t i = 0; i < num; ++i) {
+    const size_t from = expected[i];
+    for (size_t p = 0; p < 3; ++p) {
+      FillPayload(from, sizes[p], bytes.data());
+      if (memcmp(columns[p].data() + i * sizes[p], bytes.data(), sizes[p])) {
+        HWY_ABORT("SortWithPayload %d-byte keys: payload %d mismatch at %d\n",
+                  static_cast<int>(sizeof(T)), static_cast<int>(p),
+                  static_cast<int>(i));
+      }
+    }
+  }
+}
+
+void TestAllSortWithPayload() {
+  ForSorterSizes([](size_t num) {
+    TestSortWithPayload<uint32_t>(num, SortAscending());
+    TestSortWithPayload<int32_t>(num, SortDescending());
+    TestSortWithPayload<uint64_t>(num, SortDescending());
+    TestSortWithPayload<int64_t>(num, SortAscending());
+    TestSortWithPayload<float>(num, SortDescending());
+    TestSortWithPayload<double>(num, SortAscending());
+  });
+}
+
+// 32-byte record with a signed 32-bit key in the middle.
+struct Record32 {
+  uint64_t payload[2];
+  uint32_t id;
+  int32_t key;
+  uint64_t check;
+};
+struct Record32ByKey {
+  using Record = Record32;
+  using Key = int32_t;
+  static Key KeyOf(const Record& r) { return r.key; }
+};
+
+// 16-byte record with an unsigned 64-bit key at the start.
+struct Record16 {
+  uint64_t key;
+  uint32_t id;
+  uint32_t check;
+};
+struct Record16ByKey {
+  using Record = Record16;
+  using Key = uint64_t;
+  static Key KeyOf(const Record& r) { return r.key; }
+};
+
+template <class RecordTraits, class Order>
+void TestSortRecords(size_t num, Order order) {
+  using Record = typename RecordTraits::Record;
+  using Key = typename RecordTraits::Key;
+  std::mt19937_64 rng(static_cast<uint64_t>(num));
+  std::vector<Record> records(num);
+  for (size_t i = 0; i < num; ++i) {
+    memset(&records[i], 0, sizeof(Record));
+    // Few distinct keys, including negative, to verify stability.
+    records[i].key = static_cast<Key>(static_cast<int64_t>(rng() % 41) - 20);
+    records[i].id = static_cast<uint32_t>(i);
+    records[i].check = static_cast<decltype(records[i].check)>(~i);
+  }
+
+  std::vector<Record> expected = records;
+  std::stable_sort(expected.begin(), expected.end(),
+                   [&](const Record& a, const Record& b) {
+                     return order.IsAscending() ? a.key < b.key
+                                                : b.key < a.key;
+                   });
+  SortRecords<RecordTraits>(records.data(), num, order);
+  VerifyEqual("SortRecords", expected.data(), records.data(), num);
+}
+
+void TestAllSortRecords() {
+  for (size_t num : {size_t{0}, size_t{1}, size_t{37}, size_t{1000},
+                     size_t{100003}}) {
+    TestSortRecords<Record32ByKey>(num, SortAscending());
+    TestSortRecords<Record32ByKey>(num, SortDescending());
+    TestSortRecords<Record16ByKey>(num, SortAscending());
+    TestSortRecords<Record16ByKey>(num, SortDescending());
+  }
+}
+
+template <typename T>
+T ExternalKey(uint64_t bits, T* /* tag */) {
+  // Some duplicates, and negative values for signed types.
+  return static_cast<T>(static_cast<int64_t>(bits % 1000003) - 500000);
+}
+uint128_t ExternalKey(uint64_t bits, uint128_t* /* tag */) {
+  uint128_t key;
+  key.hi = bits % 7;
+  key.lo = bits >> 8;
+  return key;
+}
+
+template <typename T>
+bool ExternalLess(const T& a, const T& b) {
+  return a < b;
+}
+bool ExternalLess(const uint128_t& a, const uint128_t& b) {
+  return a.hi != b.hi ? a.hi < b.hi : a.lo < b.lo;
+}
+
+std::string ExternalPath(const ExternalSorter& sorter, const char* name) {
+  return sorter.TempDir() + "/hwy_sort_test_" + name;
+}
+
+bool WriteFile(const std::string& path, const void* bytes, size_t size) {
+  FILE* file = fopen(path.c_str(), "wb");
+  if (file == nullptr) return false;
+  const bool ok = fwrite(bytes, 1, size, file) == size;
+  return fclose(file) == 0 && ok;
+}
+
+template <typename T>
+std::vector<T> ReadFile(const std::string& path) {
+  std::vector<T> keys;
+  FILE* file = fopen(path.c_str(), "rb");
+  HWY_ASSERT(file != nullptr);
+  T key;
+  while (fread(&key, sizeof(T), 1, file) == 1) keys.push_back(key);
+  fclose(file);
+  return keys;
+}
+
+// Sorts `num` keys with the given budget, either from memory or from a file,
+// which is also the output if `in_place`, and checks the result and stats.
+template <typename T, class Order>
+void TestExternalSort(size_t num, size_t budget, bool from_file, bool in_place,
+                      Order order, size_t expected_runs,
+                      size_t expected_passes) {
+  std::mt19937_64 rng(static_cast<uint64_t>(num));
+  std::vector<T> keys(num);
+  for (size_t i = 0; i < num; ++i) {
+    keys[i] = ExternalKey(rng(), static_cast<T*>(nullptr));
+  }
+
+  ExternalSorter sorter;
+  sorter.SetMemoryBudget(budget);
+  const std::string in_path = ExternalPath(sorter, "in");
+  const std::string out_path =
+      in_place ? in_path : ExternalPath(sorter, "out");
+  ExternalSortStats stats;
+  bool ok;
+  if (from_file) {
+    HWY_ASSERT(WriteFile(in_path, keys.data(), num * sizeof(T)));
+    ok = sorter.SortFile<T>(in_path.c_str(), out_path.c_str(), order, &stats);
+  } else {
+    ok = sorter.Sort(keys.data(), num, out_path.c_str(), order, &stats);
+  }
+  HWY_ASSERT(ok);
+  const std::vector<T> actual = ReadFile<T>(out_path);
+  remove(in_path.c_str());
+  remove(out_path.c_str());
+
+  std::vector<T> expected = keys;
+  std::sort(expected.begin(), expected.end(), [&](const T& a, const T& b) {
+    return order.IsAscending() ? ExternalLess(a, b) : ExternalLess(b, a);
+  });
+  HWY_ASSERT_EQ(num, actual.size());
+  VerifyEqual("ExternalSort", expected.data(), actual.data(), num);
+  HWY_ASSERT_EQ(expected_runs, static_cast<size_t>(stats.runs));
+  HWY_ASSERT_EQ(expected_passes, static_cast<size_t>(stats.merge_passes));
+  // Runs are written once and then read and written by each pass, except for
+  // those left over after grouping, but all are read and written by the last.
+  const uint64_t bytes = num * sizeof(T);
+  const uint64_t min_passes = HWY_MIN(expected_passes, size_t{1});
+  const uint64_t in_passes = from_file ? 1 : 0;
+  HWY_ASSERT(stats.bytes_read >= bytes * (in_passes + min_passes));
+  HWY_ASSERT(stats.bytes_read <= bytes * (in_passes + expected_passes));
+  HWY_ASSERT(stats.bytes_written >= bytes * (1 + min_passes));
+  HWY_ASSERT(stats.bytes_written <= bytes * (1 + expected_passes));
+}
+
+void TestAllExternalSort() {
+  // Sorter is dynamically dispatched, hence testing one target suffices.
+  if (HWY_TARGET != HWY_STATIC_TARGET) return;
+  constexpr size_t kMiB = size_t{1} << 20;
+  // Single run, written directly.
+  TestExternalSort<double>(1000, kMiB, true, true, SortDescending(), 0, 0);
+  TestExternalSort<uint32_t>(0, kMiB, false, false, SortAscending(), 0, 0);
+  // 8 runs of 128Ki keys, merged in one pass.
+  TestExternalSort<int64_t>(1000000, kMiB, false, false, SortDescending(), 8,
+                            1);
+  // 12 runs exceed the fan-in of 8, hence two passes.
+  TestExternalSort<uint32_t>(3000007, kMiB, true, false, SortAscending(), 12,
+                             2);
+  TestExternalSort<int32_t>(3000007, kMiB, true, true, SortDescending(), 12,
+                            2);
+  // The budget is raised to the minimum: 5 runs of 4Ki keys, fan-in 2.
+  TestExternalSort<uint128_t>(20000, 1, false, false, SortAscending(), 5, 3);
+
+  // Failures: missing input, and input that ends within a key.
+  ExternalSorter sorter;
+  const std::string in_path = ExternalPath(sorter, "partial");
+  const std::string out_path = ExternalPath(sorter, "out");
+  HWY_ASSERT(!sorter.SortFile<uint64_t>(in_path.c_str(), out_path.c_str(),
+                                        SortAscending()));
+  const uint8_t bytes[12] = {};
+  HWY_ASSERT(WriteFile(in_path, bytes, sizeof(bytes)));
+  HWY_ASSERT(!sorter.SortFile<uint64_t>(in_path.c_str(), out_path.c_str(),
+                                        SortAscending()));
+  remove(in_path.c_str());
+  remove(out_path.c_str());
+}
+
 }  // namespace
 // NOLINTNEXTLINE(google-readability-namespace-comments)
 }  // namespace HWY_NAMESPACE
@@ -597,8 +2166,32 @@ HWY_BEFORE_TEST(SortTest);
 HWY_EXPORT_AND_TEST_P(SortTest, TestAllMedian);
 HWY_EXPORT_AND_TEST_P(SortTest, TestAllBaseCase);
 HWY_EXPORT_AND_TEST_P(SortTest, TestAllPartition);
+HWY_EXPORT_AND_TEST_P(SortTest, TestAllPartitionThreeWay);
 HWY_EXPORT_AND_TEST_P(SortTest, TestAllGenerator);
+HWY_EXPORT_AND_TEST_P(SortTest, TestAllWideShuffles);
 HWY_EXPORT_AND_TEST_P(SortTest, TestAllSort);
+HWY_EXPORT_AND_TEST_P(SortTest, TestAllSortParallel);
+HWY_EXPORT_AND_TEST_P(SortTest, TestAllPresorted);
+HWY_EXPORT_AND_TEST_P(SortTest, TestAllSortStats);
+HWY_EXPORT_AND_TEST_P(SortTest, TestAllSorterScratch);
+HWY_EXPORT_AND_TEST_P(SortTest, TestAllSortTuning);
+HWY_EXPORT_AND_TEST_P(SortTest, TestAllRadixSort);
+HWY_EXPORT_AND_TEST_P(SortTest, TestAllSampleSort);
+HWY_EXPORT_AND_TEST_P(SortTest, TestAllPartialSort);
+HWY_EXPORT_AND_TEST_P(SortTest, TestAllSelect);
+HWY_EXPORT_AND_TEST_P(SortTest, TestAllMerge);
+HWY_EXPORT_AND_TEST_P(SortTest, TestAllSortSegments);
+HWY_EXPORT_AND_TEST_P(SortTest, TestAllSort8);
+HWY_EXPORT_AND_TEST_P(SortTest, TestAllSortFloat16);
+HWY_EXPORT_AND_TEST_P(SortTest, TestAllSortKV64);
+HWY_EXPORT_AND_TEST_P(SortTest, TestAllSortKV128);
+HWY_EXPORT_AND_TEST_P(SortTest, TestAllArgSort);
+HWY_EXPORT_AND_TEST_P(SortTest, TestAllStableSort);
+HWY_EXPORT_AND_TEST_P(SortTest, TestAllSortTotalOrder);
+HWY_EXPORT_AND_TEST_P(SortTest, TestAllArgSortStrings);
+HWY_EXPORT_AND_TEST_P(SortTest, TestAllSortWithPayload);
+HWY_EXPORT_AND_TEST_P(SortTest, TestAllSortRecords);
+HWY_EXPORT_AND_TEST_P(SortTest, TestAllExternalSort);
 }  // namespace
 }  // namespace hwy
 
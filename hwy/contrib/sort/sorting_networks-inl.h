@@ -59,6 +59,16 @@ struct SharedTraits : public Base {
     return base->OddEvenQuads(d, swapped, v);
   }
 
+  // Conditionally swaps the lower half of the vector with the upper half, i.e.
+  // lane 0 with N/2 etc. Used by MergeVectors.
+  template <class D>
+  HWY_INLINE Vec<D> SortPairsHalves(D d, Vec<D> v) const {
+    const Base* base = static_cast<const Base*>(this);
+    Vec<D> swapped = ConcatLowerUpper(d, v, v);
+    base->Sort2(d, v, swapped);
+    return ConcatUpperLower(d, swapped, v);
+  }
+
   // Swaps with the vector formed by reversing contiguous groups of 8 keys.
   template <class D>
   HWY_INLINE Vec<D> SortPairsReverse16(D d, Vec<D> v) const {
@@ -73,6 +73,12 @@ struct KeyLane {
     return Set(d, *key);
   }
 
+  // Used to detect all-equal partitions.
+  template <class D>
+  HWY_INLINE Mask<D> EqualKeys(D /* tag */, Vec<D> a, Vec<D> b) const {
+    return Eq(a, b);
+  }
+
   template <class D>
   HWY_INLINE Vec<D> ReverseKeys(D d, Vec<D> v) const {
     return Reverse(d, v);
@@ -129,7 +135,8 @@ struct KeyLane {
   }
   template <class D, HWY_IF_LANE_SIZE_D(D, 8)>
   HWY_INLINE Vec<D> SwapAdjacentQuads(D d, const Vec<D> v) const {
-    // Assumes max vector size = 512
+    // Swapping halves only suffices for (at most) 512-bit vectors.
+    if (MaxLanes(d) > 8) return XorLanes<4>(d, v);
     return ConcatLowerUpper(d, v, v);
   }
 
@@ -159,6 +166,8 @@ struct KeyLane {
   }
   template <class D, HWY_IF_LANE_SIZE_D(D, 8)>
   HWY_INLINE Vec<D> OddEvenQuads(D d, Vec<D> odd, Vec<D> even) const {
+    // See SwapAdjacentQuads.
+    if (MaxLanes(d) > 8) return IfThenElse(LanesWithBit<4>(d), odd, even);
     return ConcatUpperLower(d, odd, even);
   }
 };
@@ -183,6 +192,12 @@ struct OrderAscending : public KeyLane<T> {
     return Lt(a, b);
   }
 
+  // Used by Sort2 and SortPairsDistance1
+  template <class V>
+  HWY_INLINE Mask<DFromV<V>> CompareLanes(V a, V b) const {
+    return Lt(a, b);
+  }
+
   // Two halves of Sort2, used in ScanMinMax.
   template <class D>
   HWY_INLINE Vec<D> First(D /* tag */, const Vec<D> a, const Vec<D> b) const {
@@ -230,6 +245,12 @@ struct OrderDescending : public KeyLane<T> {
     return Lt(b, a);
   }
 
+  // Used by Sort2 and SortPairsDistance1
+  template <class V>
+  HWY_INLINE Mask<DFromV<V>> CompareLanes(V a, V b) const {
+    return Lt(b, a);
+  }
+
   template <class D>
   HWY_INLINE Vec<D> First(D /* tag */, const Vec<D> a, const Vec<D> b) const {
     return Max(a, b);
@@ -263,6 +284,126 @@ struct OrderDescending : public KeyLane<T> {
   }
 };
 
+// Base class shared between OrderAscendingKV64, OrderDescendingKV64. The key
+// is the upper half of each u64 lane, and the value the lower half.
+struct KeyValue64 : public KeyLane<uint64_t> {
+  // What type to pass to Sorter::operator().
+  using KeyType = K32V32;
+
+  std::string KeyString() const { return "KV64"; }
+
+  template <class D>
+  HWY_INLINE Mask<D> EqualKeys(D /* tag */, Vec<D> a, Vec<D> b) const {
+    return Eq(ShiftRight<32>(a), ShiftRight<32>(b));
+  }
+};
+
+// Partition and HeapSort only compare keys. Sorting networks, pivot selection
+// and min/max also compare values, which is cheaper and still consistent with
+// the key order because the key occupies the upper bits; the sort is not
+// stable anyway.
+struct OrderAscendingKV64 : public KeyValue64 {
+  using Order = SortAscending;
+
+  HWY_INLINE bool Compare1(const LaneType* a, const LaneType* b) {
+    return (*a >> 32) < (*b >> 32);
+  }
+
+  template <class D>
+  HWY_INLINE Mask<D> Compare(D /* tag */, Vec<D> a, Vec<D> b) const {
+    return Lt(ShiftRight<32>(a), ShiftRight<32>(b));
+  }
+
+  // Used by Sort2 and SortPairsDistance1
+  template <class V>
+  HWY_INLINE Mask<DFromV<V>> CompareLanes(V a, V b) const {
+    return Lt(a, b);
+  }
+
+  template <class D>
+  HWY_INLINE Vec<D> First(D /* tag */, const Vec<D> a, const Vec<D> b) const {
+    return Min(a, b);
+  }
+
+  template <class D>
+  HWY_INLINE Vec<D> Last(D /* tag */, const Vec<D> a, const Vec<D> b) const {
+    return Max(a, b);
+  }
+
+  template <class D>
+  HWY_INLINE Vec<D> FirstOfLanes(D d, Vec<D> v,
+                                 LaneType* HWY_RESTRICT /* buf */) const {
+    return MinOfLanes(d, v);
+  }
+
+  template <class D>
+  HWY_INLINE Vec<D> LastOfLanes(D d, Vec<D> v,
+                                LaneType* HWY_RESTRICT /* buf */) const {
+    return MaxOfLanes(d, v);
+  }
+
+  template <class D>
+  HWY_INLINE Vec<D> FirstValue(D d) const {
+    return Set(d, hwy::LowestValue<LaneType>());
+  }
+
+  template <class D>
+  HWY_INLINE Vec<D> LastValue(D d) const {
+    return Set(d, hwy::HighestValue<LaneType>());
+  }
+};
+
+struct OrderDescendingKV64 : public KeyValue64 {
+  using Order = SortDescending;
+
+  HWY_INLINE bool Compare1(const LaneType* a, const LaneType* b) {
+    return (*b >> 32) < (*a >> 32);
+  }
+
+  template <class D>
+  HWY_INLINE Mask<D> Compare(D /* tag */, Vec<D> a, Vec<D> b) const {
+    return Lt(ShiftRight<32>(b), ShiftRight<32>(a));
+  }
+
+  // Used by Sort2 and SortPairsDistance1
+  template <class V>
+  HWY_INLINE Mask<DFromV<V>> CompareLanes(V a, V b) const {
+    return Lt(b, a);
+  }
+
+  template <class D>
+  HWY_INLINE Vec<D> First(D /* tag */, const Vec<D> a, const Vec<D> b) const {
+    return Max(a, b);
+  }
+
+  template <class D>
+  HWY_INLINE Vec<D> Last(D /* tag */, const Vec<D> a, const Vec<D> b) const {
+    return Min(a, b);
+  }
+
+  template <class D>
+  HWY_INLINE Vec<D> FirstOfLanes(D d, Vec<D> v,
+                                 LaneType* HWY_RESTRICT /* buf */) const {
+    return MaxOfLanes(d, v);
+  }
+
+  template <class D>
+  HWY_INLINE Vec<D> LastOfLanes(D d, Vec<D> v,
+                                LaneType* HWY_RESTRICT /* buf */) const {
+    return MinOfLanes(d, v);
+  }
+
+  template <class D>
+  HWY_INLINE Vec<D> FirstValue(D d) const {
+    return Set(d, hwy::HighestValue<LaneType>());
+  }
+
+  template <class D>
+  HWY_INLINE Vec<D> LastValue(D d) const {
+    return Set(d, hwy::LowestValue<LaneType>());
+  }
+};
+
 // Shared code that depends on Order.
 template <class Base>
 struct TraitsLane : public Base {
@@ -279,7 +420,7 @@ struct TraitsLane : public Base {
     // instructions. We can reduce it to a compare + 2 IfThenElse.
 #if HWY_AVX3 < HWY_TARGET && HWY_TARGET <= HWY_SSSE3
     if (sizeof(TFromD<D>) == 8) {
-      const Mask<D> cmp = base->Compare(d, a, b);
+      const Mask<D> cmp = base->CompareLanes(a, b);
       a = IfThenElse(cmp, a, b);
       b = IfThenElse(cmp, b, a_copy);
       return;
@@ -297,7 +438,7 @@ struct TraitsLane : public Base {
     // Further to the above optimization, Sort2+OddEvenKeys compile to four
     // instructions; we can save one by combining two blends.
 #if HWY_AVX3 < HWY_TARGET && HWY_TARGET <= HWY_SSSE3
-    const Vec<D> cmp = VecFromMask(d, base->Compare(d, v, swapped));
+    const Vec<D> cmp = VecFromMask(d, base->CompareLanes(v, swapped));
     return IfVecThenElse(DupOdd(cmp), swapped, v);
 #else
     Sort2(d, v, swapped);
@@ -377,6 +518,39 @@ struct OrderDescending : public KeyLane<T> {
   }
 };
 
+// Base class shared between OrderAscendingKV64, OrderDescendingKV64.
+struct KeyValue64 : public KeyLane<uint64_t> {
+  using KeyType = K32V32;
+
+  std::string KeyString() const { return "KV64"; }
+};
+
+struct OrderAscendingKV64 : public KeyValue64 {
+  using Order = SortAscending;
+
+  HWY_INLINE bool Compare1(const LaneType* a, const LaneType* b) {
+    return (*a >> 32) < (*b >> 32);
+  }
+
+  template <class D>
+  HWY_INLINE Mask<D> Compare(D /* tag */, Vec<D> a, Vec<D> b) {
+    return Lt(ShiftRight<32>(a), ShiftRight<32>(b));
+  }
+};
+
+struct OrderDescendingKV64 : public KeyValue64 {
+  using Order = SortDescending;
+
+  HWY_INLINE bool Compare1(const LaneType* a, const LaneType* b) {
+    return (*b >> 32) < (*a >> 32);
+  }
+
+  template <class D>
+  HWY_INLINE Mask<D> Compare(D /* tag */, Vec<D> a, Vec<D> b) {
+    return Lt(ShiftRight<32>(b), ShiftRight<32>(a));
+  }
+};
+
 template <class Order>
 struct TraitsLane : public Order {
   // For HeapSort
@@ -63,6 +63,12 @@ struct KeyAny128 {
     return LoadDup128(d, key);
   }
 
+  // Used to detect all-equal partitions.
+  template <class D>
+  HWY_INLINE Mask<D> EqualKeys(D /* tag */, Vec<D> a, Vec<D> b) const {
+    return Eq(a, b);
+  }
+
   template <class D>
   HWY_INLINE Vec<D> ReverseKeys(D d, Vec<D> v) const {
     return ReverseBlocks(d, v);
@@ -73,18 +79,18 @@ struct KeyAny128 {
     return SwapAdjacentBlocks(v);
   }
 
-  // Only called for 4 keys because we do not support >512-bit vectors.
+  // Keys occupy two lanes, hence the lane indices below are twice the key
+  // indices. For at most 512-bit vectors, there are at most four keys.
   template <class D>
   HWY_INLINE Vec<D> ReverseKeys4(D d, const Vec<D> v) const {
-    HWY_DASSERT(Lanes(d) <= 64 / sizeof(TFromD<D>));
+    if (MaxLanes(d) > 8) return XorLanes<6>(d, v);
     return ReverseKeys(d, v);
   }
 
-  // Only called for 4 keys because we do not support >512-bit vectors.
   template <class D>
   HWY_INLINE Vec<D> OddEvenPairs(D d, const Vec<D> odd,
                                  const Vec<D> even) const {
-    HWY_DASSERT(Lanes(d) <= 64 / sizeof(TFromD<D>));
+    if (MaxLanes(d) > 8) return IfThenElse(LanesWithBit<4>(d), odd, even);
     return ConcatUpperLower(d, odd, even);
   }
 
@@ -93,31 +99,33 @@ struct KeyAny128 {
     return OddEvenBlocks(odd, even);
   }
 
+  // Only called for 8 col networks, which require 1024-bit vectors.
   template <class D>
-  HWY_INLINE Vec<D> ReverseKeys8(D, Vec<D>) const {
-    HWY_ASSERT(0);  // not supported: would require 1024-bit vectors
+  HWY_INLINE Vec<D> ReverseKeys8(D d, Vec<D> v) const {
+    return XorLanes<14>(d, v);
   }
 
+  // Only called for 8 col networks, which require 1024-bit vectors.
   template <class D>
-  HWY_INLINE Vec<D> ReverseKeys16(D, Vec<D>) const {
-    HWY_ASSERT(0);  // not supported: would require 2048-bit vectors
+  HWY_INLINE Vec<D> SwapAdjacentPairs(D d, Vec<D> v) const {
+    return XorLanes<4>(d, v);
   }
 
-  // This is only called for 8/16 col networks (not supported).
+  // Only called for 8 col networks, which require 1024-bit vectors.
   template <class D>
-  HWY_INLINE Vec<D> SwapAdjacentPairs(D, Vec<D>) const {
-    HWY_ASSERT(0);
+  HWY_INLINE Vec<D> OddEvenQuads(D d, Vec<D> odd, Vec<D> even) const {
+    return IfThenElse(LanesWithBit<8>(d), odd, even);
   }
 
-  // This is only called for 16 col networks (not supported).
+  // Networks have at most Constants::kMaxCols = 16 lanes, i.e. 8 keys, so the
+  // following are only called for 16 col networks (not supported).
   template <class D>
-  HWY_INLINE Vec<D> SwapAdjacentQuads(D, Vec<D>) const {
+  HWY_INLINE Vec<D> ReverseKeys16(D, Vec<D>) const {
     HWY_ASSERT(0);
   }
 
-  // This is only called for 8 col networks (not supported).
   template <class D>
-  HWY_INLINE Vec<D> OddEvenQuads(D, Vec<D>, Vec<D>) const {
+  HWY_INLINE Vec<D> SwapAdjacentQuads(D, Vec<D>) const {
     HWY_ASSERT(0);
   }
 };
@@ -416,7 +424,7 @@ class Traits128 : public Base {
   // Conditionally swaps lane 0 with 4, 1 with 5 etc.
   template <class D>
   HWY_INLINE Vec<D> SortPairsDistance4(D, Vec<D>) const {
-    // Only used by Merge16, which would require 2048 bit vectors (unsupported).
+    // Only used by Merge16, which would require 16 keys (unsupported).
     HWY_ASSERT(0);
   }
 };
@@ -29,8 +29,13 @@
 
 #include <string.h>  // memcpy
 
+#include <algorithm>  // std::sort
+#include <atomic>
+#include <vector>
 
+#include "hwy/aligned_allocator.h"
 #include "hwy/cache_control.h"        // Prefetch
+#include "hwy/contrib/sort/thread_pool.h"
 #include "hwy/contrib/sort/vqsort.h"  // Fill24Bytes
 
 #if HWY_IS_MSAN
@@ -48,6 +53,9 @@
 #define HIGHWAY_HWY_CONTRIB_SORT_VQSORT_TOGGLE
 #endif
 
+#include "hwy/contrib/algo/copy-inl.h"  // Fill
+#include "hwy/contrib/sort/radix-inl.h"
+#include "hwy/contrib/sort/samplesort-inl.h"
 #include "hwy/contrib/sort/shared-inl.h"
 #include "hwy/contrib/sort/sorting_networks-inl.h"
 #include "hwy/highway.h"
@@ -56,17 +64,53 @@ HWY_BEFORE_NAMESPACE();
 namespace hwy {
 namespace HWY_NAMESPACE {
 namespace detail {
-  
-// added by Arif for distributions
-#define DIST_N 1025
-static uint64_t dist[DIST_N];
-static uint64_t count_at_depth[DIST_N];
-static int max_depth = -1;
-static int depth = 0;
-static uint64_t heap_sort = 0;
 
 using Constants = hwy::SortConstants;
 
+// ------------------------------ Stats
+
+// Default for Sort: discards all statistics, hence compiles to nothing.
+struct NoStats {
+  void Enter() {}
+  void Leave() {}
+  void Partition(size_t /*num_keys*/) {}
+  void Degenerate() {}
+  void ThreeWay() {}
+  void HeapSortFallback() {}
+  void BaseCase() {}
+  void RadixSort() {}
+  void SampleSort() {}
+};
+
+// Adds to a caller-provided SortStats. Enter/Leave bracket each recursive call
+// so that we know the current depth.
+class StatsRecorder {
+ public:
+  explicit StatsRecorder(SortStats& stats) : stats_(stats) {}
+
+  void Enter() {
+    ++depth_;
+    stats_.max_depth = HWY_MAX(stats_.max_depth, depth_);
+  }
+  void Leave() { --depth_; }
+
+  void Partition(size_t num_keys) {
+    const size_t i = HWY_MIN(depth_, SortStats::kMaxDepth - 1);
+    stats_.partitions[i] += 1;
+    stats_.keys_at_depth[i] += num_keys;
+  }
+  void Degenerate() { stats_.degenerate += 1; }
+  void ThreeWay() { stats_.three_way += 1; }
+  void HeapSortFallback() { stats_.heap_sorts += 1; }
+  void BaseCase() { stats_.base_cases += 1; }
+  void RadixSort() { stats_.radix_sorts += 1; }
+  void SampleSort() { stats_.sample_sorts += 1; }
+
+ private:
+  SortStats& stats_;
+  size_t depth_ = 0;
+};
+
 // ------------------------------ HeapSort
 
 template <class Traits, typename T>
@@ -117,10 +161,101 @@ void HeapSort(Traits st, T* HWY_RESTRICT lanes, const size_t num_lanes) {
   }
 }
 
+// ------------------------------ CountingSort
+
+// Returns the histogram bin of an 8-bit key, such that bins are in ascending
+// order of the keys.
+HWY_INLINE size_t Bin8(uint8_t key) { return key; }
+HWY_INLINE size_t Bin8(int8_t key) {
+  return static_cast<uint8_t>(key) ^ 0x80u;
+}
+
+// Sorts 8-bit keys by counting the occurrences of each of the 256 possible
+// values and then writing each value that many times. O(num + 256) time and
+// no comparisons. Four histograms avoid serializing increments of the same
+// counter, which is likely because there are so few distinct keys.
+template <typename T, class Order>
+HWY_NOINLINE void CountingSort8(T* HWY_RESTRICT keys, size_t num,
+                                Order order) {
+  static_assert(sizeof(T) == 1, "Only for 8-bit keys");
+  size_t counts[4][256] = {};
+  size_t i = 0;
+  for (; i + 4 <= num; i += 4) {
+    ++counts[0][Bin8(keys[i + 0])];
+    ++counts[1][Bin8(keys[i + 1])];
+    ++counts[2][Bin8(keys[i + 2])];
+    ++counts[3][Bin8(keys[i + 3])];
+  }
+  for (; i < num; ++i) {
+    ++counts[0][Bin8(keys[i])];
+  }
+
+  const ScalableTag<T> d;
+  size_t pos = 0;
+  for (size_t b = 0; b < 256; ++b) {
+    const size_t bin = order.IsAscending() ? b : 255 - b;
+    const size_t count =
+        counts[0][bin] + counts[1][bin] + counts[2][bin] + counts[3][bin];
+    // Inverse of Bin8.
+    const T key = static_cast<T>(IsSigned<T>() ? bin ^ 0x80u : bin);
+    Fill(d, key, count, keys + pos);
+    pos += count;
+  }
+  HWY_DASSERT(pos == num);
+}
+
+// ------------------------------ MergeScalar
+
+// Writes the merge of the sorted lanes a[0, na) and b[0, nb) to `out`, which
+// must not overlap them. Takes from `a` unless the key in `b` is strictly
+// first, hence equal keys from `a` precede those from `b`.
+template <class Traits, typename T>
+void MergeScalar(Traits st, const T* HWY_RESTRICT a, size_t na,
+                 const T* HWY_RESTRICT b, size_t nb, T* HWY_RESTRICT out) {
+  constexpr size_t N1 = st.LanesPerKey();
+  while (na != 0 && nb != 0) {
+    const bool take_b = st.Compare1(b, a);
+    const T* HWY_RESTRICT from = take_b ? b : a;
+    for (size_t i = 0; i < N1; ++i) {
+      out[i] = from[i];
+    }
+    out += N1;
+    if (take_b) {
+      b += N1;
+      nb -= N1;
+    } else {
+      a += N1;
+      na -= N1;
+    }
+  }
+  memcpy(out, a, na * sizeof(T));
+  memcpy(out + na, b, nb * sizeof(T));
+}
+
 #if VQSORT_ENABLED || HWY_IDE
 
 // ------------------------------ BaseCase
 
+// Sorting networks for K64V64 only compare keys, hence they may order padding
+// (see BaseCase) before keys equal to it. Swaps any such keys from
+// buf[num, num_padded) with padding from buf[0, num). Keys bitwise equal to the
+// padding are indistinguishable from it and need not be restored.
+template <typename T>
+HWY_INLINE void RestoreKeysAfterPadding(T* HWY_RESTRICT buf, size_t num,
+                                        size_t num_padded, T padding) {
+  size_t pos_padding = num;
+  for (size_t i = num; i < num_padded; i += 2) {
+    if (buf[i] == padding && buf[i + 1] == padding) continue;
+    do {
+      HWY_DASSERT(pos_padding != 0);
+      pos_padding -= 2;
+    } while (buf[pos_padding] != padding || buf[pos_padding + 1] != padding);
+    buf[pos_padding] = buf[i];
+    buf[pos_padding + 1] = buf[i + 1];
+    buf[i] = buf[i + 1] = padding;
+  }
+}
+
 // Sorts `keys` within the range [0, num) via sorting network.
 template <class D, class Traits, typename T>
 HWY_NOINLINE void BaseCase(D d, Traits st, T* HWY_RESTRICT keys,
@@ -171,6 +306,10 @@ HWY_NOINLINE void BaseCase(D d, Traits st, T* HWY_RESTRICT keys,
   }
 
   SortingNetwork(st, buf, cols);
+  if (IsSame<typename Traits::KeyType, K64V64>()) {
+    RestoreKeysAfterPadding(buf, num, cols * Constants::kMaxRows,
+                            GetLane(kPadding));
+  }
 
   for (i = 0; i + N <= num; i += N) {
     StoreU(Load(d, buf + i), d, keys + i);
@@ -182,13 +321,12 @@ HWY_NOINLINE void BaseCase(D d, Traits st, T* HWY_RESTRICT keys,
 
 // Consumes from `left` until a multiple of kUnroll*N remains.
 // Temporarily stores the right side into `buf`, then moves behind `right`.
-template <class D, class Traits, class T>
+template <size_t kUnroll, class D, class Traits, class T>
 HWY_NOINLINE void PartitionToMultipleOfUnroll(D d, Traits st,
                                               T* HWY_RESTRICT keys,
                                               size_t& left, size_t& right,
                                               const Vec<D> pivot,
                                               T* HWY_RESTRICT buf) {
-  constexpr size_t kUnroll = Constants::kPartitionUnroll;
   const size_t N = Lanes(d);
   size_t readL = left;
   size_t bufR = 0;
@@ -266,26 +404,175 @@ HWY_INLINE void StoreLeftRight(D d, Traits st, const Vec<D> v,
   }
 }
 
-template <class D, class Traits, typename T>
-HWY_INLINE void StoreLeftRight4(D d, Traits st, const Vec<D> v0,
-                                const Vec<D> v1, const Vec<D> v2,
-                                const Vec<D> v3, const Vec<D> pivot,
-                                T* HWY_RESTRICT keys, size_t& writeL,
-                                size_t& remaining) {
-  StoreLeftRight(d, st, v0, pivot, keys, writeL, remaining);
-  StoreLeftRight(d, st, v1, pivot, keys, writeL, remaining);
-  StoreLeftRight(d, st, v2, pivot, keys, writeL, remaining);
-  StoreLeftRight(d, st, v3, pivot, keys, writeL, remaining);
+// Writes the partitioned keys directly to their destination in `keys`.
+struct DirectWriter {
+  template <class D, class Traits, typename T>
+  HWY_INLINE void Store(D d, Traits st, const Vec<D> v, const Vec<D> pivot,
+                        T* HWY_RESTRICT keys, size_t& writeL,
+                        size_t& remaining) {
+    StoreLeftRight(d, st, v, pivot, keys, writeL, remaining);
+  }
+
+  template <typename T>
+  HWY_INLINE void Finish(T* HWY_RESTRICT /* keys */, size_t /* writeL */,
+                         size_t /* remaining */) {}
+};
+
+#if VQSORT_BLOCK_PARTITION || VQSORT_STREAM_PARTITION
+
+// Instead stages the keys of each side in `buf`, like the local buffers of
+// BlockQuicksort and IPS4o, and writes them in whole aligned chunks (see
+// LanesPerChunk, typically a cache line) once kPartitionBlockChunks are full.
+// This avoids the partial and misaligned writes of CompressBlendedStore, which
+// may only write a few bytes for 16-bit keys. If kStream, the chunks are
+// written via Stream. Such non-temporal stores neither read the destination
+// line for ownership nor evict other data, which helps if the input is much
+// larger than the caches.
+//
+// As with DirectWriter, the left side is written below writeL and the right
+// side above writeR = writeL + remaining, but numL_ or numR_ keys of each are
+// still in `buf`. Thus the partition loop sees the same capacities. Keys within
+// a side may be written in any order, hence the staged keys are a stack.
+// Requires IsKeyAligned.
+template <class D, typename T, bool kStream>
+class BlockWriter {
+ public:
+  BlockWriter(D d, T* HWY_RESTRICT buf)
+      : lanes_per_chunk_(Constants::LanesPerChunk(sizeof(T), Lanes(d))),
+        lanes_per_block_(Constants::kPartitionBlockChunks * lanes_per_chunk_),
+        bufL_(buf),
+        topR_(buf + Constants::BlockBufNum(sizeof(T), Lanes(d))) {}
+
+  template <class Traits>
+  HWY_INLINE void Store(D d, Traits st, const Vec<D> v, const Vec<D> pivot,
+                        T* HWY_RESTRICT keys, size_t& writeL,
+                        size_t& remaining) {
+    const size_t N = Lanes(d);
+    const auto comp = st.Compare(d, pivot, v);
+    remaining -= N;
+    size_t num_left;
+    // Left keys are appended to bufL_, right keys prepended to topR_.
+    if (hwy::HWY_NAMESPACE::CompressIsPartition<T>::value ||
+        (HWY_MAX_BYTES == 16 && st.Is128())) {
+      // See StoreLeftRight. Left keys stored below the right ones are ignored.
+      const auto lr = st.CompressKeys(v, comp);
+      num_left = N - CountTrue(d, comp);
+      StoreU(lr, d, bufL_ + numL_);
+      StoreU(lr, d, topR_ - numR_ - N);
+    } else {
+      num_left = CompressStore(v, Not(comp), d, bufL_ + numL_);
+      (void)CompressBlendedStore(v, comp, d, topR_ - numR_ - (N - num_left));
+    }
+    writeL += num_left;
+    numL_ += num_left;
+    numR_ += N - num_left;
+
+    if (numL_ >= lanes_per_block_) FlushLeft(d, keys + writeL);
+    if (numR_ >= lanes_per_block_) FlushRight(d, keys + writeL + remaining);
+  }
+
+  // Writes the remaining staged keys. Must be called before reading `keys`.
+  HWY_INLINE void Finish(T* HWY_RESTRICT keys, size_t writeL,
+                         size_t remaining) {
+    // MSAN seems not to understand CompressStore.
+#if HWY_IS_MSAN
+    __msan_unpoison(bufL_, numL_ * sizeof(T));
+    __msan_unpoison(topR_ - numR_, numR_ * sizeof(T));
+#endif
+    memcpy(keys + writeL - numL_, bufL_, numL_ * sizeof(T));
+    memcpy(keys + writeL + remaining, topR_ - numR_, numR_ * sizeof(T));
+    numL_ = 0;
+    numR_ = 0;
+    if (kStream) FlushStream();
+  }
+
+ private:
+  // Moves staged left keys into the space below `writeL`, in whole chunks
+  // except for the first, until less than a chunk remains.
+  HWY_INLINE void FlushLeft(D d, T* HWY_RESTRICT writeL) {
+    for (;;) {
+      T* HWY_RESTRICT to = writeL - numL_;
+      const size_t num = lanes_per_chunk_ - Misalignment(to);
+      if (numL_ < num) return;
+      numL_ -= num;
+      WriteChunk(d, bufL_ + numL_, to, num);
+    }
+  }
+
+  // Moves staged right keys into the space above `writeR`, likewise.
+  HWY_INLINE void FlushRight(D d, T* HWY_RESTRICT writeR) {
+    for (;;) {
+      T* HWY_RESTRICT end = writeR + numR_;
+      const size_t misalignment = Misalignment(end);
+      const size_t num = misalignment == 0 ? lanes_per_chunk_ : misalignment;
+      if (numR_ < num) return;
+      WriteChunk(d, topR_ - numR_, end - num, num);
+      numR_ -= num;
+    }
+  }
+
+  // Returns the number of lanes between the previous chunk boundary and `p`.
+  HWY_INLINE size_t Misalignment(const T* p) const {
+    return (reinterpret_cast<uintptr_t>(p) / sizeof(T)) &
+           (lanes_per_chunk_ - 1);
+  }
+
+  // Only the first, misaligned part of each side is copied via memcpy.
+  HWY_INLINE void WriteChunk(D d, const T* HWY_RESTRICT from,
+                             T* HWY_RESTRICT to, size_t num) const {
+#if HWY_IS_MSAN
+    __msan_unpoison(from, num * sizeof(T));
+#endif
+    if (num != lanes_per_chunk_) {
+      memcpy(to, from, num * sizeof(T));
+      return;
+    }
+    const size_t N = Lanes(d);
+    for (size_t i = 0; i < num; i += N) {
+      if (kStream) {
+        Stream(LoadU(d, from + i), d, to + i);
+      } else {
+        hwy::HWY_NAMESPACE::Store(LoadU(d, from + i), d, to + i);
+      }
+    }
+  }
+
+  const size_t lanes_per_chunk_;
+  const size_t lanes_per_block_;
+  T* HWY_RESTRICT bufL_;
+  T* HWY_RESTRICT topR_;
+  size_t numL_ = 0;
+  size_t numR_ = 0;
+};
+
+#endif  // VQSORT_BLOCK_PARTITION || VQSORT_STREAM_PARTITION
+
+// Partitions v0, v1 and, if kUnroll == 4, also v2 and v3.
+template <size_t kUnroll, class D, class Traits, typename T, class Writer>
+HWY_INLINE void StoreLeftRightUnrolled(D d, Traits st, const Vec<D> v0,
+                                       const Vec<D> v1, const Vec<D> v2,
+                                       const Vec<D> v3, const Vec<D> pivot,
+                                       T* HWY_RESTRICT keys, size_t& writeL,
+                                       size_t& remaining, Writer& writer) {
+  static_assert(kUnroll == 2 || kUnroll == 4, "Unsupported unroll factor");
+  writer.Store(d, st, v0, pivot, keys, writeL, remaining);
+  writer.Store(d, st, v1, pivot, keys, writeL, remaining);
+  if (kUnroll == 4) {
+    writer.Store(d, st, v2, pivot, keys, writeL, remaining);
+    writer.Store(d, st, v3, pivot, keys, writeL, remaining);
+  }
 }
 
 // Moves "<= pivot" keys to the front, and others to the back. pivot is
 // broadcasted. Time-critical!
 //
 // Aligned loads do not seem to be worthwhile (not bottlenecked by load ports).
-template <class D, class Traits, typename T>
-HWY_NOINLINE size_t Partition(D d, Traits st, T* HWY_RESTRICT keys, size_t left,
-                              size_t right, const Vec<D> pivot,
-                              T* HWY_RESTRICT buf) {
+// `writer` is DirectWriter or BlockWriter.
+template <size_t kUnroll, class D, class Traits, typename T, class Writer>
+HWY_NOINLINE size_t PartitionUnrolled(D d, Traits st, T* HWY_RESTRICT keys,
+                                      size_t left, size_t right,
+                                      const Vec<D> pivot, T* HWY_RESTRICT buf,
+                                      Writer writer) {
   using V = decltype(Zero(d));
   const size_t N = Lanes(d);
 
@@ -297,8 +584,7 @@ HWY_NOINLINE size_t Partition(D d, Traits st, T* HWY_RESTRICT keys, size_t left,
   const size_t last = right;
   const V vlast = LoadU(d, keys + last);
 
-  PartitionToMultipleOfUnroll(d, st, keys, left, right, pivot, buf);
-  constexpr size_t kUnroll = Constants::kPartitionUnroll;
+  PartitionToMultipleOfUnroll<kUnroll>(d, st, keys, left, right, pivot, buf);
 
   // Partition splits the vector into 3 sections, left to right: Elements
   // smaller or equal to the pivot, unpartitioned elements and elements larger 
@@ -341,16 +627,17 @@ HWY_NOINLINE size_t Partition(D d, Traits st, T* HWY_RESTRICT keys, size_t left,
     HWY_DASSERT((num & (kUnroll * N - 1)) == 0);
 
     // Make space for writing in-place by reading from left and right.
+    // If kUnroll == 2, v2 and v3 are unused copies.
     const V vL0 = LoadU(d, keys + left + 0 * N);
     const V vL1 = LoadU(d, keys + left + 1 * N);
-    const V vL2 = LoadU(d, keys + left + 2 * N);
-    const V vL3 = LoadU(d, keys + left + 3 * N);
+    const V vL2 = LoadU(d, keys + left + (kUnroll - 2) * N);
+    const V vL3 = LoadU(d, keys + left + (kUnroll - 1) * N);
     left += kUnroll * N;
     right -= kUnroll * N;
     const V vR0 = LoadU(d, keys + right + 0 * N);
     const V vR1 = LoadU(d, keys + right + 1 * N);
-    const V vR2 = LoadU(d, keys + right + 2 * N);
-    const V vR3 = LoadU(d, keys + right + 3 * N);
+    const V vR2 = LoadU(d, keys + right + (kUnroll - 2) * N);
+    const V vR3 = LoadU(d, keys + right + (kUnroll - 1) * N);
 
     // The left/right updates may consume all inputs, so check before the loop.
     while (left != right) {
@@ -386,24 +673,28 @@ HWY_NOINLINE size_t Partition(D d, Traits st, T* HWY_RESTRICT keys, size_t left,
         right -= kUnroll * N;
         v0 = LoadU(d, keys + right + 0 * N);
         v1 = LoadU(d, keys + right + 1 * N);
-        v2 = LoadU(d, keys + right + 2 * N);
-        v3 = LoadU(d, keys + right + 3 * N);
+        v2 = LoadU(d, keys + right + (kUnroll - 2) * N);
+        v3 = LoadU(d, keys + right + (kUnroll - 1) * N);
         hwy::Prefetch(keys + right - 3 * kUnroll * N);
       } else {
         v0 = LoadU(d, keys + left + 0 * N);
         v1 = LoadU(d, keys + left + 1 * N);
-        v2 = LoadU(d, keys + left + 2 * N);
-        v3 = LoadU(d, keys + left + 3 * N);
+        v2 = LoadU(d, keys + left + (kUnroll - 2) * N);
+        v3 = LoadU(d, keys + left + (kUnroll - 1) * N);
         left += kUnroll * N;
         hwy::Prefetch(keys + left + 3 * kUnroll * N);
       }
 
-      StoreLeftRight4(d, st, v0, v1, v2, v3, pivot, keys, writeL, remaining);
+      StoreLeftRightUnrolled<kUnroll>(d, st, v0, v1, v2, v3, pivot, keys,
+                                      writeL, remaining, writer);
     }
 
     // Now finish writing the initial left/right to the middle.
-    StoreLeftRight4(d, st, vL0, vL1, vL2, vL3, pivot, keys, writeL, remaining);
-    StoreLeftRight4(d, st, vR0, vR1, vR2, vR3, pivot, keys, writeL, remaining);
+    StoreLeftRightUnrolled<kUnroll>(d, st, vL0, vL1, vL2, vL3, pivot, keys,
+                                    writeL, remaining, writer);
+    StoreLeftRightUnrolled<kUnroll>(d, st, vR0, vR1, vR2, vR3, pivot, keys,
+                                    writeL, remaining, writer);
+    writer.Finish(keys, writeL, remaining);
   }
 
   // We have partitioned [left, right) such that writeL is the boundary.
@@ -424,6 +715,102 @@ HWY_NOINLINE size_t Partition(D d, Traits st, T* HWY_RESTRICT keys, size_t left,
   return writeL;
 }
 
+#if VQSORT_BLOCK_PARTITION || VQSORT_STREAM_PARTITION
+// Whether `keys` is aligned to the size of a key, as required by BlockWriter.
+template <class Traits, typename T>
+HWY_INLINE bool IsKeyAligned(Traits st, const T* keys) {
+  return reinterpret_cast<uintptr_t>(keys) % (st.LanesPerKey() * sizeof(T)) ==
+         0;
+}
+#endif  // VQSORT_BLOCK_PARTITION || VQSORT_STREAM_PARTITION
+
+// PartitionUnrolled with the unroll factor selected by `tuning`.
+template <class D, class Traits, typename T, class Writer>
+HWY_INLINE size_t PartitionWith(D d, Traits st, T* HWY_RESTRICT keys,
+                                size_t left, size_t right, const Vec<D> pivot,
+                                T* HWY_RESTRICT buf, const SortTuning& tuning,
+                                Writer writer) {
+  if (tuning.partition_unroll == 2) {
+    return PartitionUnrolled<2>(d, st, keys, left, right, pivot, buf, writer);
+  }
+  return PartitionUnrolled<Constants::kPartitionUnroll>(d, st, keys, left,
+                                                        right, pivot, buf,
+                                                        writer);
+}
+
+// Partition with the unroll factor and writer selected by `tuning`.
+template <class D, class Traits, typename T>
+HWY_INLINE size_t Partition(D d, Traits st, T* HWY_RESTRICT keys, size_t left,
+                            size_t right, const Vec<D> pivot,
+                            T* HWY_RESTRICT buf, const SortTuning& tuning) {
+#if VQSORT_BLOCK_PARTITION
+  if (tuning.block_partition && IsKeyAligned(st, keys)) {
+    return PartitionWith(d, st, keys, left, right, pivot, buf, tuning,
+                         BlockWriter<D, T, /*kStream=*/false>(d, buf));
+  }
+#endif
+  return PartitionWith(d, st, keys, left, right, pivot, buf, tuning,
+                       DirectWriter());
+}
+
+#if VQSORT_STREAM_PARTITION
+
+// Whether a partition of `bytes` uses PartitionStream; see
+// SortTuning::stream_partition_mib.
+HWY_INLINE bool IsStreamPartition(const SortTuning& tuning, size_t bytes) {
+  const uint32_t mib = tuning.stream_partition_mib;
+  return mib != 0 && (bytes >> 20) >= mib;
+}
+
+// Same as Partition, but with non-temporal stores; see BlockWriter. Requires
+// IsKeyAligned.
+template <class D, class Traits, typename T>
+HWY_INLINE size_t PartitionStream(D d, Traits st, T* HWY_RESTRICT keys,
+                                  size_t left, size_t right,
+                                  const Vec<D> pivot, T* HWY_RESTRICT buf) {
+  return PartitionUnrolled<Constants::kPartitionUnroll>(
+      d, st, keys, left, right, pivot, buf,
+      BlockWriter<D, T, /*kStream=*/true>(d, buf));
+}
+
+#endif  // VQSORT_STREAM_PARTITION
+
+// Partition moves keys for which `Compare(pivot, key)` is true to the right.
+// This adapter instead moves keys that are not before the pivot in sort order.
+// After a regular Partition, the keys on the left are at most the pivot, so
+// partitioning them again with this adapter separates the keys equal to the
+// pivot from those before it.
+template <class Base>
+struct PivotEqualToRight : public Base {
+  explicit PivotEqualToRight(const Base& base) : Base(base) {}
+
+  template <class D>
+  HWY_INLINE Mask<D> Compare(D d, Vec<D> pivot, Vec<D> v) {
+    return Not(Base::Compare(d, v, pivot));
+  }
+};
+
+// Three-way partition for inputs with many keys equal to `pivot`. Returns
+// `bound` as in Partition and sets `bound_equal` such that [left, bound_equal)
+// are before the pivot, [bound_equal, bound) equal to it, and [bound, right)
+// after it. The second pass only visits the left side.
+template <class D, class Traits, typename T>
+HWY_INLINE size_t PartitionThreeWay(D d, Traits st, T* HWY_RESTRICT keys,
+                                    size_t left, size_t right,
+                                    const Vec<D> pivot, T* HWY_RESTRICT buf,
+                                    const SortTuning& tuning,
+                                    size_t& bound_equal) {
+  const size_t bound = Partition(d, st, keys, left, right, pivot, buf, tuning);
+  bound_equal = bound;
+  // Partition requires more than two vectors. Otherwise, the caller's
+  // BaseCase sorts the left side anyway.
+  if (bound - left > Constants::BaseCaseNum(Lanes(d))) {
+    bound_equal = Partition(d, PivotEqualToRight<Traits>(st), keys, left,
+                            bound, pivot, buf, tuning);
+  }
+  return bound;
+}
+
 // ------------------------------ Pivot
 
 template <class Traits, class V>
@@ -524,10 +911,18 @@ HWY_INLINE size_t RandomChunkIndex(const uint32_t num_chunks, uint32_t bits) {
   return static_cast<size_t>(chunk_index);
 }
 
-template <class D, class Traits, typename T>
-HWY_NOINLINE Vec<D> ChoosePivot(D d, Traits st, T* HWY_RESTRICT keys,
-                                const size_t begin, const size_t end,
-                                T* HWY_RESTRICT buf, Generator& rng) {
+// Samples kChunks (3 or 9) random chunks and returns their median of medians.
+// If `is_frequent` is non-null, also sets it to whether the pivot occurs often
+// in the sample, which is a hint to use PartitionThreeWay. If `sample_bits` is
+// non-null, sets its lanes such that their union is the bits that differ
+// between the sampled keys; see MaybeRadixSort.
+template <size_t kChunks, class D, class Traits, typename T>
+HWY_NOINLINE Vec<D> ChoosePivotFromChunks(D d, Traits st, T* HWY_RESTRICT keys,
+                                          const size_t begin, const size_t end,
+                                          T* HWY_RESTRICT buf, Generator& rng,
+                                          bool* is_frequent,
+                                          Vec<D>* sample_bits) {
+  static_assert(kChunks == 3 || kChunks == 9, "Unsupported number of chunks");
   using V = decltype(Zero(d));
   const size_t N = Lanes(d);
 
@@ -538,7 +933,8 @@ HWY_NOINLINE Vec<D> ChoosePivot(D d, Traits st, T* HWY_RESTRICT keys,
   size_t num = end - begin;
 
   // Align start of keys to chunks. We always have at least 2 chunks because the
-  // base case would have handled anything up to 16 vectors, i.e. >= 4 chunks.
+  // base case (see TunedBaseCaseNum) would have handled anything up to 4
+  // chunks.
   HWY_DASSERT(num >= 2 * lanes_per_chunk);
   const size_t misalign =
       (reinterpret_cast<uintptr_t>(keys) / sizeof(T)) & (lanes_per_chunk - 1);
@@ -548,9 +944,9 @@ HWY_NOINLINE Vec<D> ChoosePivot(D d, Traits st, T* HWY_RESTRICT keys,
     num -= consume;
   }
 
-  // Generate enough random bits for 9 uint32
+  // Generate enough random bits for kChunks uint32
   uint64_t* bits64 = reinterpret_cast<uint64_t*>(buf);
-  for (size_t i = 0; i < 5; ++i) {
+  for (size_t i = 0; i < (kChunks + 1) / 2; ++i) {
     bits64[i] = rng();
   }
   const uint32_t* bits = reinterpret_cast<const uint32_t*>(buf);
@@ -563,37 +959,90 @@ HWY_NOINLINE Vec<D> ChoosePivot(D d, Traits st, T* HWY_RESTRICT keys,
   const uint32_t num_chunks =
       static_cast<uint32_t>(HWY_MIN(num_chunks64, 0xFFFFFFFFull));
 
+  // offset3 to offset8 are unused if kChunks == 3.
   const size_t offset0 = RandomChunkIndex(num_chunks, bits[0]) << log2_lpc;
   const size_t offset1 = RandomChunkIndex(num_chunks, bits[1]) << log2_lpc;
   const size_t offset2 = RandomChunkIndex(num_chunks, bits[2]) << log2_lpc;
-  const size_t offset3 = RandomChunkIndex(num_chunks, bits[3]) << log2_lpc;
-  const size_t offset4 = RandomChunkIndex(num_chunks, bits[4]) << log2_lpc;
-  const size_t offset5 = RandomChunkIndex(num_chunks, bits[5]) << log2_lpc;
-  const size_t offset6 = RandomChunkIndex(num_chunks, bits[6]) << log2_lpc;
-  const size_t offset7 = RandomChunkIndex(num_chunks, bits[7]) << log2_lpc;
-  const size_t offset8 = RandomChunkIndex(num_chunks, bits[8]) << log2_lpc;
+  const size_t offset3 =
+      kChunks == 9 ? RandomChunkIndex(num_chunks, bits[3]) << log2_lpc : 0;
+  const size_t offset4 =
+      kChunks == 9 ? RandomChunkIndex(num_chunks, bits[4]) << log2_lpc : 0;
+  const size_t offset5 =
+      kChunks == 9 ? RandomChunkIndex(num_chunks, bits[5]) << log2_lpc : 0;
+  const size_t offset6 =
+      kChunks == 9 ? RandomChunkIndex(num_chunks, bits[6]) << log2_lpc : 0;
+  const size_t offset7 =
+      kChunks == 9 ? RandomChunkIndex(num_chunks, bits[7]) << log2_lpc : 0;
+  const size_t offset8 =
+      kChunks == 9 ? RandomChunkIndex(num_chunks, bits[8]) << log2_lpc : 0;
   for (size_t i = 0; i < lanes_per_chunk; i += N) {
     const V v0 = Load(d, keys + offset0 + i);
     const V v1 = Load(d, keys + offset1 + i);
     const V v2 = Load(d, keys + offset2 + i);
     const V medians0 = MedianOf3(st, v0, v1, v2);
     Store(medians0, d, buf + i);
+    if (kChunks == 9) {
+      const V v3 = Load(d, keys + offset3 + i);
+      const V v4 = Load(d, keys + offset4 + i);
+      const V v5 = Load(d, keys + offset5 + i);
+      const V medians1 = MedianOf3(st, v3, v4, v5);
+      Store(medians1, d, buf + i + lanes_per_chunk);
+
+      const V v6 = Load(d, keys + offset6 + i);
+      const V v7 = Load(d, keys + offset7 + i);
+      const V v8 = Load(d, keys + offset8 + i);
+      const V medians2 = MedianOf3(st, v6, v7, v8);
+      Store(medians2, d, buf + i + lanes_per_chunk * 2);
+    }
+  }
 
-    const V v3 = Load(d, keys + offset3 + i);
-    const V v4 = Load(d, keys + offset4 + i);
-    const V v5 = Load(d, keys + offset5 + i);
-    const V medians1 = MedianOf3(st, v3, v4, v5);
-    Store(medians1, d, buf + i + lanes_per_chunk);
-
-    const V v6 = Load(d, keys + offset6 + i);
-    const V v7 = Load(d, keys + offset7 + i);
-    const V v8 = Load(d, keys + offset8 + i);
-    const V medians2 = MedianOf3(st, v6, v7, v8);
-    Store(medians2, d, buf + i + lanes_per_chunk * 2);
+  const V pivot = RecursiveMedianOf3(d, st, buf, kChunks / 3 * lanes_per_chunk,
+                                     buf + 3 * lanes_per_chunk);
+  if (is_frequent != nullptr) {
+    // The sampled chunks are still in L1. Count their keys that are equal to
+    // the pivot in sort order (for key-value pairs, only the key counts).
+    const size_t offsets[9] = {offset0, offset1, offset2, offset3, offset4,
+                               offset5, offset6, offset7, offset8};
+    size_t num_equal = 0;
+    for (size_t c = 0; c < kChunks; ++c) {
+      for (size_t i = 0; i < lanes_per_chunk; i += N) {
+        const V v = Load(d, keys + offsets[c] + i);
+        const auto before_or_after =
+            Or(st.Compare(d, pivot, v), st.Compare(d, v, pivot));
+        num_equal += CountTrue(d, Not(before_or_after));
+      }
+    }
+    // Frequent := at least 1/8 of the sample. Both counts are in lanes.
+    *is_frequent = num_equal * 8 >= kChunks * lanes_per_chunk;
   }
+  if (sample_bits != nullptr) {
+    const V first = Set(d, keys[offset0]);
+    const size_t offsets[9] = {offset0, offset1, offset2, offset3, offset4,
+                               offset5, offset6, offset7, offset8};
+    V diff = Zero(d);
+    for (size_t c = 0; c < kChunks; ++c) {
+      for (size_t i = 0; i < lanes_per_chunk; i += N) {
+        diff = Or(diff, Xor(first, Load(d, keys + offsets[c] + i)));
+      }
+    }
+    *sample_bits = diff;
+  }
+  return pivot;
+}
 
-  return RecursiveMedianOf3(d, st, buf, 3 * lanes_per_chunk,
-                            buf + 3 * lanes_per_chunk);
+// ChoosePivotFromChunks with the sample size selected by `tuning`.
+template <class D, class Traits, typename T>
+HWY_INLINE Vec<D> ChoosePivot(D d, Traits st, T* HWY_RESTRICT keys,
+                              const size_t begin, const size_t end,
+                              T* HWY_RESTRICT buf, const SortTuning& tuning,
+                              Generator& rng, bool* is_frequent = nullptr,
+                              Vec<D>* sample_bits = nullptr) {
+  if (tuning.pivot_chunks == 3) {
+    return ChoosePivotFromChunks<3>(d, st, keys, begin, end, buf, rng,
+                                    is_frequent, sample_bits);
+  }
+  return ChoosePivotFromChunks<9>(d, st, keys, begin, end, buf, rng,
+                                  is_frequent, sample_bits);
 }
 
 // Compute exact min/max to detect all-equal partitions. Only called after a
@@ -624,210 +1073,976 @@ HWY_NOINLINE void ScanMinMax(D d, Traits st, const T* HWY_RESTRICT keys,
   last = st.LastOfLanes(d, last, buf);
 }
 
-static int printed = 0;
+// Partitions of up to this many lanes are sorted by BaseCase rather than
+// partitioned again; see SortTuning::base_case_rows.
+template <typename T>
+HWY_INLINE size_t TunedBaseCaseNum(const SortTuning& tuning, size_t N) {
+  return Constants::TunedBaseCaseNum(tuning.base_case_rows, sizeof(T), N);
+}
 
-template <class D, class Traits, typename T>
+// If `pivot_is_frequent` (see ChoosePivot), partitions three ways so that the
+// keys equal to the pivot are excluded from further recursion. Otherwise, such
+// duplicates are only detected once a partition is degenerate.
+template <class D, class Traits, typename T, class Stats>
 void Recurse(D d, Traits st, T* HWY_RESTRICT keys, T* HWY_RESTRICT keys_end,
              const size_t begin, const size_t end, const Vec<D> pivot,
-             T* HWY_RESTRICT buf, Generator& rng, size_t remaining_levels) {
-
-  //if (printed++ > 10) return;
-
-  max_depth = std::max(max_depth, depth);  
-
+             bool pivot_is_frequent, T* HWY_RESTRICT buf,
+             const SortTuning& tuning, Generator& rng, size_t remaining_levels,
+             Stats& stats) {
   HWY_DASSERT(begin + 1 < end);
   const size_t num = end - begin;  // >= 2
 
   // Too many degenerate partitions. This is extremely unlikely to happen
   // because we select pivots from large (though still O(1)) samples.
   if (HWY_UNLIKELY(remaining_levels == 0)) {
-    //for (size_t i = 0; i < depth; ++i) printf("*"); printf(" ");
-    //printf("Heapsort with %llu\n", num);
-    //heap_sort += num;
+    stats.HeapSortFallback();
     HeapSort(st, keys + begin, num);  // Slow but N*logN.
-    //dist[depth]++;
-    //count_at_depth[depth] += num;
-    
     return;
   }
 
   const ptrdiff_t base_case_num =
-      static_cast<ptrdiff_t>(Constants::BaseCaseNum(Lanes(d)));
-  const size_t bound = Partition(d, st, keys, begin, end, pivot, buf);
-  //count_at_depth[depth] += num;
+      static_cast<ptrdiff_t>(TunedBaseCaseNum<T>(tuning, Lanes(d)));
+  // The left side is [begin, end_left), the right side [bound, end). Keys in
+  // between (if any) are equal to the pivot and thus already in place.
+  size_t bound, end_left;
+  if (HWY_UNLIKELY(pivot_is_frequent)) {
+    stats.ThreeWay();
+    bound = PartitionThreeWay(d, st, keys, begin, end, pivot, buf, tuning,
+                              end_left);
+#if VQSORT_STREAM_PARTITION
+  } else if (HWY_UNLIKELY(IsStreamPartition(tuning, num * sizeof(T))) &&
+             IsKeyAligned(st, keys)) {
+    bound = PartitionStream(d, st, keys, begin, end, pivot, buf);
+    end_left = bound;
+#endif
+  } else {
+    bound = Partition(d, st, keys, begin, end, pivot, buf, tuning);
+    end_left = bound;
+  }
+  stats.Partition(num / st.LanesPerKey());
 
   const ptrdiff_t num_left =
-      static_cast<ptrdiff_t>(bound) - static_cast<ptrdiff_t>(begin);
+      static_cast<ptrdiff_t>(end_left) - static_cast<ptrdiff_t>(begin);
   const ptrdiff_t num_right =
       static_cast<ptrdiff_t>(end) - static_cast<ptrdiff_t>(bound);
 
-  bool end_rec = true;
-
-  //printf("Partition: [%lu %lu %lu]\n", begin, bound, end); 
-  //for(size_t i = begin; i < std::min(begin + 20, bound); ++i) printf("%lu ", keys[i]); printf("\n");
-  //for(size_t i = bound; i < std::min(bound + 20, end); ++i) printf("%lu ", keys[i]); printf("\n");
-
-  // Check for degenerate partitions (i.e. Partition did not move any keys):
-  if (HWY_UNLIKELY(num_right == 0)) {
-    //printf("Right partition empty\n");
+  // Check for degenerate partitions (i.e. Partition did not move any keys).
+  // Not possible after a three-way partition: the pivot is one of the keys,
+  // hence at least one key is equal to it and excluded from the left side.
+  if (HWY_UNLIKELY(end_left == end)) {
+    stats.Degenerate();
     // Because the pivot is one of the keys, it must have been equal to the
     // first or last key in sort order. Scan for the actual min/max:
     // passing the current pivot as the new bound is insufficient because one of
     // the partitions might not actually include that key.
     Vec<D> first, last;
     ScanMinMax(d, st, keys + begin, num, buf, first, last);
-    //count_at_depth[depth] += num;
-    if (AllTrue(d, Eq(first, last))) {
-     //for (size_t i = 0; i < depth; ++i) printf("*"); printf(" ");
-     //printf("[L] Depth: %d -- All same %lu\n", depth, num_left);
-      //dist[depth]++;
-      return;
-    }
+    if (AllTrue(d, st.EqualKeys(d, first, last))) return;
 
     // Separate recursion to make sure that we don't pick `last` as the
     // pivot - that would again lead to a degenerate partition.
-    //for (size_t i = 0; i < depth; ++i) printf("*"); printf(" ");
-    //printf("[L] Recurse depth: %d, left: %d, right: %d\n", depth, begin, end);
-    ++depth;
-    Recurse(d, st, keys, keys_end, begin, end, first, buf, rng,
-            remaining_levels - 1);
-    --depth;
+    stats.Enter();
+    Recurse(d, st, keys, keys_end, begin, end, first,
+            /*pivot_is_frequent=*/false, buf, tuning, rng,
+            remaining_levels - 1, stats);
+    stats.Leave();
     return;
   }
 
   if (HWY_UNLIKELY(num_left <= base_case_num)) {
+    stats.BaseCase();
     BaseCase(d, st, keys + begin, keys_end, static_cast<size_t>(num_left), buf);
-    //dist[depth]++;
-    //for (size_t i = 0; i < depth; ++i) printf("*"); printf(" ");
-    //printf("[L] Depth: %d -- Base case %lu\n", depth, num_left);
-    
   } else {
-    const Vec<D> next_pivot = ChoosePivot(d, st, keys, begin, bound, buf, rng);
-    //for (size_t i = 0; i < depth; ++i) printf("*"); printf(" ");
-   // printf("[L] Recurse depth: %d, left: %d, right: %d\n", depth, begin, bound);
-    ++depth;
-    Recurse(d, st, keys, keys_end, begin, bound, next_pivot, buf, rng,
-            remaining_levels - 1);
-    --depth;
+    bool next_is_frequent;
+    const Vec<D> next_pivot = ChoosePivot(d, st, keys, begin, end_left, buf,
+                                          tuning, rng, &next_is_frequent);
+    stats.Enter();
+    Recurse(d, st, keys, keys_end, begin, end_left, next_pivot,
+            next_is_frequent, buf, tuning, rng, remaining_levels - 1, stats);
+    stats.Leave();
   }
   if (HWY_UNLIKELY(num_right <= base_case_num)) {
+    stats.BaseCase();
     BaseCase(d, st, keys + bound, keys_end, static_cast<size_t>(num_right),
              buf);
-    //dist[depth]++;
-    //for (size_t i = 0; i < depth; ++i) printf("*"); printf(" ");
-    //printf("[R] Depth: %d -- Base case %lu\n", depth, num_right);
   } else {
-    const Vec<D> next_pivot = ChoosePivot(d, st, keys, bound, end, buf, rng);
-    //for (size_t i = 0; i < depth; ++i) printf("*"); printf(" ");
-    //printf("[R] Recurse depth: %d, left: %d, right: %d\n", depth, bound, end);
-    ++depth;    
-    Recurse(d, st, keys, keys_end, bound, end, next_pivot, buf, rng,
-            remaining_levels - 1);
-    --depth;
+    bool next_is_frequent;
+    const Vec<D> next_pivot = ChoosePivot(d, st, keys, bound, end, buf,
+                                          tuning, rng, &next_is_frequent);
+    stats.Enter();
+    Recurse(d, st, keys, keys_end, bound, end, next_pivot, next_is_frequent,
+            buf, tuning, rng, remaining_levels - 1, stats);
+    stats.Leave();
   }
+}
+
+// Partition assumes its input is at least two vectors, and BaseCase handles up
+// to BaseCaseNum keys. If vectors have more lanes than this, which is only
+// possible on RVV with LMUL > 1, they are capped to this many lanes. Wider
+// vectors (e.g. 2048-bit SVE) are otherwise used at full width; only the
+// sorting networks are limited to Constants::kMaxCols lanes.
+constexpr size_t kMaxSortLanes = Constants::kMaxRows * Constants::kMaxCols / 2;
 
+template <class D>
+HWY_INLINE bool IsHugeVector(D d) {
+  return MaxLanes(d) > kMaxSortLanes && Lanes(d) > kMaxSortLanes;
+}
+
+// 128-bit keys require vectors with at least two u64 lanes, which is always
+// the case unless `d` requests partial vectors (e.g. fraction = 1/2) AND the
+// hardware vector width is less than 128bit / fraction. If so, 128-bit vectors
+// are used instead, which SortConstants::BufNum accounts for.
+template <class D, class Traits>
+HWY_INLINE bool IsTooSmallForKey(D d, Traits st) {
+  return !IsFull(d) && st.Is128() && Lanes(d) < 2;
 }
 
 // Returns true if sorting is finished.
-template <class D, class Traits, typename T>
+template <class D, class Traits, typename T, class Stats>
 bool HandleSpecialCases(D d, Traits st, T* HWY_RESTRICT keys, size_t num,
-                        T* HWY_RESTRICT buf) {
+                        T* HWY_RESTRICT buf, Stats& stats) {
   const size_t N = Lanes(d);
   const size_t base_case_num = Constants::BaseCaseNum(N);
-
-  // 128-bit keys require vectors with at least two u64 lanes, which is always
-  // the case unless `d` requests partial vectors (e.g. fraction = 1/2) AND the
-  // hardware vector width is less than 128bit / fraction.
-  const bool partial_128 = !IsFull(d) && N < 2 && st.Is128();
-  // Partition assumes its input is at least two vectors. If vectors are huge,
-  // base_case_num may actually be smaller. If so, which is only possible on
-  // RVV, pass a capped or partial d (LMUL < 1). Use HWY_MAX_BYTES instead of
-  // HWY_LANES to account for the largest possible LMUL.
-  constexpr bool kPotentiallyHuge =
-      HWY_MAX_BYTES / sizeof(T) > Constants::kMaxRows * Constants::kMaxCols;
-  const bool huge_vec = kPotentiallyHuge && (2 * N > base_case_num);
-  if (partial_128 || huge_vec) {
-    // PERFORMANCE WARNING: falling back to HeapSort.
-    HeapSort(st, keys, num);
-    return true;
-  }
+  // Callers replace such `d`, see above.
+  HWY_DASSERT(!IsHugeVector(d) && !IsTooSmallForKey(d, st));
 
   // Small arrays: use sorting network, no need for other checks.
   if (HWY_UNLIKELY(num <= base_case_num)) {
+    stats.BaseCase();
     BaseCase(d, st, keys, keys + num, num, buf);
     return true;
   }
 
-  // We could also check for already sorted/reverse/equal, but that's probably
-  // counterproductive if vqsort is used as a base case.
+  // Checking for already sorted/reverse input is opt-in (see HandlePresorted)
+  // because it is probably counterproductive if vqsort is used as a base case.
 
   return false;  // not finished sorting
 }
 
+template <class D, class Traits, typename T>
+bool HandleSpecialCases(D d, Traits st, T* HWY_RESTRICT keys, size_t num,
+                        T* HWY_RESTRICT buf) {
+  NoStats no_stats;
+  return HandleSpecialCases(d, st, keys, num, buf, no_stats);
+}
+
+// Sorts keys[begin, end), choosing the pivot for the first partition.
+template <class D, class Traits, typename T, class Stats>
+void SortRange(D d, Traits st, T* HWY_RESTRICT keys, T* HWY_RESTRICT keys_end,
+               size_t begin, size_t end, T* HWY_RESTRICT buf,
+               const SortTuning& tuning, Generator& rng,
+               size_t remaining_levels, Stats& stats) {
+  const size_t num = end - begin;
+  if (num <= TunedBaseCaseNum<T>(tuning, Lanes(d))) {
+    stats.BaseCase();
+    BaseCase(d, st, keys + begin, keys_end, num, buf);
+    return;
+  }
+  bool is_frequent;
+  const Vec<D> pivot =
+      ChoosePivot(d, st, keys, begin, end, buf, tuning, rng, &is_frequent);
+  Recurse(d, st, keys, keys_end, begin, end, pivot, is_frequent, buf, tuning,
+          rng, remaining_levels, stats);
+}
+
+// Samplesorts keys[0, num) if their type is supported (see SampleSortOrder),
+// sorting buckets smaller than SampleSortConstants::kMinKeys via SortRange.
+// Returns false if samplesort is not applicable.
+template <class D, class Traits, typename T, class Stats,
+          hwy::EnableIf<SampleSortOrder<Traits>::kEnabled>* = nullptr>
+bool SampleSortWithBuf(D d, Traits st, T* HWY_RESTRICT keys, size_t num,
+                       T* HWY_RESTRICT buf, const SortTuning& tuning,
+                       Generator& rng, Stats& stats) {
+  const auto sort_small = [&](T* HWY_RESTRICT bucket, size_t size) {
+    const size_t max_levels = 2 * hwy::CeilLog2(size) + 4;
+    SortRange(d, st, bucket, bucket + size, 0, size, buf, tuning, rng,
+              max_levels, stats);
+  };
+  if (!SampleSort(d, st, keys, num, rng, sort_small)) return false;
+  stats.SampleSort();
+  return true;
+}
+
+template <class D, class Traits, typename T, class Stats,
+          hwy::EnableIf<!SampleSortOrder<Traits>::kEnabled>* = nullptr>
+bool SampleSortWithBuf(D /* d */, Traits /* st */, T* HWY_RESTRICT /* keys */,
+                       size_t /* num */, T* HWY_RESTRICT /* buf */,
+                       const SortTuning& /* tuning */, Generator& /* rng */,
+                       Stats& /* stats */) {
+  return false;
+}
+
+// Partitions keys[0, num) until the partition containing lane `k` is small
+// enough for BaseCase, which then moves the k-th key in sort order to `k`.
+// We only recurse into the partition containing `k`. If `sort_prefix`, the
+// partitions before `k` are also sorted (and we can stop once `k` is a
+// partition boundary). Keys behind the current partition are all greater
+// (in sort order) than those within it, hence BaseCase may sort across `end`.
+template <class D, class Traits, typename T>
+void SelectRange(D d, Traits st, T* HWY_RESTRICT keys, size_t num, size_t k,
+                 bool sort_prefix, T* HWY_RESTRICT buf,
+                 const SortTuning& tuning, Generator& rng,
+                 size_t remaining_levels) {
+  const size_t base_case_num = TunedBaseCaseNum<T>(tuning, Lanes(d));
+  T* HWY_RESTRICT keys_end = keys + num;
+  size_t begin = 0;
+  size_t end = num;
+  while (end - begin > base_case_num) {
+    // Too many degenerate partitions, see Recurse.
+    if (HWY_UNLIKELY(remaining_levels == 0)) {
+      HeapSort(st, keys + begin, end - begin);  // Slow but N*logN.
+      return;
+    }
+    --remaining_levels;
+
+    const Vec<D> pivot = ChoosePivot(d, st, keys, begin, end, buf, tuning, rng);
+    size_t bound = Partition(d, st, keys, begin, end, pivot, buf, tuning);
+    // Degenerate partition: same handling as in Recurse.
+    if (HWY_UNLIKELY(bound == end)) {
+      Vec<D> first, last;
+      ScanMinMax(d, st, keys + begin, end - begin, buf, first, last);
+      if (AllTrue(d, st.EqualKeys(d, first, last))) return;
+      bound = Partition(d, st, keys, begin, end, first, buf, tuning);
+    }
+
+    if (bound > k) {
+      end = bound;
+    } else {
+      if (sort_prefix) {
+        NoStats no_stats;
+        SortRange(d, st, keys, keys_end, begin, bound, buf, tuning, rng,
+                  remaining_levels, no_stats);
+        if (bound == k) return;
+      }
+      begin = bound;
+    }
+  }
+  BaseCase(d, st, keys + begin, keys_end, end - begin, buf);
+}
+
+// ------------------------------ Parallel
+
+// Subrange [begin, end) of lanes that a single thread sorts independently.
+struct SortTask {
+  size_t begin;
+  size_t end;
+  size_t remaining_levels;
+  uint64_t seed;  // for the per-task Generator
+};
+
+// Ranges smaller than this are not worth splitting across threads: the cost
+// of waking the pool would exceed the time to partition them.
+static constexpr size_t kMinParallelBytes = 256 * 1024;
+// Number of tasks per thread. Oversubscription balances the load because the
+// task sizes depend on the (random) pivots.
+static constexpr size_t kTasksPerThread = 8;
+
+// Swaps the non-overlapping lanes a[0, num) and b[0, num).
+template <class D, typename T>
+HWY_INLINE void SwapRanges(D d, T* HWY_RESTRICT a, T* HWY_RESTRICT b,
+                           size_t num) {
+  const size_t N = Lanes(d);
+  size_t i = 0;
+  for (; i + N <= num; i += N) {
+    const Vec<D> va = LoadU(d, a + i);
+    const Vec<D> vb = LoadU(d, b + i);
+    StoreU(vb, d, a + i);
+    StoreU(va, d, b + i);
+  }
+  for (; i < num; ++i) {
+    const T t = a[i];
+    a[i] = b[i];
+    b[i] = t;
+  }
+}
+
+// Range of lanes that ended up on the wrong side of the global boundary.
+struct Misplaced {
+  size_t begin;
+  size_t num;
+};
+
+// Returns the index of the interval containing the `pos`-th lane of the
+// concatenation of `intervals`, and sets `offset` to the position within it.
+HWY_INLINE size_t LocateMisplaced(const std::vector<Misplaced>& intervals,
+                                  size_t pos, size_t& offset) {
+  size_t idx = 0;
+  while (pos >= intervals[idx].num) {
+    pos -= intervals[idx].num;
+    ++idx;
+  }
+  offset = pos;
+  return idx;
+}
+
+// Same postcondition as Partition, but splits [begin, end) into one chunk per
+// thread, partitions each chunk independently with the same pivot, and then
+// swaps the misplaced right-side keys before the global boundary with the
+// left-side keys after it. `bufs` holds `buf_num` lanes per thread, plus one
+// vector for broadcasting the pivot.
+template <class D, class Traits, typename T>
+size_t ParallelPartition(D d, Traits st, T* HWY_RESTRICT keys, size_t begin,
+                         size_t end, const Vec<D> pivot, T* HWY_RESTRICT bufs,
+                         size_t buf_num, const SortTuning& tuning,
+                         size_t max_threads, ThreadPool& pool) {
+  constexpr size_t N1 = st.LanesPerKey();
+  const size_t num_keys = (end - begin) / N1;
+  const size_t min_keys = kMinParallelBytes / (sizeof(T) * N1);
+  const size_t num_threads =
+      HWY_MAX(size_t{1}, HWY_MIN(max_threads, num_keys / min_keys));
+
+  // Vectors cannot be captured by lambdas on all targets, hence pass the
+  // pivot via memory.
+  T* HWY_RESTRICT pivot_buf = bufs + max_threads * buf_num;
+  Store(pivot, d, pivot_buf);
+
+  // Chunk boundaries are whole keys so that 128-bit keys are not split.
+  std::vector<size_t> chunk_begin(num_threads + 1);
+  for (size_t t = 0; t <= num_threads; ++t) {
+    chunk_begin[t] = begin + (num_keys * t / num_threads) * N1;
+  }
+  std::vector<size_t> chunk_bound(num_threads);
+  pool.RunOnThreads(num_threads, [&](size_t thread) {
+    chunk_bound[thread] =
+        Partition(d, st, keys, chunk_begin[thread], chunk_begin[thread + 1],
+                  Load(d, pivot_buf), bufs + thread * buf_num, tuning);
+  });
+
+  size_t bound = begin;
+  for (size_t t = 0; t < num_threads; ++t) {
+    bound += chunk_bound[t] - chunk_begin[t];
+  }
+
+  // Right-side keys before `bound` and left-side keys after it. Both have the
+  // same total size, so swapping them pairwise completes the partition.
+  std::vector<Misplaced> wrong_left;
+  std::vector<Misplaced> wrong_right;
+  size_t total = 0;
+  for (size_t t = 0; t < num_threads; ++t) {
+    const size_t right_end = HWY_MIN(chunk_begin[t + 1], bound);
+    if (chunk_bound[t] < right_end) {
+      wrong_left.push_back({chunk_bound[t], right_end - chunk_bound[t]});
+      total += right_end - chunk_bound[t];
+    }
+    const size_t left_begin = HWY_MAX(chunk_begin[t], bound);
+    if (left_begin < chunk_bound[t]) {
+      wrong_right.push_back({left_begin, chunk_bound[t] - left_begin});
+    }
+  }
+  if (total == 0) return bound;
+
+  const size_t total_keys = total / N1;
+  const size_t swap_threads =
+      HWY_MAX(size_t{1}, HWY_MIN(num_threads, total_keys / min_keys));
+  const auto swap_share = [&](size_t thread) {
+    size_t pos = (total_keys * thread / swap_threads) * N1;
+    const size_t stop = (total_keys * (thread + 1) / swap_threads) * N1;
+    if (pos == stop) return;
+    size_t offset_l, offset_r;
+    size_t idx_l = LocateMisplaced(wrong_left, pos, offset_l);
+    size_t idx_r = LocateMisplaced(wrong_right, pos, offset_r);
+    while (pos != stop) {
+      const Misplaced& l = wrong_left[idx_l];
+      const Misplaced& r = wrong_right[idx_r];
+      const size_t num = HWY_MIN(HWY_MIN(l.num - offset_l, r.num - offset_r),
+                                 stop - pos);
+      SwapRanges(d, keys + l.begin + offset_l, keys + r.begin + offset_r, num);
+      pos += num;
+      offset_l += num;
+      offset_r += num;
+      if (offset_l == l.num) {
+        ++idx_l;
+        offset_l = 0;
+      }
+      if (offset_r == r.num) {
+        ++idx_r;
+        offset_r = 0;
+      }
+    }
+  };
+  if (swap_threads == 1) {
+    swap_share(0);
+  } else {
+    pool.RunOnThreads(swap_threads, swap_share);
+  }
+  return bound;
+}
+
+// Sequentially sorts the subrange of a task. Must not touch keys outside
+// [begin, end) because other threads are concurrently sorting them, hence
+// BaseCase receives `end` as its keys_end.
+template <class D, class Traits, typename T>
+void SortTaskRange(D d, Traits st, T* HWY_RESTRICT keys, const SortTask& task,
+                   T* HWY_RESTRICT buf, const SortTuning& tuning) {
+  Generator rng(task.seed);
+  NoStats no_stats;
+  SortRange(d, st, keys, keys + task.end, task.begin, task.end, buf, tuning,
+            rng, task.remaining_levels, no_stats);
+}
+
+// ------------------------------ Merge
+
+// Merges the sorted keys of v0 and v1 (bitonic merge network): afterwards, v0
+// holds the first half of their keys in sort order, and v1 the second, both
+// sorted. Uses the same shuffles as SortingNetwork, hence requires at most
+// Constants::kMaxCols lanes.
+template <class D, class Traits, class V = Vec<D>>
+HWY_INLINE void MergeVectors(D d, Traits st, V& v0, V& v1) {
+  constexpr size_t kMaxKeys = MaxLanes(d) / st.LanesPerKey();
+  const size_t keys = Lanes(d) / st.LanesPerKey();
+
+  // Concatenating v0 and the reversed v1 forms a bitonic sequence, which the
+  // first comparison splits into two bitonic halves. Each of those is sorted
+  // by comparing keys at decreasing power of two distances.
+  v1 = st.ReverseKeys(d, v1);
+  st.Sort2(d, v0, v1);
+  if (keys >= 2 && kMaxKeys >= 2) {
+    v0 = st.SortPairsHalves(d, v0);
+    v1 = st.SortPairsHalves(d, v1);
+  }
+  if (keys >= 16 && kMaxKeys >= 16) {
+    v0 = st.SortPairsDistance4(d, v0);
+    v1 = st.SortPairsDistance4(d, v1);
+  }
+  if (keys >= 8 && kMaxKeys >= 8) {
+    v0 = st.SortPairsDistance2(d, v0);
+    v1 = st.SortPairsDistance2(d, v1);
+  }
+  if (keys >= 4 && kMaxKeys >= 4) {
+    v0 = st.SortPairsDistance1(d, v0);
+    v1 = st.SortPairsDistance1(d, v1);
+  }
+}
+
+// Same as MergeScalar, but merges one vector at a time: v1 holds the keys that
+// are not yet written, and each iteration loads a vector from whichever input
+// has the first next key, merges it with v1 and stores the first half. Once
+// that input has less than a vector left, the remainders are merged via
+// MergeScalar.
+template <class Traits, typename T>
+HWY_NOINLINE void MergeRuns(Traits st, const T* HWY_RESTRICT a, size_t na,
+                            const T* HWY_RESTRICT b, size_t nb,
+                            T* HWY_RESTRICT out) {
+  const CappedTag<T, Constants::kMaxCols> d;
+  constexpr size_t kMaxLanes = MaxLanes(d);
+  const size_t N = Lanes(d);
+  if (na < N || nb < N) return MergeScalar(st, a, na, b, nb, out);
+
+  Vec<decltype(d)> v0 = LoadU(d, a);
+  Vec<decltype(d)> v1 = LoadU(d, b);
+  size_t ia = N;
+  size_t ib = N;
+  bool take_b;
+  for (;;) {
+    MergeVectors(d, st, v0, v1);
+    StoreU(v0, d, out);
+    out += N;
+
+    take_b = ib != nb && (ia == na || st.Compare1(b + ib, a + ia));
+    if (take_b) {
+      if (nb - ib < N) break;
+      v0 = LoadU(d, b + ib);
+      ib += N;
+    } else {
+      if (na - ia < N) break;
+      v0 = LoadU(d, a + ia);
+      ia += N;
+    }
+  }
+
+  // The input we could not load from has less than N lanes left; merge them
+  // with v1 before the (possibly long) remainder of the other input.
+  HWY_ALIGN T last[kMaxLanes];
+  HWY_ALIGN T tail[2 * kMaxLanes];
+  Store(v1, d, last);
+  if (take_b) {
+    MergeScalar(st, last, N, b + ib, nb - ib, tail);
+    MergeScalar(st, a + ia, na - ia, tail, N + nb - ib, out);
+  } else {
+    MergeScalar(st, a + ia, na - ia, last, N, tail);
+    MergeScalar(st, tail, na - ia + N, b + ib, nb - ib, out);
+  }
+}
+
+// ------------------------------ Presorted input
+
+// Returns the number of lanes in the longest prefix of keys[0, num) in which
+// no key precedes (in sort order) its predecessor, or if `reverse`, follows
+// it. Stops at the first such key, hence this is cheap unless the prefix is
+// long.
+template <class D, class Traits, typename T>
+HWY_NOINLINE size_t SortedPrefix(D d, Traits st, const T* HWY_RESTRICT keys,
+                                 size_t num, bool reverse) {
+  constexpr size_t N1 = st.LanesPerKey();
+  const size_t N = Lanes(d);
+  size_t i = 0;
+  for (; i + N + N1 <= num; i += N) {
+    const Vec<D> v = LoadU(d, keys + i);
+    const Vec<D> next = LoadU(d, keys + i + N1);
+    const Mask<D> out_of_order =
+        reverse ? st.Compare(d, v, next) : st.Compare(d, next, v);
+    if (HWY_UNLIKELY(!AllFalse(d, out_of_order))) {
+      const size_t lane = static_cast<size_t>(FindFirstTrue(d, out_of_order));
+      return i + (lane / N1) * N1 + N1;
+    }
+  }
+  for (; i + N1 < num; i += N1) {
+    const bool out_of_order = reverse ? st.Compare1(keys + i, keys + i + N1)
+                                      : st.Compare1(keys + i + N1, keys + i);
+    if (out_of_order) return i + N1;
+  }
+  return num;
+}
+
+// Reverses the order of the keys in keys[0, num).
+template <class D, class Traits, typename T>
+HWY_NOINLINE void ReverseRange(D d, Traits st, T* HWY_RESTRICT keys,
+                               size_t num) {
+  constexpr size_t N1 = st.LanesPerKey();
+  const size_t N = Lanes(d);
+  size_t left = 0;
+  size_t right = num;
+  for (; right - left >= 2 * N; left += N, right -= N) {
+    const Vec<D> vL = LoadU(d, keys + left);
+    const Vec<D> vR = LoadU(d, keys + right - N);
+    StoreU(st.ReverseKeys(d, vR), d, keys + left);
+    StoreU(st.ReverseKeys(d, vL), d, keys + right - N);
+  }
+  for (; right - left >= 2 * N1; left += N1, right -= N1) {
+    st.Swap(keys + left, keys + right - N1);
+  }
+}
+
+// Returns true if sorting is finished because keys[0, num) were already sorted
+// or in reverse order (which we undo), or began with such a run of at least
+// half the keys. In the latter case, we only sort the remaining keys and then
+// merge them with the run, which allocates O(num) memory.
+template <class D, class Traits, typename T, class Stats>
+bool HandlePresorted(D d, Traits st, T* HWY_RESTRICT keys, size_t num,
+                     T* HWY_RESTRICT buf, const SortTuning& tuning,
+                     Stats& stats) {
+  constexpr size_t N1 = st.LanesPerKey();
+  size_t run = SortedPrefix(d, st, keys, num, /*reverse=*/false);
+  if (run == N1) {
+    run = SortedPrefix(d, st, keys, num, /*reverse=*/true);
+    ReverseRange(d, st, keys, run);
+  }
+  if (run == num) return true;
+  if (run < num / 2) return false;
+
+  auto merged = hwy::AllocateAligned<T>(num);
+  if (!merged) return false;
+  Generator rng(keys, num);
+  const size_t max_levels = 2 * hwy::CeilLog2(num - run) + 4;
+  SortRange(d, st, keys, keys + num, run, num, buf, tuning, rng, max_levels,
+            stats);
+  MergeRuns(st, keys, run, keys + run, num - run, merged.get());
+  memcpy(keys, merged.get(), num * sizeof(T));
+  return true;
+}
+
 #endif  // VQSORT_ENABLED
+
+#if VQSORT_ENABLED || HWY_IDE
+
+// Implementation of Sort after `buf` has been set up; `stats` is either
+// NoStats or StatsRecorder.
+template <class D, class Traits, typename T, class Stats>
+void SortWithBuf(D d, Traits st, T* HWY_RESTRICT keys, size_t num,
+                 T* HWY_RESTRICT buf, const SortTuning& tuning,
+                 bool detect_presorted, Stats& stats) {
+  if (IsHugeVector(d)) {
+    return SortWithBuf(CappedTag<T, kMaxSortLanes>(), st, keys, num, buf,
+                       tuning, detect_presorted, stats);
+  }
+  if (IsTooSmallForKey(d, st)) {
+    return SortWithBuf(CappedTag<T, 16 / sizeof(T)>(), st, keys, num, buf,
+                       tuning, detect_presorted, stats);
+  }
+  if (HandleSpecialCases(d, st, keys, num, buf, stats)) return;
+
+  if (detect_presorted &&
+      HandlePresorted(d, st, keys, num, buf, tuning, stats)) {
+    return;
+  }
+
+  // Pulled out of the recursion so we can special-case degenerate partitions.
+  Generator rng(keys, num);
+  // Samplesorting requires fewer passes over memory, but is only faster on
+  // some targets.
+  if (UseSampleSort<T>() && num >= SampleSortConstants::kMinKeys &&
+      SampleSortWithBuf(d, st, keys, num, buf, tuning, rng, stats)) {
+    return;
+  }
+
+  bool is_frequent;
+  // If enabled, large inputs of integer keys may be faster to radix sort,
+  // depending on how many digits vary in the sample.
+  const size_t radix_max_passes = tuning.radix_max_passes;
+  const bool radix = RadixOrder<Traits>::kEnabled && radix_max_passes != 0 &&
+                     num >= RadixConstants::kMinKeys;
+  Vec<D> sample_bits = Zero(d);
+  const Vec<D> pivot =
+      ChoosePivot(d, st, keys, 0, num, buf, tuning, rng, &is_frequent,
+                  radix ? &sample_bits : nullptr);
+  if (radix && !is_frequent &&
+      MaybeRadixSort(d, st, keys, num, sample_bits, buf, radix_max_passes)) {
+    stats.RadixSort();
+    return;
+  }
+
+  // Introspection: switch to worst-case N*logN heapsort after this many.
+  const size_t max_levels = 2 * hwy::CeilLog2(num) + 4;
+
+  Recurse(d, st, keys, keys + num, 0, num, pivot, is_frequent, buf, tuning,
+          rng, max_levels, stats);
+}
+
+#endif  // VQSORT_ENABLED
+
+// Returns `storage` for use as `buf` if the caller did not provide one. Lanes
+// of `buf` are only read after being written, so zero-initializing it on every
+// call would be wasted, except that MSAN cannot verify this for CompressStore.
+template <typename T, size_t kNum>
+HWY_INLINE T* StackBufUnlessProvided(T* HWY_RESTRICT buf, T (&storage)[kNum]) {
+  if (buf != nullptr) return buf;
+#if HWY_IS_MSAN
+  memset(storage, 0, sizeof(storage));
+#endif
+  return storage;
+}
+
+// Implementation of Sort; `stats` is either NoStats or StatsRecorder.
+template <class D, class Traits, typename T, class Stats>
+void SortImpl(D d, Traits st, T* HWY_RESTRICT keys, size_t num,
+              T* HWY_RESTRICT buf, const SortTuning& tuning,
+              bool detect_presorted, Stats& stats) {
+#if VQSORT_ENABLED || HWY_IDE
+#if !HWY_HAVE_SCALABLE
+  // On targets with fixed-size vectors, unless the caller provided `buf`, use
+  // stack storage. We avoid (potentially expensive for small input sizes)
+  // allocations on platforms where no targets are scalable. For 512-bit
+  // vectors, this fits on the stack (several KiB).
+  HWY_ALIGN T storage[SortConstants::BufNum<T>(HWY_LANES(T))];
+  static_assert(sizeof(storage) <= 8192, "Unexpectedly large, check size");
+  buf = StackBufUnlessProvided(buf, storage);
+#endif  // !HWY_HAVE_SCALABLE
+
+  SortWithBuf(d, st, keys, num, buf, tuning, detect_presorted, stats);
+#else
+  (void)d;
+  (void)buf;
+  (void)tuning;
+  (void)detect_presorted;
+  // PERFORMANCE WARNING: vqsort is not enabled for the non-SIMD target
+  stats.HeapSortFallback();
+  return HeapSort(st, keys, num);
+#endif  // VQSORT_ENABLED
+}
+
 }  // namespace detail
 
 // Sorts `keys[0..num-1]` according to the order defined by `st.Compare`.
-// In-place i.e. O(1) additional storage. Worst-case N*logN comparisons.
+// In-place i.e. O(1) additional storage, unless SortTuning::radix_max_passes
+// is nonzero, in which case large inputs of 32/64-bit integer keys may be radix
+// sorted with O(num) scratch space; see MaybeRadixSort. Worst-case N*logN
+// comparisons.
 // Non-stable (order of equal keys may change), except for the common case where
 // the upper bits of T are the key, and the lower bits are a sequential or at
 // least unique ID.
 // There is no upper limit on `num`, but note that pivots may be chosen by
 // sampling only from the first 256 GiB.
 //
+// If `detect_presorted`, first scans for input that is already sorted or in
+// reverse order, or begins with such a run of at least half the keys; see
+// HandlePresorted. The scan stops at the first out-of-order key, so it costs
+// little for other inputs.
+//
+// If `stats` is non-null, adds statistics about the recursion to it. This is a
+// separate instantiation, hence the default (null) costs nothing.
+//
+// If `tuning` is non-null, it is used instead of Sorter::Tuning(), which allows
+// comparing tunings without changing the one used by other threads.
+//
 // `d` is typically SortTag<T> (chooses between full and partial vectors).
 // `st` is SharedTraits<Traits*<Order*>>. This abstraction layer bridges
 //   differences in sort order and single-lane vs 128-bit keys.
 template <class D, class Traits, typename T>
 void Sort(D d, Traits st, T* HWY_RESTRICT keys, size_t num,
-          T* HWY_RESTRICT buf) {
-    
-    // added by Arif 
-    // memset(detail::dist, 0, sizeof(uint64_t) * 1025);
-    // memset(detail::count_at_depth, 0, sizeof(uint64_t) * 1025);
-    detail::max_depth = -1;
-    detail::depth = 0;
-    // detail::heap_sort = 0;
-      
+          T* HWY_RESTRICT buf, bool detect_presorted = false,
+          SortStats* stats = nullptr, const SortTuning* tuning = nullptr) {
+  const SortTuning& used = tuning ? *tuning : Sorter::Tuning();
+  if (HWY_UNLIKELY(stats != nullptr)) {
+    detail::StatsRecorder recorder(*stats);
+    return detail::SortImpl(d, st, keys, num, buf, used, detect_presorted,
+                            recorder);
+  }
+  detail::NoStats no_stats;
+  detail::SortImpl(d, st, keys, num, buf, used, detect_presorted, no_stats);
+}
+
+// Sorts each segment of keys[offsets[s], offsets[s + 1]) for s < num_segments;
+// `offsets` has num_segments + 1 non-decreasing entries. Unlike `num` in Sort,
+// these count keys, not lanes, so that the same offsets can index an array of
+// 128-bit keys. Equivalent to calling Sort for each segment, but amortizes the
+// dispatch and buffer setup over all segments, which matters when they are
+// small: segments of up to Constants::BaseCaseNum lanes are sorted by a single
+// sorting network.
+template <class D, class Traits, typename T>
+void SortSegments(D d, Traits st, T* HWY_RESTRICT keys,
+                  const size_t* HWY_RESTRICT offsets, size_t num_segments,
+                  T* HWY_RESTRICT buf) {
+#if VQSORT_ENABLED || HWY_IDE
+#if !HWY_HAVE_SCALABLE
+  // As in SortImpl, but set up only once for all segments.
+  HWY_ALIGN T storage[SortConstants::BufNum<T>(HWY_LANES(T))];
+  buf = detail::StackBufUnlessProvided(buf, storage);
+#endif  // !HWY_HAVE_SCALABLE
+
+  detail::NoStats no_stats;
+  const SortTuning& tuning = Sorter::Tuning();
+  constexpr size_t N1 = st.LanesPerKey();
+  for (size_t s = 0; s < num_segments; ++s) {
+    const size_t num_keys = offsets[s + 1] - offsets[s];
+    if (num_keys < 2) continue;
+    detail::SortWithBuf(d, st, keys + offsets[s] * N1, num_keys * N1, buf,
+                        tuning, /*detect_presorted=*/false, no_stats);
+  }
+#else
+  (void)d;
+  (void)buf;
+  constexpr size_t N1 = st.LanesPerKey();
+  for (size_t s = 0; s < num_segments; ++s) {
+    // PERFORMANCE WARNING: vqsort is not enabled for the non-SIMD target
+    detail::HeapSort(st, keys + offsets[s] * N1,
+                     (offsets[s + 1] - offsets[s]) * N1);
+  }
+#endif  // VQSORT_ENABLED
+}
+
+// Sorts 8-bit `keys[0..num-1]`. `d` and `st` are for the 16-bit type that
+// small inputs are widened to, so that they can use the sorting networks.
+// Larger inputs are sorted by counting the keys, which is faster than any
+// comparison sort because there are at most 256 distinct keys.
+template <class D, class Traits, typename T>
+void Sort8(D d, Traits st, T* HWY_RESTRICT keys, size_t num,
+           TFromD<D>* HWY_RESTRICT buf) {
+  using TW = TFromD<D>;
+  static_assert(sizeof(T) == 1 && sizeof(TW) == 2, "Expected 8-bit keys");
+  static_assert(IsSigned<T>() == IsSigned<TW>(), "Widening changes order");
+  constexpr size_t kMaxWiden =
+      SortConstants::kMaxRows * SortConstants::kMaxCols;
+  if (num > kMaxWiden) {
+    return detail::CountingSort8(keys, num, typename Traits::Order());
+  }
+
+  HWY_ALIGN TW widened[kMaxWiden];
+  for (size_t i = 0; i < num; ++i) {
+    widened[i] = keys[i];
+  }
+  Sort(d, st, widened, num, buf);
+  for (size_t i = 0; i < num; ++i) {
+    keys[i] = static_cast<T>(widened[i]);
+  }
+}
+
+// Rearranges keys[0, num) such that keys[0, k) are the first `k` lanes in
+// sort order, and sorted. The order of keys[k, num) is unspecified. This only
+// recurses into the partitions before `k` and thus requires O(num + k log k)
+// time in expectation. `k` must be a multiple of `st.LanesPerKey()`.
+template <class D, class Traits, typename T>
+void PartialSort(D d, Traits st, T* HWY_RESTRICT keys, size_t num, size_t k,
+                 T* HWY_RESTRICT buf) {
+  if (k >= num) return Sort(d, st, keys, num, buf);
+  if (k == 0) return;
 #if VQSORT_ENABLED || HWY_IDE
 #if !HWY_HAVE_SCALABLE
-  // On targets with fixed-size vectors, avoid _using_ the allocated memory.
-  // We avoid (potentially expensive for small input sizes) allocations on
-  // platforms where no targets are scalable. For 512-bit vectors, this fits on
-  // the stack (several KiB).
-  HWY_ALIGN T storage[SortConstants::BufNum<T>(HWY_LANES(T))] = {};
+  // See Sort.
+  HWY_ALIGN T storage[SortConstants::BufNum<T>(HWY_LANES(T))];
   static_assert(sizeof(storage) <= 8192, "Unexpectedly large, check size");
-  buf = storage;
+  buf = detail::StackBufUnlessProvided(buf, storage);
 #endif  // !HWY_HAVE_SCALABLE
 
+  // See SortWithBuf.
+  if (detail::IsHugeVector(d)) {
+    return PartialSort(CappedTag<T, detail::kMaxSortLanes>(), st, keys, num, k,
+                       buf);
+  }
+  if (detail::IsTooSmallForKey(d, st)) {
+    return PartialSort(CappedTag<T, 16 / sizeof(T)>(), st, keys, num, k, buf);
+  }
   if (detail::HandleSpecialCases(d, st, keys, num, buf)) return;
 
-#if HWY_MAX_BYTES > 64
-  // sorting_networks-inl and traits assume no more than 512 bit vectors.
-  if (Lanes(d) > 64 / sizeof(T)) {
-    return Sort(CappedTag<T, 64 / sizeof(T)>(), st, keys, num, buf);
+  detail::Generator rng(keys, num);
+  // Introspection: switch to worst-case N*logN heapsort after this many.
+  const size_t max_levels = 2 * hwy::CeilLog2(num) + 4;
+  detail::SelectRange(d, st, keys, num, k, /*sort_prefix=*/true, buf,
+                      Sorter::Tuning(), rng, max_levels);
+#else
+  (void)d;
+  (void)buf;
+  // PERFORMANCE WARNING: vqsort is not enabled for the non-SIMD target
+  return detail::HeapSort(st, keys, num);
+#endif  // VQSORT_ENABLED
+}
+
+// Rearranges keys[0, num) such that keys[k] is the key that would be there if
+// keys were sorted, keys before it are not greater (in sort order) and those
+// after it are not less. Same as std::nth_element, but vectorized; requires
+// O(num) time in expectation and O(num log num) in the worst case. `k` must be
+// a multiple of `st.LanesPerKey()`.
+template <class D, class Traits, typename T>
+void Select(D d, Traits st, T* HWY_RESTRICT keys, size_t num, size_t k,
+            T* HWY_RESTRICT buf) {
+  if (k >= num) return;
+#if VQSORT_ENABLED || HWY_IDE
+#if !HWY_HAVE_SCALABLE
+  // See Sort.
+  HWY_ALIGN T storage[SortConstants::BufNum<T>(HWY_LANES(T))];
+  static_assert(sizeof(storage) <= 8192, "Unexpectedly large, check size");
+  buf = detail::StackBufUnlessProvided(buf, storage);
+#endif  // !HWY_HAVE_SCALABLE
+
+  // See SortWithBuf.
+  if (detail::IsHugeVector(d)) {
+    return Select(CappedTag<T, detail::kMaxSortLanes>(), st, keys, num, k, buf);
+  }
+  if (detail::IsTooSmallForKey(d, st)) {
+    return Select(CappedTag<T, 16 / sizeof(T)>(), st, keys, num, k, buf);
   }
-#endif  // HWY_MAX_BYTES > 64
+  if (detail::HandleSpecialCases(d, st, keys, num, buf)) return;
 
-  // Pulled out of the recursion so we can special-case degenerate partitions.
   detail::Generator rng(keys, num);
-  const Vec<D> pivot = detail::ChoosePivot(d, st, keys, 0, num, buf, rng);
-
   // Introspection: switch to worst-case N*logN heapsort after this many.
   const size_t max_levels = 2 * hwy::CeilLog2(num) + 4;
-
-  detail::Recurse(d, st, keys, keys + num, 0, num, pivot, buf, rng, max_levels);
+  detail::SelectRange(d, st, keys, num, k, /*sort_prefix=*/false, buf,
+                      Sorter::Tuning(), rng, max_levels);
 #else
   (void)d;
   (void)buf;
   // PERFORMANCE WARNING: vqsort is not enabled for the non-SIMD target
   return detail::HeapSort(st, keys, num);
 #endif  // VQSORT_ENABLED
+}
 
-  // printf("Max depth: %d\n", detail::max_depth);
-  //for (int i = 0; i <= detail::max_depth; ++i) printf("%d: %llu\n", i, detail::dist[i]);
-  //for (int i = 0; i <= detail::max_depth; ++i) printf("%d: %llu\n", i, detail::count_at_depth[i]);
-  //printf("Sorted with heapsort: %llu\n", detail::heap_sort);
+// Same as Sort, but uses up to all threads of `pool`. The top levels of the
+// recursion partition each subarray in parallel (ParallelPartition); the
+// resulting independent subranges are then sorted as tasks, largest first.
+// Allocates O(threads) memory. Small inputs are sorted on the calling thread.
+template <class D, class Traits, typename T>
+void SortParallel(D d, Traits st, T* HWY_RESTRICT keys, size_t num,
+                  ThreadPool& pool) {
+  constexpr size_t N1 = st.LanesPerKey();
+  const size_t min_lanes = detail::kMinParallelBytes / sizeof(T);
+  const size_t max_threads =
+      HWY_MAX(size_t{1}, HWY_MIN(pool.NumThreads(), num / min_lanes));
+#if VQSORT_ENABLED || HWY_IDE
+  // See SortWithBuf.
+  if (detail::IsHugeVector(d)) {
+    return SortParallel(CappedTag<T, detail::kMaxSortLanes>(), st, keys, num,
+                        pool);
+  }
+  if (detail::IsTooSmallForKey(d, st)) {
+    return SortParallel(CappedTag<T, 16 / sizeof(T)>(), st, keys, num, pool);
+  }
+  const size_t buf_num = RoundUpTo(SortConstants::BufNum<T>(Lanes(d)),
+                                   HWY_ALIGNMENT / sizeof(T));
+  // One buffer per thread plus one for the pivot (see ParallelPartition).
+  auto bufs = hwy::AllocateAligned<T>((max_threads + 1) * buf_num);
+  HWY_ASSERT(bufs);
+#if HWY_IS_MSAN  // See StackBufUnlessProvided.
+  memset(bufs.get(), 0, (max_threads + 1) * buf_num * sizeof(T));
+#endif
+  T* HWY_RESTRICT buf = bufs.get();
+
+  if (max_threads == 1) return Sort(d, st, keys, num, buf);
+  if (detail::HandleSpecialCases(d, st, keys, num, buf)) return;
+
+  const SortTuning& tuning = Sorter::Tuning();
+  detail::Generator rng(keys, num);
+  const size_t max_levels = 2 * hwy::CeilLog2(num) + 4;
+
+  // Ranges larger than this are partitioned by all threads together.
+  const size_t task_lanes = RoundUpTo(
+      HWY_MAX(num / (detail::kTasksPerThread * max_threads), min_lanes), N1);
+
+  std::vector<detail::SortTask> tasks;
+  std::vector<detail::SortTask> pending;
+  pending.push_back({0, num, max_levels, 0});
+  while (!pending.empty()) {
+    detail::SortTask task = pending.back();
+    pending.pop_back();
+    if (task.end - task.begin <= task_lanes || task.remaining_levels == 0) {
+      task.seed = rng();
+      tasks.push_back(task);
+      continue;
+    }
+
+    const Vec<D> pivot = detail::ChoosePivot(d, st, keys, task.begin, task.end,
+                                             buf, tuning, rng);
+    size_t bound =
+        detail::ParallelPartition(d, st, keys, task.begin, task.end, pivot,
+                                  buf, buf_num, tuning, max_threads, pool);
+    size_t remaining_levels = task.remaining_levels - 1;
+    // Degenerate partition: same handling as in Recurse.
+    if (HWY_UNLIKELY(bound == task.end)) {
+      Vec<D> first, last;
+      detail::ScanMinMax(d, st, keys + task.begin, task.end - task.begin, buf,
+                         first, last);
+      if (AllTrue(d, st.EqualKeys(d, first, last))) continue;
+      if (remaining_levels == 0) {
+        tasks.push_back({task.begin, task.end, 0, rng()});
+        continue;
+      }
+      // Both sides are non-empty because `first` is the minimum.
+      bound = detail::ParallelPartition(d, st, keys, task.begin, task.end,
+                                        first, buf, buf_num, tuning,
+                                        max_threads, pool);
+      --remaining_levels;
+    }
+    pending.push_back({task.begin, bound, remaining_levels, 0});
+    pending.push_back({bound, task.end, remaining_levels, 0});
+  }
+
+  // Largest first, so that the last tasks to finish are short.
+  std::sort(tasks.begin(), tasks.end(),
+            [](const detail::SortTask& a, const detail::SortTask& b) {
+              return a.end - a.begin > b.end - b.begin;
+            });
+  std::atomic<size_t> next_task{0};
+  pool.RunOnThreads(max_threads, [&](size_t thread) {
+    T* HWY_RESTRICT thread_buf = bufs.get() + thread * buf_num;
+    for (;;) {
+      const size_t i = next_task.fetch_add(1, std::memory_order_relaxed);
+      if (i >= tasks.size()) break;
+      detail::SortTaskRange(d, st, keys, tasks[i], thread_buf, tuning);
+    }
+  });
+#else
+  (void)d;
+  (void)N1;
+  (void)max_threads;
+  (void)pool;
+  // PERFORMANCE WARNING: vqsort is not enabled for the non-SIMD target
+  return detail::HeapSort(st, keys, num);
+#endif  // VQSORT_ENABLED
+}
+
+// Writes the merge of the sorted lanes a[0, na) and b[0, nb) to out[0, na +
+// nb), which must not overlap them. `na` and `nb` must be multiples of
+// `st.LanesPerKey()`. Not stable: the order of equal keys is unspecified.
+// Vectorized via bitonic merge networks of two vectors; the vector size is
+// capped to that of the sorting networks, hence `d` only determines `T`.
+template <class D, class Traits, typename T>
+void Merge(D d, Traits st, const T* HWY_RESTRICT a, size_t na,
+           const T* HWY_RESTRICT b, size_t nb, T* HWY_RESTRICT out) {
+  (void)d;
+#if VQSORT_ENABLED || HWY_IDE
+  detail::MergeRuns(st, a, na, b, nb, out);
+#else
+  // PERFORMANCE WARNING: vqsort is not enabled for the non-SIMD target
+  detail::MergeScalar(st, a, na, b, nb, out);
+#endif  // VQSORT_ENABLED
 }
 
 // NOLINTNEXTLINE(google-readability-namespace-comments)
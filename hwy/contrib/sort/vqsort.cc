@@ -120,26 +120,47 @@ Sorter::Sorter() {
 #if VQSORT_STACK
   ptr_ = nullptr;  // Sort will use stack storage instead
 #else
+  const size_t bytes = ScratchBytes();
+  ptr_ = hwy::AllocateAlignedBytes(bytes, nullptr, nullptr);
+  HWY_ASSERT(ptr_ != nullptr);
+  owns_ptr_ = true;
+
+  // Prevent msan errors by initializing.
+  memset(ptr_, 0, bytes);
+#endif
+}
+
+Sorter::Sorter(void* scratch, size_t bytes) : ptr_(scratch) {
+  HWY_ASSERT(bytes >= ScratchBytes());
+  HWY_ASSERT(reinterpret_cast<uintptr_t>(scratch) % HWY_ALIGNMENT == 0);
+#if HWY_IS_MSAN
+  memset(scratch, 0, bytes);
+#endif
+}
+
+Sorter::Sorter(AllocPtr alloc, FreePtr free, void* opaque)
+    : free_(free), opaque_(opaque) {
+  const size_t bytes = ScratchBytes();
+  ptr_ = hwy::AllocateAlignedBytes(bytes, alloc, opaque);
+  HWY_ASSERT(ptr_ != nullptr);
+  owns_ptr_ = true;
+  memset(ptr_, 0, bytes);  // See Sorter().
+}
+
+size_t Sorter::ScratchBytes() {
   // Determine the largest buffer size required for any type by trying them all.
   // (The capping of N in BaseCaseNum means that smaller N but larger sizeof_t
   // may require a larger buffer.)
   const size_t vector_size = HWY_DYNAMIC_DISPATCH(VectorSize)();
-  const size_t max_bytes =
-      HWY_MAX(HWY_MAX(SortConstants::BufBytes<uint16_t>(vector_size),
-                      SortConstants::BufBytes<uint32_t>(vector_size)),
-              SortConstants::BufBytes<uint64_t>(vector_size));
-  ptr_ = hwy::AllocateAlignedBytes(max_bytes, nullptr, nullptr);
-
-  // Prevent msan errors by initializing.
-  memset(ptr_, 0, max_bytes);
-#endif
+  return HWY_MAX(HWY_MAX(SortConstants::BufBytes<uint16_t>(vector_size),
+                         SortConstants::BufBytes<uint32_t>(vector_size)),
+                 SortConstants::BufBytes<uint64_t>(vector_size));
 }
 
 void Sorter::Delete() {
-#if !VQSORT_STACK
-  FreeAlignedBytes(ptr_, nullptr, nullptr);
+  if (owns_ptr_) FreeAlignedBytes(ptr_, free_, opaque_);
   ptr_ = nullptr;
-#endif
+  owns_ptr_ = false;
 }
 
 #if !VQSORT_SECURE_RNG
@@ -24,10 +24,13 @@
 #ifndef HIGHWAY_HWY_CONTRIB_SORT_VQSORT_H_
 #define HIGHWAY_HWY_CONTRIB_SORT_VQSORT_H_
 
+#include "hwy/aligned_allocator.h"  // AllocPtr
 #include "hwy/base.h"
 
 namespace hwy {
 
+class ThreadPool;  // hwy/contrib/sort/thread_pool.h
+
 // Tag arguments that determine the sort order.
 struct SortAscending {
   constexpr bool IsAscending() const { return true; }
@@ -36,30 +39,132 @@ struct SortDescending {
   constexpr bool IsAscending() const { return false; }
 };
 
+// Statistics about the recursion of Sorter::operator(), for analyzing inputs
+// and tuning. Each call that receives a SortStats adds to it, so callers can
+// accumulate over several sorts or Reset in between. Not synchronized: use one
+// instance per thread.
+struct SortStats {
+  // Deeper recursion levels are attributed to the last entry.
+  static constexpr size_t kMaxDepth = 64;
+
+  void Reset() { *this = SortStats(); }
+
+  // Number of partitions, and the total number of keys they processed, per
+  // recursion depth. Depth 0 is the entire input.
+  uint64_t partitions[kMaxDepth] = {};
+  uint64_t keys_at_depth[kMaxDepth] = {};
+  size_t max_depth = 0;
+
+  // Partitions that did not move any keys because the pivot was the first or
+  // last key in sort order.
+  uint64_t degenerate = 0;
+  // Partitions that also separated keys equal to the pivot because it was
+  // frequent in the sample.
+  uint64_t three_way = 0;
+  // HeapSort calls, e.g. due to too many degenerate partitions.
+  uint64_t heap_sorts = 0;
+  // Sorting network calls for small (sub)arrays.
+  uint64_t base_cases = 0;
+  // Inputs sorted by radix sort instead of partitioning; see radix-inl.h.
+  uint64_t radix_sorts = 0;
+  // Inputs distributed into buckets by samplesort; see samplesort-inl.h.
+  uint64_t sample_sorts = 0;
+};
+
+// Parameters that affect the speed, but not the result, of all sorts in this
+// process. The defaults were chosen on Skylake-X; Sorter::Autotune measures
+// which of the supported values are fastest on the current machine.
+struct SortTuning {
+  // Partitions of up to this many vectors (times the number of keys per
+  // vector, capped at 16) are sorted by a sorting network: 4, 8 or 16. Inputs
+  // of up to 16 vectors always are.
+  uint32_t base_case_rows = 16;
+  // Vectors per iteration of the partition loop: 2 or 4.
+  uint32_t partition_unroll = 4;
+  // Cache lines sampled for choosing each pivot: 3 or 9.
+  uint32_t pivot_chunks = 9;
+  // 1 to stage the output of partitioning in blocks of cache lines and write
+  // whole lines (see BlockWriter in vqsort-inl.h), or 0 to store directly.
+  // Blocks avoid partial and misaligned writes, but cost an extra copy; they
+  // were slower on Skylake-X for all sizes. Ignored unless the library is
+  // compiled with VQSORT_BLOCK_PARTITION=1.
+  uint32_t block_partition = 0;
+  // Partitions of at least this many MiB, up to 2^20 (1 TiB), stage their
+  // output and write it with non-temporal stores (see BlockWriter in
+  // vqsort-inl.h), or 0 to disable. This avoids reading destination lines for
+  // ownership, but costs an extra copy; it was slower on Skylake-X even for
+  // 1 GiB, hence off by default. Ignored unless the library is compiled with
+  // VQSORT_STREAM_PARTITION=1.
+  uint32_t stream_partition_mib = 0;
+  // If nonzero, Sort radix sorts inputs of at least 128Ki 32/64-bit integer
+  // keys instead of partitioning them, if a sample predicts at most this many
+  // passes over 8-bit digits (see radix-inl.h). This allocates O(n) scratch
+  // space, hence it is off by default. Measured on Skylake-X for 256Ki-4Mi
+  // keys: faster only for 64-bit keys with up to 2 passes on AVX2, up to 3
+  // (32-bit) or 4 (64-bit) on SSE4 and all digits on SSSE3, never on AVX-512.
+  uint32_t radix_max_passes = 0;
+
+  bool IsValid() const {
+    return (base_case_rows == 4 || base_case_rows == 8 ||
+            base_case_rows == 16) &&
+           (partition_unroll == 2 || partition_unroll == 4) &&
+           (pivot_chunks == 3 || pivot_chunks == 9) && block_partition <= 1 &&
+           stream_partition_mib <= (1u << 20) && radix_max_passes <= 8;
+  }
+};
+
 // Allocates O(1) space. Type-erased RAII wrapper over hwy/aligned_allocator.h.
 // This allows amortizing the allocation over multiple sorts.
 class HWY_CONTRIB_DLLEXPORT Sorter {
  public:
+  // On platforms with only fixed-size vectors (e.g. x86), does not allocate:
+  // each call then uses an uninitialized stack buffer of up to 8 KiB.
+  // Otherwise (e.g. SVE, RVV), allocates ScratchBytes() via
+  // AllocateAlignedBytes.
   Sorter();
+
+  // Uses the caller-owned scratch[0, bytes) instead of allocating, on all
+  // platforms. `scratch` must be aligned to HWY_ALIGNMENT, at least
+  // ScratchBytes() in size and outlive this Sorter; it is not initialized.
+  // Construction is free, hence this also serves as a per-call variant:
+  // Sorter(scratch, bytes)(keys, n, SortAscending()).
+  Sorter(void* scratch, size_t bytes);
+
+  // Allocates ScratchBytes() via `alloc` and releases it via `free`, both of
+  // which receive `opaque` (see hwy/aligned_allocator.h), e.g. for arenas.
+  Sorter(AllocPtr alloc, FreePtr free, void* opaque);
+
   ~Sorter() { Delete(); }
 
   // Move-only
   Sorter(const Sorter&) = delete;
   Sorter& operator=(const Sorter&) = delete;
-  Sorter(Sorter&& other) {
-    Delete();
-    ptr_ = other.ptr_;
-    other.ptr_ = nullptr;
-  }
+  Sorter(Sorter&& other) { MoveFrom(other); }
   Sorter& operator=(Sorter&& other) {
     Delete();
-    ptr_ = other.ptr_;
-    other.ptr_ = nullptr;
+    MoveFrom(other);
     return *this;
   }
 
+  // Minimum size of the scratch memory passed to the constructor, for the
+  // best available instruction set.
+  static size_t ScratchBytes();
+
+  // If enabled, operator() without a ThreadPool first checks whether the keys
+  // are already sorted or in reverse order (which takes O(n) time), or begin
+  // with such a run of at least n/2 keys. In the latter case, only the rest is
+  // sorted and then merged with the run, which allocates O(n) memory. The check
+  // stops at the first out-of-order key, so it is cheap for other inputs.
+  // Disabled by default. Not used for 8-bit keys.
+  void SetDetectPresorted(bool detect) { detect_presorted_ = detect; }
+  bool DetectPresorted() const { return detect_presorted_; }
+
   // Sorts keys[0, n). Dispatches to the best available instruction set,
-  // and does not allocate memory.
+  // and does not allocate memory unless SortTuning::radix_max_passes is
+  // nonzero. Large arrays of 8-bit keys are sorted by counting the occurrences
+  // of each key, which takes O(n) time.
+  void operator()(uint8_t* HWY_RESTRICT keys, size_t n, SortAscending) const;
+  void operator()(uint8_t* HWY_RESTRICT keys, size_t n, SortDescending) const;
   void operator()(uint16_t* HWY_RESTRICT keys, size_t n, SortAscending) const;
   void operator()(uint16_t* HWY_RESTRICT keys, size_t n, SortDescending) const;
   void operator()(uint32_t* HWY_RESTRICT keys, size_t n, SortAscending) const;
@@ -67,6 +172,8 @@ class HWY_CONTRIB_DLLEXPORT Sorter {
   void operator()(uint64_t* HWY_RESTRICT keys, size_t n, SortAscending) const;
   void operator()(uint64_t* HWY_RESTRICT keys, size_t n, SortDescending) const;
 
+  void operator()(int8_t* HWY_RESTRICT keys, size_t n, SortAscending) const;
+  void operator()(int8_t* HWY_RESTRICT keys, size_t n, SortDescending) const;
   void operator()(int16_t* HWY_RESTRICT keys, size_t n, SortAscending) const;
   void operator()(int16_t* HWY_RESTRICT keys, size_t n, SortDescending) const;
   void operator()(int32_t* HWY_RESTRICT keys, size_t n, SortAscending) const;
@@ -74,6 +181,16 @@ class HWY_CONTRIB_DLLEXPORT Sorter {
   void operator()(int64_t* HWY_RESTRICT keys, size_t n, SortAscending) const;
   void operator()(int64_t* HWY_RESTRICT keys, size_t n, SortDescending) const;
 
+  // 16-bit floats are ordered according to IEEE 754 totalOrder: -0 precedes
+  // +0, and NaN with the sign bit set (clear) precede (follow) all others.
+  void operator()(float16_t* HWY_RESTRICT keys, size_t n, SortAscending) const;
+  void operator()(float16_t* HWY_RESTRICT keys, size_t n,
+                  SortDescending) const;
+  void operator()(bfloat16_t* HWY_RESTRICT keys, size_t n,
+                  SortAscending) const;
+  void operator()(bfloat16_t* HWY_RESTRICT keys, size_t n,
+                  SortDescending) const;
+
   void operator()(float* HWY_RESTRICT keys, size_t n, SortAscending) const;
   void operator()(float* HWY_RESTRICT keys, size_t n, SortDescending) const;
   void operator()(double* HWY_RESTRICT keys, size_t n, SortAscending) const;
@@ -85,6 +202,533 @@ class HWY_CONTRIB_DLLEXPORT Sorter {
   void operator()(K64V64* HWY_RESTRICT keys, size_t n, SortAscending) const;
   void operator()(K64V64* HWY_RESTRICT keys, size_t n, SortDescending) const;
 
+  // Sorts by the upper 32 bits (key) of each 64-bit lane.
+  void operator()(K32V32* HWY_RESTRICT keys, size_t n, SortAscending) const;
+  void operator()(K32V32* HWY_RESTRICT keys, size_t n, SortDescending) const;
+
+  // Same as above, but uses all threads of `pool` (if worthwhile for this `n`)
+  // for partitioning and then sorting the resulting subarrays. Allocates
+  // O(pool.NumThreads()) memory. Not reentrant: do not call from a task that
+  // is running on the same `pool`.
+  void operator()(uint16_t* HWY_RESTRICT keys, size_t n, SortAscending,
+                  ThreadPool& pool) const;
+  void operator()(uint16_t* HWY_RESTRICT keys, size_t n, SortDescending,
+                  ThreadPool& pool) const;
+  void operator()(uint32_t* HWY_RESTRICT keys, size_t n, SortAscending,
+                  ThreadPool& pool) const;
+  void operator()(uint32_t* HWY_RESTRICT keys, size_t n, SortDescending,
+                  ThreadPool& pool) const;
+  void operator()(uint64_t* HWY_RESTRICT keys, size_t n, SortAscending,
+                  ThreadPool& pool) const;
+  void operator()(uint64_t* HWY_RESTRICT keys, size_t n, SortDescending,
+                  ThreadPool& pool) const;
+  void operator()(int16_t* HWY_RESTRICT keys, size_t n, SortAscending,
+                  ThreadPool& pool) const;
+  void operator()(int16_t* HWY_RESTRICT keys, size_t n, SortDescending,
+                  ThreadPool& pool) const;
+  void operator()(int32_t* HWY_RESTRICT keys, size_t n, SortAscending,
+                  ThreadPool& pool) const;
+  void operator()(int32_t* HWY_RESTRICT keys, size_t n, SortDescending,
+                  ThreadPool& pool) const;
+  void operator()(int64_t* HWY_RESTRICT keys, size_t n, SortAscending,
+                  ThreadPool& pool) const;
+  void operator()(int64_t* HWY_RESTRICT keys, size_t n, SortDescending,
+                  ThreadPool& pool) const;
+  void operator()(float* HWY_RESTRICT keys, size_t n, SortAscending,
+                  ThreadPool& pool) const;
+  void operator()(float* HWY_RESTRICT keys, size_t n, SortDescending,
+                  ThreadPool& pool) const;
+  void operator()(double* HWY_RESTRICT keys, size_t n, SortAscending,
+                  ThreadPool& pool) const;
+  void operator()(double* HWY_RESTRICT keys, size_t n, SortDescending,
+                  ThreadPool& pool) const;
+  void operator()(uint128_t* HWY_RESTRICT keys, size_t n, SortAscending,
+                  ThreadPool& pool) const;
+  void operator()(uint128_t* HWY_RESTRICT keys, size_t n, SortDescending,
+                  ThreadPool& pool) const;
+  void operator()(K64V64* HWY_RESTRICT keys, size_t n, SortAscending,
+                  ThreadPool& pool) const;
+  void operator()(K64V64* HWY_RESTRICT keys, size_t n, SortDescending,
+                  ThreadPool& pool) const;
+  void operator()(K32V32* HWY_RESTRICT keys, size_t n, SortAscending,
+                  ThreadPool& pool) const;
+  void operator()(K32V32* HWY_RESTRICT keys, size_t n, SortDescending,
+                  ThreadPool& pool) const;
+
+  // Same as above, but also adds statistics about the recursion to `stats`.
+  // The overloads without `stats` do not pay for recording them.
+  void operator()(uint16_t* HWY_RESTRICT keys, size_t n, SortAscending,
+                  SortStats& stats) const;
+  void operator()(uint16_t* HWY_RESTRICT keys, size_t n, SortDescending,
+                  SortStats& stats) const;
+  void operator()(uint32_t* HWY_RESTRICT keys, size_t n, SortAscending,
+                  SortStats& stats) const;
+  void operator()(uint32_t* HWY_RESTRICT keys, size_t n, SortDescending,
+                  SortStats& stats) const;
+  void operator()(uint64_t* HWY_RESTRICT keys, size_t n, SortAscending,
+                  SortStats& stats) const;
+  void operator()(uint64_t* HWY_RESTRICT keys, size_t n, SortDescending,
+                  SortStats& stats) const;
+  void operator()(int16_t* HWY_RESTRICT keys, size_t n, SortAscending,
+                  SortStats& stats) const;
+  void operator()(int16_t* HWY_RESTRICT keys, size_t n, SortDescending,
+                  SortStats& stats) const;
+  void operator()(int32_t* HWY_RESTRICT keys, size_t n, SortAscending,
+                  SortStats& stats) const;
+  void operator()(int32_t* HWY_RESTRICT keys, size_t n, SortDescending,
+                  SortStats& stats) const;
+  void operator()(int64_t* HWY_RESTRICT keys, size_t n, SortAscending,
+                  SortStats& stats) const;
+  void operator()(int64_t* HWY_RESTRICT keys, size_t n, SortDescending,
+                  SortStats& stats) const;
+  void operator()(float* HWY_RESTRICT keys, size_t n, SortAscending,
+                  SortStats& stats) const;
+  void operator()(float* HWY_RESTRICT keys, size_t n, SortDescending,
+                  SortStats& stats) const;
+  void operator()(double* HWY_RESTRICT keys, size_t n, SortAscending,
+                  SortStats& stats) const;
+  void operator()(double* HWY_RESTRICT keys, size_t n, SortDescending,
+                  SortStats& stats) const;
+  void operator()(uint128_t* HWY_RESTRICT keys, size_t n, SortAscending,
+                  SortStats& stats) const;
+  void operator()(uint128_t* HWY_RESTRICT keys, size_t n, SortDescending,
+                  SortStats& stats) const;
+  void operator()(K64V64* HWY_RESTRICT keys, size_t n, SortAscending,
+                  SortStats& stats) const;
+  void operator()(K64V64* HWY_RESTRICT keys, size_t n, SortDescending,
+                  SortStats& stats) const;
+  void operator()(K32V32* HWY_RESTRICT keys, size_t n, SortAscending,
+                  SortStats& stats) const;
+  void operator()(K32V32* HWY_RESTRICT keys, size_t n, SortDescending,
+                  SortStats& stats) const;
+
+  // Rearranges keys[0, n) such that keys[0, k) are the first `k` keys in sort
+  // order, and sorted. The order of keys[k, n) is unspecified. Requires
+  // O(n + k log k) time on average, versus O(n log n) for a full sort.
+  // Dispatches to the best available instruction set, and does not allocate.
+  void PartialSort(uint16_t* HWY_RESTRICT keys, size_t n, size_t k,
+                   SortAscending) const;
+  void PartialSort(uint16_t* HWY_RESTRICT keys, size_t n, size_t k,
+                   SortDescending) const;
+  void PartialSort(uint32_t* HWY_RESTRICT keys, size_t n, size_t k,
+                   SortAscending) const;
+  void PartialSort(uint32_t* HWY_RESTRICT keys, size_t n, size_t k,
+                   SortDescending) const;
+  void PartialSort(uint64_t* HWY_RESTRICT keys, size_t n, size_t k,
+                   SortAscending) const;
+  void PartialSort(uint64_t* HWY_RESTRICT keys, size_t n, size_t k,
+                   SortDescending) const;
+  void PartialSort(int16_t* HWY_RESTRICT keys, size_t n, size_t k,
+                   SortAscending) const;
+  void PartialSort(int16_t* HWY_RESTRICT keys, size_t n, size_t k,
+                   SortDescending) const;
+  void PartialSort(int32_t* HWY_RESTRICT keys, size_t n, size_t k,
+                   SortAscending) const;
+  void PartialSort(int32_t* HWY_RESTRICT keys, size_t n, size_t k,
+                   SortDescending) const;
+  void PartialSort(int64_t* HWY_RESTRICT keys, size_t n, size_t k,
+                   SortAscending) const;
+  void PartialSort(int64_t* HWY_RESTRICT keys, size_t n, size_t k,
+                   SortDescending) const;
+  void PartialSort(float* HWY_RESTRICT keys, size_t n, size_t k,
+                   SortAscending) const;
+  void PartialSort(float* HWY_RESTRICT keys, size_t n, size_t k,
+                   SortDescending) const;
+  void PartialSort(double* HWY_RESTRICT keys, size_t n, size_t k,
+                   SortAscending) const;
+  void PartialSort(double* HWY_RESTRICT keys, size_t n, size_t k,
+                   SortDescending) const;
+  void PartialSort(uint128_t* HWY_RESTRICT keys, size_t n, size_t k,
+                   SortAscending) const;
+  void PartialSort(uint128_t* HWY_RESTRICT keys, size_t n, size_t k,
+                   SortDescending) const;
+  void PartialSort(K64V64* HWY_RESTRICT keys, size_t n, size_t k,
+                   SortAscending) const;
+  void PartialSort(K64V64* HWY_RESTRICT keys, size_t n, size_t k,
+                   SortDescending) const;
+  void PartialSort(K32V32* HWY_RESTRICT keys, size_t n, size_t k,
+                   SortAscending) const;
+  void PartialSort(K32V32* HWY_RESTRICT keys, size_t n, size_t k,
+                   SortDescending) const;
+
+  // Rearranges keys[0, n) such that keys[nth] is the key that would be there
+  // if keys were sorted, and no key before (after) it is greater (less) in sort
+  // order. Same semantics as std::nth_element; requires O(n) time on average
+  // and O(n log n) in the worst case. Does nothing if nth >= n. Dispatches to
+  // the best available instruction set, and does not allocate.
+  void Select(uint16_t* HWY_RESTRICT keys, size_t n, size_t nth,
+              SortAscending) const;
+  void Select(uint16_t* HWY_RESTRICT keys, size_t n, size_t nth,
+              SortDescending) const;
+  void Select(uint32_t* HWY_RESTRICT keys, size_t n, size_t nth,
+              SortAscending) const;
+  void Select(uint32_t* HWY_RESTRICT keys, size_t n, size_t nth,
+              SortDescending) const;
+  void Select(uint64_t* HWY_RESTRICT keys, size_t n, size_t nth,
+              SortAscending) const;
+  void Select(uint64_t* HWY_RESTRICT keys, size_t n, size_t nth,
+              SortDescending) const;
+  void Select(int16_t* HWY_RESTRICT keys, size_t n, size_t nth,
+              SortAscending) const;
+  void Select(int16_t* HWY_RESTRICT keys, size_t n, size_t nth,
+              SortDescending) const;
+  void Select(int32_t* HWY_RESTRICT keys, size_t n, size_t nth,
+              SortAscending) const;
+  void Select(int32_t* HWY_RESTRICT keys, size_t n, size_t nth,
+              SortDescending) const;
+  void Select(int64_t* HWY_RESTRICT keys, size_t n, size_t nth,
+              SortAscending) const;
+  void Select(int64_t* HWY_RESTRICT keys, size_t n, size_t nth,
+              SortDescending) const;
+  void Select(float* HWY_RESTRICT keys, size_t n, size_t nth,
+              SortAscending) const;
+  void Select(float* HWY_RESTRICT keys, size_t n, size_t nth,
+              SortDescending) const;
+  void Select(double* HWY_RESTRICT keys, size_t n, size_t nth,
+              SortAscending) const;
+  void Select(double* HWY_RESTRICT keys, size_t n, size_t nth,
+              SortDescending) const;
+  void Select(uint128_t* HWY_RESTRICT keys, size_t n, size_t nth,
+              SortAscending) const;
+  void Select(uint128_t* HWY_RESTRICT keys, size_t n, size_t nth,
+              SortDescending) const;
+  void Select(K64V64* HWY_RESTRICT keys, size_t n, size_t nth,
+              SortAscending) const;
+  void Select(K64V64* HWY_RESTRICT keys, size_t n, size_t nth,
+              SortDescending) const;
+  void Select(K32V32* HWY_RESTRICT keys, size_t n, size_t nth,
+              SortAscending) const;
+  void Select(K32V32* HWY_RESTRICT keys, size_t n, size_t nth,
+              SortDescending) const;
+
+  // Writes the merge of a[0, na) and b[0, nb), which must both be sorted in
+  // the given order, to out[0, na + nb). `out` must not overlap the inputs.
+  // The order of equal keys is unspecified. Dispatches to the best available
+  // instruction set (bitonic merge of vectors), and does not allocate.
+  void Merge(const uint16_t* HWY_RESTRICT a, size_t na,
+             const uint16_t* HWY_RESTRICT b, size_t nb,
+             uint16_t* HWY_RESTRICT out, SortAscending) const;
+  void Merge(const uint16_t* HWY_RESTRICT a, size_t na,
+             const uint16_t* HWY_RESTRICT b, size_t nb,
+             uint16_t* HWY_RESTRICT out, SortDescending) const;
+  void Merge(const uint32_t* HWY_RESTRICT a, size_t na,
+             const uint32_t* HWY_RESTRICT b, size_t nb,
+             uint32_t* HWY_RESTRICT out, SortAscending) const;
+  void Merge(const uint32_t* HWY_RESTRICT a, size_t na,
+             const uint32_t* HWY_RESTRICT b, size_t nb,
+             uint32_t* HWY_RESTRICT out, SortDescending) const;
+  void Merge(const uint64_t* HWY_RESTRICT a, size_t na,
+             const uint64_t* HWY_RESTRICT b, size_t nb,
+             uint64_t* HWY_RESTRICT out, SortAscending) const;
+  void Merge(const uint64_t* HWY_RESTRICT a, size_t na,
+             const uint64_t* HWY_RESTRICT b, size_t nb,
+             uint64_t* HWY_RESTRICT out, SortDescending) const;
+  void Merge(const int16_t* HWY_RESTRICT a, size_t na,
+             const int16_t* HWY_RESTRICT b, size_t nb,
+             int16_t* HWY_RESTRICT out, SortAscending) const;
+  void Merge(const int16_t* HWY_RESTRICT a, size_t na,
+             const int16_t* HWY_RESTRICT b, size_t nb,
+             int16_t* HWY_RESTRICT out, SortDescending) const;
+  void Merge(const int32_t* HWY_RESTRICT a, size_t na,
+             const int32_t* HWY_RESTRICT b, size_t nb,
+             int32_t* HWY_RESTRICT out, SortAscending) const;
+  void Merge(const int32_t* HWY_RESTRICT a, size_t na,
+             const int32_t* HWY_RESTRICT b, size_t nb,
+             int32_t* HWY_RESTRICT out, SortDescending) const;
+  void Merge(const int64_t* HWY_RESTRICT a, size_t na,
+             const int64_t* HWY_RESTRICT b, size_t nb,
+             int64_t* HWY_RESTRICT out, SortAscending) const;
+  void Merge(const int64_t* HWY_RESTRICT a, size_t na,
+             const int64_t* HWY_RESTRICT b, size_t nb,
+             int64_t* HWY_RESTRICT out, SortDescending) const;
+  void Merge(const float* HWY_RESTRICT a, size_t na,
+             const float* HWY_RESTRICT b, size_t nb,
+             float* HWY_RESTRICT out, SortAscending) const;
+  void Merge(const float* HWY_RESTRICT a, size_t na,
+             const float* HWY_RESTRICT b, size_t nb,
+             float* HWY_RESTRICT out, SortDescending) const;
+  void Merge(const double* HWY_RESTRICT a, size_t na,
+             const double* HWY_RESTRICT b, size_t nb,
+             double* HWY_RESTRICT out, SortAscending) const;
+  void Merge(const double* HWY_RESTRICT a, size_t na,
+             const double* HWY_RESTRICT b, size_t nb,
+             double* HWY_RESTRICT out, SortDescending) const;
+  void Merge(const uint128_t* HWY_RESTRICT a, size_t na,
+             const uint128_t* HWY_RESTRICT b, size_t nb,
+             uint128_t* HWY_RESTRICT out, SortAscending) const;
+  void Merge(const uint128_t* HWY_RESTRICT a, size_t na,
+             const uint128_t* HWY_RESTRICT b, size_t nb,
+             uint128_t* HWY_RESTRICT out, SortDescending) const;
+  void Merge(const K64V64* HWY_RESTRICT a, size_t na,
+             const K64V64* HWY_RESTRICT b, size_t nb,
+             K64V64* HWY_RESTRICT out, SortAscending) const;
+  void Merge(const K64V64* HWY_RESTRICT a, size_t na,
+             const K64V64* HWY_RESTRICT b, size_t nb,
+             K64V64* HWY_RESTRICT out, SortDescending) const;
+  void Merge(const K32V32* HWY_RESTRICT a, size_t na,
+             const K32V32* HWY_RESTRICT b, size_t nb,
+             K32V32* HWY_RESTRICT out, SortAscending) const;
+  void Merge(const K32V32* HWY_RESTRICT a, size_t na,
+             const K32V32* HWY_RESTRICT b, size_t nb,
+             K32V32* HWY_RESTRICT out, SortDescending) const;
+
+  // Sorts each of the `num_segments` independent segments
+  // keys[offsets[s], offsets[s + 1]), where `offsets` has num_segments + 1
+  // non-decreasing entries, counted in keys as for the other functions. Faster than calling operator() per segment because
+  // dispatch and setup happen once for all segments, and small segments are
+  // sorted by a single sorting network. Does not allocate.
+  void SortSegments(uint16_t* HWY_RESTRICT keys,
+                    const size_t* HWY_RESTRICT offsets, size_t num_segments,
+                    SortAscending) const;
+  void SortSegments(uint16_t* HWY_RESTRICT keys,
+                    const size_t* HWY_RESTRICT offsets, size_t num_segments,
+                    SortDescending) const;
+  void SortSegments(uint32_t* HWY_RESTRICT keys,
+                    const size_t* HWY_RESTRICT offsets, size_t num_segments,
+                    SortAscending) const;
+  void SortSegments(uint32_t* HWY_RESTRICT keys,
+                    const size_t* HWY_RESTRICT offsets, size_t num_segments,
+                    SortDescending) const;
+  void SortSegments(uint64_t* HWY_RESTRICT keys,
+                    const size_t* HWY_RESTRICT offsets, size_t num_segments,
+                    SortAscending) const;
+  void SortSegments(uint64_t* HWY_RESTRICT keys,
+                    const size_t* HWY_RESTRICT offsets, size_t num_segments,
+                    SortDescending) const;
+  void SortSegments(int16_t* HWY_RESTRICT keys,
+                    const size_t* HWY_RESTRICT offsets, size_t num_segments,
+                    SortAscending) const;
+  void SortSegments(int16_t* HWY_RESTRICT keys,
+                    const size_t* HWY_RESTRICT offsets, size_t num_segments,
+                    SortDescending) const;
+  void SortSegments(int32_t* HWY_RESTRICT keys,
+                    const size_t* HWY_RESTRICT offsets, size_t num_segments,
+                    SortAscending) const;
+  void SortSegments(int32_t* HWY_RESTRICT keys,
+                    const size_t* HWY_RESTRICT offsets, size_t num_segments,
+                    SortDescending) const;
+  void SortSegments(int64_t* HWY_RESTRICT keys,
+                    const size_t* HWY_RESTRICT offsets, size_t num_segments,
+                    SortAscending) const;
+  void SortSegments(int64_t* HWY_RESTRICT keys,
+                    const size_t* HWY_RESTRICT offsets, size_t num_segments,
+                    SortDescending) const;
+  void SortSegments(float* HWY_RESTRICT keys,
+                    const size_t* HWY_RESTRICT offsets, size_t num_segments,
+                    SortAscending) const;
+  void SortSegments(float* HWY_RESTRICT keys,
+                    const size_t* HWY_RESTRICT offsets, size_t num_segments,
+                    SortDescending) const;
+  void SortSegments(double* HWY_RESTRICT keys,
+                    const size_t* HWY_RESTRICT offsets, size_t num_segments,
+                    SortAscending) const;
+  void SortSegments(double* HWY_RESTRICT keys,
+                    const size_t* HWY_RESTRICT offsets, size_t num_segments,
+                    SortDescending) const;
+  void SortSegments(uint128_t* HWY_RESTRICT keys,
+                    const size_t* HWY_RESTRICT offsets, size_t num_segments,
+                    SortAscending) const;
+  void SortSegments(uint128_t* HWY_RESTRICT keys,
+                    const size_t* HWY_RESTRICT offsets, size_t num_segments,
+                    SortDescending) const;
+  void SortSegments(K64V64* HWY_RESTRICT keys,
+                    const size_t* HWY_RESTRICT offsets, size_t num_segments,
+                    SortAscending) const;
+  void SortSegments(K64V64* HWY_RESTRICT keys,
+                    const size_t* HWY_RESTRICT offsets, size_t num_segments,
+                    SortDescending) const;
+  void SortSegments(K32V32* HWY_RESTRICT keys,
+                    const size_t* HWY_RESTRICT offsets, size_t num_segments,
+                    SortAscending) const;
+  void SortSegments(K32V32* HWY_RESTRICT keys,
+                    const size_t* HWY_RESTRICT offsets, size_t num_segments,
+                    SortDescending) const;
+
+  // Writes to indices[0, n) the permutation that sorts keys[0, n), i.e.
+  // keys[indices[i]] are in sort order. Keys are not modified. Equal keys
+  // retain their relative order (stable). `n` must not exceed the number of
+  // values representable by the index type. Allocates O(n) memory.
+  void ArgSort(const uint16_t* HWY_RESTRICT keys, size_t n,
+               uint32_t* HWY_RESTRICT indices, SortAscending) const;
+  void ArgSort(const uint16_t* HWY_RESTRICT keys, size_t n,
+               uint32_t* HWY_RESTRICT indices, SortDescending) const;
+  void ArgSort(const uint16_t* HWY_RESTRICT keys, size_t n,
+               uint64_t* HWY_RESTRICT indices, SortAscending) const;
+  void ArgSort(const uint16_t* HWY_RESTRICT keys, size_t n,
+               uint64_t* HWY_RESTRICT indices, SortDescending) const;
+  void ArgSort(const uint32_t* HWY_RESTRICT keys, size_t n,
+               uint32_t* HWY_RESTRICT indices, SortAscending) const;
+  void ArgSort(const uint32_t* HWY_RESTRICT keys, size_t n,
+               uint32_t* HWY_RESTRICT indices, SortDescending) const;
+  void ArgSort(const uint32_t* HWY_RESTRICT keys, size_t n,
+               uint64_t* HWY_RESTRICT indices, SortAscending) const;
+  void ArgSort(const uint32_t* HWY_RESTRICT keys, size_t n,
+               uint64_t* HWY_RESTRICT indices, SortDescending) const;
+  void ArgSort(const uint64_t* HWY_RESTRICT keys, size_t n,
+               uint32_t* HWY_RESTRICT indices, SortAscending) const;
+  void ArgSort(const uint64_t* HWY_RESTRICT keys, size_t n,
+               uint32_t* HWY_RESTRICT indices, SortDescending) const;
+  void ArgSort(const uint64_t* HWY_RESTRICT keys, size_t n,
+               uint64_t* HWY_RESTRICT indices, SortAscending) const;
+  void ArgSort(const uint64_t* HWY_RESTRICT keys, size_t n,
+               uint64_t* HWY_RESTRICT indices, SortDescending) const;
+  void ArgSort(const int16_t* HWY_RESTRICT keys, size_t n,
+               uint32_t* HWY_RESTRICT indices, SortAscending) const;
+  void ArgSort(const int16_t* HWY_RESTRICT keys, size_t n,
+               uint32_t* HWY_RESTRICT indices, SortDescending) const;
+  void ArgSort(const int16_t* HWY_RESTRICT keys, size_t n,
+               uint64_t* HWY_RESTRICT indices, SortAscending) const;
+  void ArgSort(const int16_t* HWY_RESTRICT keys, size_t n,
+               uint64_t* HWY_RESTRICT indices, SortDescending) const;
+  void ArgSort(const int32_t* HWY_RESTRICT keys, size_t n,
+               uint32_t* HWY_RESTRICT indices, SortAscending) const;
+  void ArgSort(const int32_t* HWY_RESTRICT keys, size_t n,
+               uint32_t* HWY_RESTRICT indices, SortDescending) const;
+  void ArgSort(const int32_t* HWY_RESTRICT keys, size_t n,
+               uint64_t* HWY_RESTRICT indices, SortAscending) const;
+  void ArgSort(const int32_t* HWY_RESTRICT keys, size_t n,
+               uint64_t* HWY_RESTRICT indices, SortDescending) const;
+  void ArgSort(const int64_t* HWY_RESTRICT keys, size_t n,
+               uint32_t* HWY_RESTRICT indices, SortAscending) const;
+  void ArgSort(const int64_t* HWY_RESTRICT keys, size_t n,
+               uint32_t* HWY_RESTRICT indices, SortDescending) const;
+  void ArgSort(const int64_t* HWY_RESTRICT keys, size_t n,
+               uint64_t* HWY_RESTRICT indices, SortAscending) const;
+  void ArgSort(const int64_t* HWY_RESTRICT keys, size_t n,
+               uint64_t* HWY_RESTRICT indices, SortDescending) const;
+  void ArgSort(const float* HWY_RESTRICT keys, size_t n,
+               uint32_t* HWY_RESTRICT indices, SortAscending) const;
+  void ArgSort(const float* HWY_RESTRICT keys, size_t n,
+               uint32_t* HWY_RESTRICT indices, SortDescending) const;
+  void ArgSort(const float* HWY_RESTRICT keys, size_t n,
+               uint64_t* HWY_RESTRICT indices, SortAscending) const;
+  void ArgSort(const float* HWY_RESTRICT keys, size_t n,
+               uint64_t* HWY_RESTRICT indices, SortDescending) const;
+  void ArgSort(const double* HWY_RESTRICT keys, size_t n,
+               uint32_t* HWY_RESTRICT indices, SortAscending) const;
+  void ArgSort(const double* HWY_RESTRICT keys, size_t n,
+               uint32_t* HWY_RESTRICT indices, SortDescending) const;
+  void ArgSort(const double* HWY_RESTRICT keys, size_t n,
+               uint64_t* HWY_RESTRICT indices, SortAscending) const;
+  void ArgSort(const double* HWY_RESTRICT keys, size_t n,
+               uint64_t* HWY_RESTRICT indices, SortDescending) const;
+
+  // Sorts keys[0, n) such that equal keys retain their relative order. For
+  // floats, -0 and +0 are considered equal. Key/value pairs are ordered by
+  // their key only. Allocates O(n) memory.
+  void StableSort(uint32_t* HWY_RESTRICT keys, size_t n, SortAscending) const;
+  void StableSort(uint32_t* HWY_RESTRICT keys, size_t n, SortDescending) const;
+  void StableSort(uint64_t* HWY_RESTRICT keys, size_t n, SortAscending) const;
+  void StableSort(uint64_t* HWY_RESTRICT keys, size_t n, SortDescending) const;
+  void StableSort(int32_t* HWY_RESTRICT keys, size_t n, SortAscending) const;
+  void StableSort(int32_t* HWY_RESTRICT keys, size_t n, SortDescending) const;
+  void StableSort(int64_t* HWY_RESTRICT keys, size_t n, SortAscending) const;
+  void StableSort(int64_t* HWY_RESTRICT keys, size_t n, SortDescending) const;
+  void StableSort(float* HWY_RESTRICT keys, size_t n, SortAscending) const;
+  void StableSort(float* HWY_RESTRICT keys, size_t n, SortDescending) const;
+  void StableSort(double* HWY_RESTRICT keys, size_t n, SortAscending) const;
+  void StableSort(double* HWY_RESTRICT keys, size_t n, SortDescending) const;
+  void StableSort(K64V64* HWY_RESTRICT keys, size_t n, SortAscending) const;
+  void StableSort(K64V64* HWY_RESTRICT keys, size_t n, SortDescending) const;
+  void StableSort(K32V32* HWY_RESTRICT keys, size_t n, SortAscending) const;
+  void StableSort(K32V32* HWY_RESTRICT keys, size_t n, SortDescending) const;
+
+  // Sorts keys[0, n) like StableSort and applies the same permutation to each
+  // of the `num_payloads` arrays payloads[p], whose n elements are
+  // payload_sizes[p] bytes each (e.g. columns of a structure of arrays). Equal
+  // keys retain their relative order. Payloads are moved once, by gathering
+  // them in sorted order, rather than during the sort. Allocates O(n) memory.
+  void SortWithPayload(uint32_t* HWY_RESTRICT keys, size_t n,
+                       void* const* payloads, const size_t* payload_sizes,
+                       size_t num_payloads, SortAscending) const;
+  void SortWithPayload(uint32_t* HWY_RESTRICT keys, size_t n,
+                       void* const* payloads, const size_t* payload_sizes,
+                       size_t num_payloads, SortDescending) const;
+  void SortWithPayload(uint64_t* HWY_RESTRICT keys, size_t n,
+                       void* const* payloads, const size_t* payload_sizes,
+                       size_t num_payloads, SortAscending) const;
+  void SortWithPayload(uint64_t* HWY_RESTRICT keys, size_t n,
+                       void* const* payloads, const size_t* payload_sizes,
+                       size_t num_payloads, SortDescending) const;
+  void SortWithPayload(int32_t* HWY_RESTRICT keys, size_t n,
+                       void* const* payloads, const size_t* payload_sizes,
+                       size_t num_payloads, SortAscending) const;
+  void SortWithPayload(int32_t* HWY_RESTRICT keys, size_t n,
+                       void* const* payloads, const size_t* payload_sizes,
+                       size_t num_payloads, SortDescending) const;
+  void SortWithPayload(int64_t* HWY_RESTRICT keys, size_t n,
+                       void* const* payloads, const size_t* payload_sizes,
+                       size_t num_payloads, SortAscending) const;
+  void SortWithPayload(int64_t* HWY_RESTRICT keys, size_t n,
+                       void* const* payloads, const size_t* payload_sizes,
+                       size_t num_payloads, SortDescending) const;
+  void SortWithPayload(float* HWY_RESTRICT keys, size_t n,
+                       void* const* payloads, const size_t* payload_sizes,
+                       size_t num_payloads, SortAscending) const;
+  void SortWithPayload(float* HWY_RESTRICT keys, size_t n,
+                       void* const* payloads, const size_t* payload_sizes,
+                       size_t num_payloads, SortDescending) const;
+  void SortWithPayload(double* HWY_RESTRICT keys, size_t n,
+                       void* const* payloads, const size_t* payload_sizes,
+                       size_t num_payloads, SortAscending) const;
+  void SortWithPayload(double* HWY_RESTRICT keys, size_t n,
+                       void* const* payloads, const size_t* payload_sizes,
+                       size_t num_payloads, SortDescending) const;
+
+  // Sorts keys[0, n) according to the IEEE 754 totalOrder predicate (as in
+  // std::strong_order): -NaN < -inf < ... < -0 < +0 < ... < +inf < +NaN, with
+  // NaNs of the same sign ordered by their payload. Unlike operator(), the
+  // position of NaN and the order of -0 and +0 are thus defined. Converts the
+  // keys in place to signed integers of the same size and back, which costs
+  // two vectorized passes. Does not allocate, except as documented for
+  // operator() with integer keys.
+  void SortTotalOrder(float* HWY_RESTRICT keys, size_t n, SortAscending) const;
+  void SortTotalOrder(float* HWY_RESTRICT keys, size_t n,
+                      SortDescending) const;
+  void SortTotalOrder(double* HWY_RESTRICT keys, size_t n,
+                      SortAscending) const;
+  void SortTotalOrder(double* HWY_RESTRICT keys, size_t n,
+                      SortDescending) const;
+
+  // Writes to indices[0, n) the permutation that sorts the byte strings
+  // strings[i][0, lengths[i]) lexicographically, i.e. keys are compared as by
+  // memcmp (unsigned bytes) and a proper prefix precedes the longer string.
+  // Equal strings retain their relative order (stable). Strings are sorted by
+  // their first 8 bytes via the K64V64 path; only runs with equal prefixes are
+  // then sorted by their next 8 bytes, and so on. `n` must not exceed the
+  // number of values representable by the index type. Allocates O(n) memory.
+  void ArgSortStrings(const char* const* HWY_RESTRICT strings,
+                      const size_t* HWY_RESTRICT lengths, size_t n,
+                      uint32_t* HWY_RESTRICT indices, SortAscending) const;
+  void ArgSortStrings(const char* const* HWY_RESTRICT strings,
+                      const size_t* HWY_RESTRICT lengths, size_t n,
+                      uint32_t* HWY_RESTRICT indices, SortDescending) const;
+  void ArgSortStrings(const char* const* HWY_RESTRICT strings,
+                      const size_t* HWY_RESTRICT lengths, size_t n,
+                      uint64_t* HWY_RESTRICT indices, SortAscending) const;
+  void ArgSortStrings(const char* const* HWY_RESTRICT strings,
+                      const size_t* HWY_RESTRICT lengths, size_t n,
+                      uint64_t* HWY_RESTRICT indices, SortDescending) const;
+
+  // Returns the tuning used by all subsequent sorts in this process.
+  static const SortTuning& Tuning() { return tuning_; }
+  // Replaces the tuning and returns true, or returns false if !IsValid().
+  // Not synchronized: must not be called while other threads are sorting.
+  static bool SetTuning(const SortTuning& tuning);
+
+  // Returns the tuning that sorts random 32 and 64-bit keys fastest on this
+  // machine, measured by sorting with each supported combination of values,
+  // which takes about two seconds. Does not change Tuning(), hence other
+  // threads may continue to sort meanwhile.
+  static SortTuning Autotune();
+  // Writes `tuning` to a text file at `path`, together with the name of the
+  // instruction set for which it was measured. Returns false on I/O errors.
+  static bool SaveTuning(const char* path, const SortTuning& tuning);
+  // Reads a file written by SaveTuning and, if it is valid and was measured
+  // for the current instruction set, calls SetTuning. Typically called once at
+  // startup. Returns whether the tuning was replaced.
+  static bool LoadTuning(const char* path);
+
   // For internal use only
   static void Fill24Bytes(const void* seed_heap, size_t seed_num, void* bytes);
   static bool HaveFloat64();
@@ -92,12 +736,30 @@ class HWY_CONTRIB_DLLEXPORT Sorter {
  private:
   void Delete();
 
+  void MoveFrom(Sorter& other) {
+    ptr_ = other.ptr_;
+    free_ = other.free_;
+    opaque_ = other.opaque_;
+    owns_ptr_ = other.owns_ptr_;
+    detect_presorted_ = other.detect_presorted_;
+    other.ptr_ = nullptr;
+    other.owns_ptr_ = false;
+  }
+
   template <typename T>
   T* Get() const {
     return static_cast<T*>(ptr_);
   }
 
+  // Read once per sort, hence inline.
+  static SortTuning tuning_;
+
+  // Null means each call uses stack storage.
   void* ptr_ = nullptr;
+  FreePtr free_ = nullptr;
+  void* opaque_ = nullptr;
+  bool owns_ptr_ = false;
+  bool detect_presorted_ = false;
 };
 
 }  // namespace hwy
@@ -0,0 +1,644 @@
+// Copyright 2022 Google LLC
+// SPDX-License-Identifier: Apache-2.0
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//      http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+// ArgSort and StableSort pack each key, converted to bits whose unsigned order
+// matches the requested order, together with its index into a single u64 lane
+// (keys of up to 32 bits and indices that fit in 32 bits) or a uint128_t, sort
+// those via the existing ascending vqsort and then extract the indices. Ties
+// are thus broken by index, which makes the result stable. SortWithPayload
+// then gathers the keys and each payload array in that order.
+
+#include <stdint.h>
+#include <string.h>  // memcpy
+
+#include "hwy/aligned_allocator.h"
+#include "hwy/base.h"
+#include "hwy/contrib/sort/shared-inl.h"  // TotalOrderSigned
+#include "hwy/contrib/sort/vqsort.h"
+
+namespace hwy {
+namespace {
+
+// Returns bits of `key` whose unsigned order is the same as the order of
+// `key` according to `Order`. For floats, -0 and +0 are equal and NaN with the
+// sign bit set/clear are placed at the very beginning/end.
+template <typename T, class Order>
+MakeUnsigned<T> OrderedBits(T key, Order order) {
+  using TU = MakeUnsigned<T>;
+  TU bits;
+  CopyBytes<sizeof(T)>(&key, &bits);
+  if (IsFloat<T>()) {
+    if (key == T(0)) bits = 0;  // -0 is equal to +0.
+    bits = TotalOrderSigned(bits);
+  }
+  // Signed order to unsigned, also for floats.
+  if (IsSigned<T>()) bits ^= SignMask<T>();
+  if (!order.IsAscending()) bits = static_cast<TU>(~bits);
+  return bits;
+}
+
+// Key/value pairs are ordered by their key only.
+template <class Order>
+uint32_t OrderedBits(K32V32 kv, Order order) {
+  return OrderedBits(kv.key, order);
+}
+template <class Order>
+uint64_t OrderedBits(K64V64 kv, Order order) {
+  return OrderedBits(kv.key, order);
+}
+
+HWY_INLINE void Pack(uint64_t bits, size_t index, uint64_t& packed) {
+  packed = (bits << 32) | static_cast<uint64_t>(index);
+}
+HWY_INLINE void Pack(uint64_t bits, size_t index, uint128_t& packed) {
+  packed.hi = bits;
+  packed.lo = static_cast<uint64_t>(index);
+}
+
+HWY_INLINE size_t Index(uint64_t packed) {
+  return static_cast<size_t>(packed & 0xFFFFFFFFu);
+}
+HWY_INLINE size_t Index(const uint128_t& packed) {
+  return static_cast<size_t>(packed.lo);
+}
+
+// Returns the (ordered key, index) of each key in ascending order.
+template <typename TPacked, typename T, class Order>
+AlignedFreeUniquePtr<TPacked[]> SortPacked(const Sorter& sorter,
+                                           const T* HWY_RESTRICT keys,
+                                           size_t n, Order order) {
+  auto packed = AllocateAligned<TPacked>(n);
+  HWY_ASSERT(packed);
+  for (size_t i = 0; i < n; ++i) {
+    Pack(OrderedBits(keys[i], order), i, packed[i]);
+  }
+  sorter(packed.get(), n, SortAscending());
+  return packed;
+}
+
+template <typename TPacked, typename T, typename TI, class Order>
+void ArgSortPacked(const Sorter& sorter, const T* HWY_RESTRICT keys, size_t n,
+                   TI* HWY_RESTRICT indices, Order order) {
+  auto packed = SortPacked<TPacked>(sorter, keys, n, order);
+  for (size_t i = 0; i < n; ++i) {
+    indices[i] = static_cast<TI>(Index(packed[i]));
+  }
+}
+
+// Moves each key to its position in the stable order. Reads all keys before
+// overwriting them by first gathering into `packed`, which is large enough.
+template <typename TPacked, typename T, class Order>
+void StableSortPacked(const Sorter& sorter, T* HWY_RESTRICT keys, size_t n,
+                      Order order) {
+  static_assert(sizeof(T) <= sizeof(TPacked), "Packed must hold a key");
+  auto packed = SortPacked<TPacked>(sorter, keys, n, order);
+  for (size_t i = 0; i < n; ++i) {
+    CopyBytes<sizeof(T)>(keys + Index(packed[i]), &packed[i]);
+  }
+  for (size_t i = 0; i < n; ++i) {
+    CopyBytes<sizeof(T)>(&packed[i], keys + i);
+  }
+}
+
+// Whether indices [0, n) fit into the lower half of a u64.
+HWY_INLINE bool IndicesFit32(size_t n) {
+  return static_cast<uint64_t>(n - 1) <= 0xFFFFFFFFu;
+}
+
+// Overloads for the size of the ordered key bits: up to 32 bits fit into u64
+// lanes together with the index, if the indices also fit.
+template <typename T, typename TI, class Order>
+void ArgSortImpl(const Sorter& sorter, const T* HWY_RESTRICT keys, size_t n,
+                 TI* HWY_RESTRICT indices, Order order, SizeTag<4> /* key */) {
+  if (IndicesFit32(n)) {
+    return ArgSortPacked<uint64_t>(sorter, keys, n, indices, order);
+  }
+  ArgSortPacked<uint128_t>(sorter, keys, n, indices, order);
+}
+template <typename T, typename TI, class Order>
+void ArgSortImpl(const Sorter& sorter, const T* HWY_RESTRICT keys, size_t n,
+                 TI* HWY_RESTRICT indices, Order order, SizeTag<2> /* key */) {
+  ArgSortImpl(sorter, keys, n, indices, order, SizeTag<4>());
+}
+template <typename T, typename TI, class Order>
+void ArgSortImpl(const Sorter& sorter, const T* HWY_RESTRICT keys, size_t n,
+                 TI* HWY_RESTRICT indices, Order order, SizeTag<8> /* key */) {
+  ArgSortPacked<uint128_t>(sorter, keys, n, indices, order);
+}
+
+template <typename T, typename TI, class Order>
+void ArgSortImpl(const Sorter& sorter, const T* HWY_RESTRICT keys, size_t n,
+                 TI* HWY_RESTRICT indices, Order order) {
+  // Indices must be representable.
+  HWY_DASSERT(n == 0 || static_cast<uint64_t>(n - 1) <=
+                            static_cast<uint64_t>(LimitsMax<TI>()));
+  if (n == 0) return;
+  ArgSortImpl(sorter, keys, n, indices, order,
+              SizeTag<sizeof(OrderedBits(keys[0], order))>());
+}
+
+template <typename T, class Order>
+void StableSortImpl(const Sorter& sorter, T* HWY_RESTRICT keys, size_t n,
+                    Order order, SizeTag<4> /* key */) {
+  if (IndicesFit32(n)) {
+    return StableSortPacked<uint64_t>(sorter, keys, n, order);
+  }
+  StableSortPacked<uint128_t>(sorter, keys, n, order);
+}
+template <typename T, class Order>
+void StableSortImpl(const Sorter& sorter, T* HWY_RESTRICT keys, size_t n,
+                    Order order, SizeTag<8> /* key */) {
+  StableSortPacked<uint128_t>(sorter, keys, n, order);
+}
+
+template <typename T, class Order>
+void StableSortImpl(const Sorter& sorter, T* HWY_RESTRICT keys, size_t n,
+                    Order order) {
+  if (n <= 1) return;
+  StableSortImpl(sorter, keys, n, order,
+                 SizeTag<sizeof(OrderedBits(keys[0], order))>());
+}
+
+// Copies the `kSize`-byte elements of `from` to `to` in the order given by the
+// indices in `packed`. Fixed sizes allow inlining the copies.
+template <size_t kSize, typename TPacked>
+void GatherFixed(const TPacked* HWY_RESTRICT packed, size_t n,
+                 const uint8_t* HWY_RESTRICT from, uint8_t* HWY_RESTRICT to) {
+  for (size_t i = 0; i < n; ++i) {
+    CopyBytes<kSize>(from + Index(packed[i]) * kSize, to + i * kSize);
+  }
+}
+
+// Permutes the `size`-byte elements of data[0, n) in the order given by
+// `packed`, via `scratch`, which must hold n * size bytes.
+template <typename TPacked>
+void Permute(const TPacked* HWY_RESTRICT packed, size_t n, void* data,
+             size_t size, uint8_t* HWY_RESTRICT scratch) {
+  const uint8_t* from = static_cast<const uint8_t*>(data);
+  switch (size) {
+    case 4:
+      GatherFixed<4>(packed, n, from, scratch);
+      break;
+    case 8:
+      GatherFixed<8>(packed, n, from, scratch);
+      break;
+    case 12:
+      GatherFixed<12>(packed, n, from, scratch);
+      break;
+    case 16:
+      GatherFixed<16>(packed, n, from, scratch);
+      break;
+    case 24:
+      GatherFixed<24>(packed, n, from, scratch);
+      break;
+    case 32:
+      GatherFixed<32>(packed, n, from, scratch);
+      break;
+    default:
+      for (size_t i = 0; i < n; ++i) {
+        memcpy(scratch + i * size, from + Index(packed[i]) * size, size);
+      }
+      break;
+  }
+  memcpy(data, scratch, n * size);
+}
+
+template <typename TPacked, typename T, class Order>
+void SortWithPayloadPacked(const Sorter& sorter, T* HWY_RESTRICT keys,
+                           size_t n, void* const* payloads,
+                           const size_t* payload_sizes, size_t num_payloads,
+                           Order order) {
+  auto packed = SortPacked<TPacked>(sorter, keys, n, order);
+  size_t max_size = sizeof(T);
+  for (size_t p = 0; p < num_payloads; ++p) {
+    max_size = HWY_MAX(max_size, payload_sizes[p]);
+  }
+  auto scratch = AllocateAligned<uint8_t>(n * max_size);
+  HWY_ASSERT(scratch);
+  Permute(packed.get(), n, keys, sizeof(T), scratch.get());
+  for (size_t p = 0; p < num_payloads; ++p) {
+    Permute(packed.get(), n, payloads[p], payload_sizes[p], scratch.get());
+  }
+}
+
+template <typename T, class Order>
+void SortWithPayloadImpl(const Sorter& sorter, T* HWY_RESTRICT keys, size_t n,
+                         void* const* payloads, const size_t* payload_sizes,
+                         size_t num_payloads, Order order,
+                         SizeTag<4> /* key */) {
+  if (IndicesFit32(n)) {
+    return SortWithPayloadPacked<uint64_t>(sorter, keys, n, payloads,
+                                           payload_sizes, num_payloads, order);
+  }
+  SortWithPayloadPacked<uint128_t>(sorter, keys, n, payloads, payload_sizes,
+                                   num_payloads, order);
+}
+template <typename T, class Order>
+void SortWithPayloadImpl(const Sorter& sorter, T* HWY_RESTRICT keys, size_t n,
+                         void* const* payloads, const size_t* payload_sizes,
+                         size_t num_payloads, Order order,
+                         SizeTag<8> /* key */) {
+  SortWithPayloadPacked<uint128_t>(sorter, keys, n, payloads, payload_sizes,
+                                   num_payloads, order);
+}
+
+template <typename T, class Order>
+void SortWithPayloadImpl(const Sorter& sorter, T* HWY_RESTRICT keys, size_t n,
+                         void* const* payloads, const size_t* payload_sizes,
+                         size_t num_payloads, Order order) {
+  if (n <= 1) return;
+  SortWithPayloadImpl(sorter, keys, n, payloads, payload_sizes, num_payloads,
+                      order, SizeTag<sizeof(OrderedBits(keys[0], order))>());
+}
+
+}  // namespace
+
+void Sorter::ArgSort(const uint16_t* HWY_RESTRICT keys, size_t n,
+                     uint32_t* HWY_RESTRICT indices,
+                     SortAscending order) const {
+  ArgSortImpl(*this, keys, n, indices, order);
+}
+
+void Sorter::ArgSort(const uint16_t* HWY_RESTRICT keys, size_t n,
+                     uint32_t* HWY_RESTRICT indices,
+                     SortDescending order) const {
+  ArgSortImpl(*this, keys, n, indices, order);
+}
+
+void Sorter::ArgSort(const uint16_t* HWY_RESTRICT keys, size_t n,
+                     uint64_t* HWY_RESTRICT indices,
+                     SortAscending order) const {
+  ArgSortImpl(*this, keys, n, indices, order);
+}
+
+void Sorter::ArgSort(const uint16_t* HWY_RESTRICT keys, size_t n,
+                     uint64_t* HWY_RESTRICT indices,
+                     SortDescending order) const {
+  ArgSortImpl(*this, keys, n, indices, order);
+}
+
+void Sorter::ArgSort(const uint32_t* HWY_RESTRICT keys, size_t n,
+                     uint32_t* HWY_RESTRICT indices,
+                     SortAscending order) const {
+  ArgSortImpl(*this, keys, n, indices, order);
+}
+
+void Sorter::ArgSort(const uint32_t* HWY_RESTRICT keys, size_t n,
+                     uint32_t* HWY_RESTRICT indices,
+                     SortDescending order) const {
+  ArgSortImpl(*this, keys, n, indices, order);
+}
+
+void Sorter::ArgSort(const uint32_t* HWY_RESTRICT keys, size_t n,
+                     uint64_t* HWY_RESTRICT indices,
+                     SortAscending order) const {
+  ArgSortImpl(*this, keys, n, indices, order);
+}
+
+void Sorter::ArgSort(const uint32_t* HWY_RESTRICT keys, size_t n,
+                     uint64_t* HWY_RESTRICT indices,
+                     SortDescending order) const {
+  ArgSortImpl(*this, keys, n, indices, order);
+}
+
+void Sorter::ArgSort(const uint64_t* HWY_RESTRICT keys, size_t n,
+                     uint32_t* HWY_RESTRICT indices,
+                     SortAscending order) const {
+  ArgSortImpl(*this, keys, n, indices, order);
+}
+
+void Sorter::ArgSort(const uint64_t* HWY_RESTRICT keys, size_t n,
+                     uint32_t* HWY_RESTRICT indices,
+                     SortDescending order) const {
+  ArgSortImpl(*this, keys, n, indices, order);
+}
+
+void Sorter::ArgSort(const uint64_t* HWY_RESTRICT keys, size_t n,
+                     uint64_t* HWY_RESTRICT indices,
+                     SortAscending order) const {
+  ArgSortImpl(*this, keys, n, indices, order);
+}
+
+void Sorter::ArgSort(const uint64_t* HWY_RESTRICT keys, size_t n,
+                     uint64_t* HWY_RESTRICT indices,
+                     SortDescending order) const {
+  ArgSortImpl(*this, keys, n, indices, order);
+}
+
+void Sorter::ArgSort(const int16_t* HWY_RESTRICT keys, size_t n,
+                     uint32_t* HWY_RESTRICT indices,
+                     SortAscending order) const {
+  ArgSortImpl(*this, keys, n, indices, order);
+}
+
+void Sorter::ArgSort(const int16_t* HWY_RESTRICT keys, size_t n,
+                     uint32_t* HWY_RESTRICT indices,
+                     SortDescending order) const {
+  ArgSortImpl(*this, keys, n, indices, order);
+}
+
+void Sorter::ArgSort(const int16_t* HWY_RESTRICT keys, size_t n,
+                     uint64_t* HWY_RESTRICT indices,
+                     SortAscending order) const {
+  ArgSortImpl(*this, keys, n, indices, order);
+}
+
+void Sorter::ArgSort(const int16_t* HWY_RESTRICT keys, size_t n,
+                     uint64_t* HWY_RESTRICT indices,
+                     SortDescending order) const {
+  ArgSortImpl(*this, keys, n, indices, order);
+}
+
+void Sorter::ArgSort(const int32_t* HWY_RESTRICT keys, size_t n,
+                     uint32_t* HWY_RESTRICT indices,
+                     SortAscending order) const {
+  ArgSortImpl(*this, keys, n, indices, order);
+}
+
+void Sorter::ArgSort(const int32_t* HWY_RESTRICT keys, size_t n,
+                     uint32_t* HWY_RESTRICT indices,
+                     SortDescending order) const {
+  ArgSortImpl(*this, keys, n, indices, order);
+}
+
+void Sorter::ArgSort(const int32_t* HWY_RESTRICT keys, size_t n,
+                     uint64_t* HWY_RESTRICT indices,
+                     SortAscending order) const {
+  ArgSortImpl(*this, keys, n, indices, order);
+}
+
+void Sorter::ArgSort(const int32_t* HWY_RESTRICT keys, size_t n,
+                     uint64_t* HWY_RESTRICT indices,
+                     SortDescending order) const {
+  ArgSortImpl(*this, keys, n, indices, order);
+}
+
+void Sorter::ArgSort(const int64_t* HWY_RESTRICT keys, size_t n,
+                     uint32_t* HWY_RESTRICT indices,
+                     SortAscending order) const {
+  ArgSortImpl(*this, keys, n, indices, order);
+}
+
+void Sorter::ArgSort(const int64_t* HWY_RESTRICT keys, size_t n,
+                     uint32_t* HWY_RESTRICT indices,
+                     SortDescending order) const {
+  ArgSortImpl(*this, keys, n, indices, order);
+}
+
+void Sorter::ArgSort(const int64_t* HWY_RESTRICT keys, size_t n,
+                     uint64_t* HWY_RESTRICT indices,
+                     SortAscending order) const {
+  ArgSortImpl(*this, keys, n, indices, order);
+}
+
+void Sorter::ArgSort(const int64_t* HWY_RESTRICT keys, size_t n,
+                     uint64_t* HWY_RESTRICT indices,
+                     SortDescending order) const {
+  ArgSortImpl(*this, keys, n, indices, order);
+}
+
+void Sorter::ArgSort(const float* HWY_RESTRICT keys, size_t n,
+                     uint32_t* HWY_RESTRICT indices,
+                     SortAscending order) const {
+  ArgSortImpl(*this, keys, n, indices, order);
+}
+
+void Sorter::ArgSort(const float* HWY_RESTRICT keys, size_t n,
+                     uint32_t* HWY_RESTRICT indices,
+                     SortDescending order) const {
+  ArgSortImpl(*this, keys, n, indices, order);
+}
+
+void Sorter::ArgSort(const float* HWY_RESTRICT keys, size_t n,
+                     uint64_t* HWY_RESTRICT indices,
+                     SortAscending order) const {
+  ArgSortImpl(*this, keys, n, indices, order);
+}
+
+void Sorter::ArgSort(const float* HWY_RESTRICT keys, size_t n,
+                     uint64_t* HWY_RESTRICT indices,
+                     SortDescending order) const {
+  ArgSortImpl(*this, keys, n, indices, order);
+}
+
+void Sorter::ArgSort(const double* HWY_RESTRICT keys, size_t n,
+                     uint32_t* HWY_RESTRICT indices,
+                     SortAscending order) const {
+  ArgSortImpl(*this, keys, n, indices, order);
+}
+
+void Sorter::ArgSort(const double* HWY_RESTRICT keys, size_t n,
+                     uint32_t* HWY_RESTRICT indices,
+                     SortDescending order) const {
+  ArgSortImpl(*this, keys, n, indices, order);
+}
+
+void Sorter::ArgSort(const double* HWY_RESTRICT keys, size_t n,
+                     uint64_t* HWY_RESTRICT indices,
+                     SortAscending order) const {
+  ArgSortImpl(*this, keys, n, indices, order);
+}
+
+void Sorter::ArgSort(const double* HWY_RESTRICT keys, size_t n,
+                     uint64_t* HWY_RESTRICT indices,
+                     SortDescending order) const {
+  ArgSortImpl(*this, keys, n, indices, order);
+}
+
+void Sorter::StableSort(uint32_t* HWY_RESTRICT keys, size_t n,
+                        SortAscending order) const {
+  // Equal integer keys are indistinguishable, hence any sort is stable.
+  (*this)(keys, n, order);
+}
+
+void Sorter::StableSort(uint32_t* HWY_RESTRICT keys, size_t n,
+                        SortDescending order) const {
+  // Equal integer keys are indistinguishable, hence any sort is stable.
+  (*this)(keys, n, order);
+}
+
+void Sorter::StableSort(uint64_t* HWY_RESTRICT keys, size_t n,
+                        SortAscending order) const {
+  // Equal integer keys are indistinguishable, hence any sort is stable.
+  (*this)(keys, n, order);
+}
+
+void Sorter::StableSort(uint64_t* HWY_RESTRICT keys, size_t n,
+                        SortDescending order) const {
+  // Equal integer keys are indistinguishable, hence any sort is stable.
+  (*this)(keys, n, order);
+}
+
+void Sorter::StableSort(int32_t* HWY_RESTRICT keys, size_t n,
+                        SortAscending order) const {
+  // Equal integer keys are indistinguishable, hence any sort is stable.
+  (*this)(keys, n, order);
+}
+
+void Sorter::StableSort(int32_t* HWY_RESTRICT keys, size_t n,
+                        SortDescending order) const {
+  // Equal integer keys are indistinguishable, hence any sort is stable.
+  (*this)(keys, n, order);
+}
+
+void Sorter::StableSort(int64_t* HWY_RESTRICT keys, size_t n,
+                        SortAscending order) const {
+  // Equal integer keys are indistinguishable, hence any sort is stable.
+  (*this)(keys, n, order);
+}
+
+void Sorter::StableSort(int64_t* HWY_RESTRICT keys, size_t n,
+                        SortDescending order) const {
+  // Equal integer keys are indistinguishable, hence any sort is stable.
+  (*this)(keys, n, order);
+}
+
+void Sorter::StableSort(float* HWY_RESTRICT keys, size_t n,
+                        SortAscending order) const {
+  StableSortImpl(*this, keys, n, order);
+}
+
+void Sorter::StableSort(float* HWY_RESTRICT keys, size_t n,
+                        SortDescending order) const {
+  StableSortImpl(*this, keys, n, order);
+}
+
+void Sorter::StableSort(double* HWY_RESTRICT keys, size_t n,
+                        SortAscending order) const {
+  StableSortImpl(*this, keys, n, order);
+}
+
+void Sorter::StableSort(double* HWY_RESTRICT keys, size_t n,
+                        SortDescending order) const {
+  StableSortImpl(*this, keys, n, order);
+}
+
+void Sorter::StableSort(K32V32* HWY_RESTRICT keys, size_t n,
+                        SortAscending order) const {
+  StableSortImpl(*this, keys, n, order);
+}
+
+void Sorter::StableSort(K32V32* HWY_RESTRICT keys, size_t n,
+                        SortDescending order) const {
+  StableSortImpl(*this, keys, n, order);
+}
+
+void Sorter::StableSort(K64V64* HWY_RESTRICT keys, size_t n,
+                        SortAscending order) const {
+  StableSortImpl(*this, keys, n, order);
+}
+
+void Sorter::StableSort(K64V64* HWY_RESTRICT keys, size_t n,
+                        SortDescending order) const {
+  StableSortImpl(*this, keys, n, order);
+}
+
+void Sorter::SortWithPayload(uint32_t* HWY_RESTRICT keys, size_t n,
+                             void* const* payloads,
+                             const size_t* payload_sizes, size_t num_payloads,
+                             SortAscending order) const {
+  SortWithPayloadImpl(*this, keys, n, payloads, payload_sizes, num_payloads,
+                      order);
+}
+
+void Sorter::SortWithPayload(uint32_t* HWY_RESTRICT keys, size_t n,
+                             void* const* payloads,
+                             const size_t* payload_sizes, size_t num_payloads,
+                             SortDescending order) const {
+  SortWithPayloadImpl(*this, keys, n, payloads, payload_sizes, num_payloads,
+                      order);
+}
+
+void Sorter::SortWithPayload(uint64_t* HWY_RESTRICT keys, size_t n,
+                             void* const* payloads,
+                             const size_t* payload_sizes, size_t num_payloads,
+                             SortAscending order) const {
+  SortWithPayloadImpl(*this, keys, n, payloads, payload_sizes, num_payloads,
+                      order);
+}
+
+void Sorter::SortWithPayload(uint64_t* HWY_RESTRICT keys, size_t n,
+                             void* const* payloads,
+                             const size_t* payload_sizes, size_t num_payloads,
+                             SortDescending order) const {
+  SortWithPayloadImpl(*this, keys, n, payloads, payload_sizes, num_payloads,
+                      order);
+}
+
+void Sorter::SortWithPayload(int32_t* HWY_RESTRICT keys, size_t n,
+                             void* const* payloads,
+                             const size_t* payload_sizes, size_t num_payloads,
+                             SortAscending order) const {
+  SortWithPayloadImpl(*this, keys, n, payloads, payload_sizes, num_payloads,
+                      order);
+}
+
+void Sorter::SortWithPayload(int32_t* HWY_RESTRICT keys, size_t n,
+                             void* const* payloads,
+                             const size_t* payload_sizes, size_t num_payloads,
+                             SortDescending order) const {
+  SortWithPayloadImpl(*this, keys, n, payloads, payload_sizes, num_payloads,
+                      order);
+}
+
+void Sorter::SortWithPayload(int64_t* HWY_RESTRICT keys, size_t n,
+                             void* const* payloads,
+                             const size_t* payload_sizes, size_t num_payloads,
+                             SortAscending order) const {
+  SortWithPayloadImpl(*this, keys, n, payloads, payload_sizes, num_payloads,
+                      order);
+}
+
+void Sorter::SortWithPayload(int64_t* HWY_RESTRICT keys, size_t n,
+                             void* const* payloads,
+                             const size_t* payload_sizes, size_t num_payloads,
+                             SortDescending order) const {
+  SortWithPayloadImpl(*this, keys, n, payloads, payload_sizes, num_payloads,
+                      order);
+}
+
+void Sorter::SortWithPayload(float* HWY_RESTRICT keys, size_t n,
+                             void* const* payloads,
+                             const size_t* payload_sizes, size_t num_payloads,
+                             SortAscending order) const {
+  SortWithPayloadImpl(*this, keys, n, payloads, payload_sizes, num_payloads,
+                      order);
+}
+
+void Sorter::SortWithPayload(float* HWY_RESTRICT keys, size_t n,
+                             void* const* payloads,
+                             const size_t* payload_sizes, size_t num_payloads,
+                             SortDescending order) const {
+  SortWithPayloadImpl(*this, keys, n, payloads, payload_sizes, num_payloads,
+                      order);
+}
+
+void Sorter::SortWithPayload(double* HWY_RESTRICT keys, size_t n,
+                             void* const* payloads,
+                             const size_t* payload_sizes, size_t num_payloads,
+                             SortAscending order) const {
+  SortWithPayloadImpl(*this, keys, n, payloads, payload_sizes, num_payloads,
+                      order);
+}
+
+void Sorter::SortWithPayload(double* HWY_RESTRICT keys, size_t n,
+                             void* const* payloads,
+                             const size_t* payload_sizes, size_t num_payloads,
+                             SortDescending order) const {
+  SortWithPayloadImpl(*this, keys, n, payloads, payload_sizes, num_payloads,
+                      order);
+}
+
+}  // namespace hwy
@@ -0,0 +1,514 @@
+// Copyright 2022 Google LLC
+// SPDX-License-Identifier: Apache-2.0
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//      http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+// ExternalSorter sorts runs with Sorter and merges them with a binary tree of
+// streaming merges. Each tree node owns a buffer of equal capacity; leaves fill
+// theirs from a run file, and inner nodes by calling Sorter::Merge on the
+// prefixes of their children's buffers that are known to precede all keys not
+// yet buffered. Children are topped up once half empty, so each merge and file
+// access covers at least half a buffer.
+
+#include <stdio.h>
+#include <stdlib.h>  // getenv
+#include <string.h>  // memcpy, memmove
+
+#include <atomic>
+#include <memory>
+#include <string>
+#include <vector>
+
+#include "hwy/aligned_allocator.h"
+#include "hwy/base.h"
+#include "hwy/contrib/sort/external_sort.h"
+#include "hwy/contrib/sort/vqsort.h"
+
+namespace hwy {
+namespace {
+
+constexpr size_t kDefaultMemoryBudget = size_t{256} << 20;
+
+// Merge tree buffers of at least this size keep reads of the runs large enough
+// to be efficient despite interleaving between files.
+constexpr size_t kMinBlockBytes = size_t{64} << 10;
+
+// Bounds the number of run files open at the same time.
+constexpr size_t kMaxFanIn = 256;
+
+// ------------------------------ Scalar comparisons
+
+// Consistent with the vectorized comparisons in traits-inl.h and
+// traits128-inl.h: 128-bit keys compare the upper half first, and key/value
+// pairs only compare their key.
+template <typename T>
+bool Less(const T& a, const T& b) {
+  return a < b;
+}
+bool Less(const uint128_t& a, const uint128_t& b) {
+  return a.hi != b.hi ? a.hi < b.hi : a.lo < b.lo;
+}
+bool Less(const K64V64& a, const K64V64& b) { return a.key < b.key; }
+bool Less(const K32V32& a, const K32V32& b) { return a.key < b.key; }
+
+// Returns whether `a` is strictly before `b` in sort order.
+template <typename T, class Order>
+bool Before(const T& a, const T& b, Order order) {
+  return order.IsAscending() ? Less(a, b) : Less(b, a);
+}
+
+// Returns how many of the sorted keys[0, num) are not after `bound`.
+template <typename T, class Order>
+size_t UpperBound(const T* HWY_RESTRICT keys, size_t num, const T& bound,
+                  Order order) {
+  size_t lo = 0;
+  size_t hi = num;
+  while (lo < hi) {
+    const size_t mid = lo + (hi - lo) / 2;
+    if (Before(bound, keys[mid], order)) {
+      hi = mid;
+    } else {
+      lo = mid + 1;
+    }
+  }
+  return lo;
+}
+
+// Returns how many of the first `num` keys of the merge of the sorted a[0, na)
+// and b[0, nb) are taken from `a`, where `num` <= na + nb.
+template <typename T, class Order>
+size_t SplitMerge(const T* HWY_RESTRICT a, size_t na, const T* HWY_RESTRICT b,
+                  size_t nb, size_t num, Order order) {
+  size_t lo = num > nb ? num - nb : 0;
+  size_t hi = HWY_MIN(num, na);
+  while (lo < hi) {
+    const size_t i = lo + (hi - lo) / 2;
+    // Take more from `a` unless a[i] is after the last key taken from `b`.
+    if (Before(b[num - i - 1], a[i], order)) {
+      hi = i;
+    } else {
+      lo = i + 1;
+    }
+  }
+  return lo;
+}
+
+// ------------------------------ Files
+
+struct FileCloser {
+  void operator()(FILE* file) const { fclose(file); }
+};
+using FilePtr = std::unique_ptr<FILE, FileCloser>;
+
+// Closes `file` and returns whether all prior writes succeeded.
+bool Close(FilePtr& file) { return fclose(file.release()) == 0; }
+
+// Reads up to `max_keys` into `keys` and sets `num` to the number read, which
+// is less than `max_keys` only at the end of the file. Returns false on error
+// or if the file ends within a key.
+template <typename T>
+bool ReadKeys(FILE* file, T* HWY_RESTRICT keys, size_t max_keys, size_t& num,
+              ExternalSortStats& stats) {
+  const size_t bytes = fread(keys, 1, max_keys * sizeof(T), file);
+  stats.bytes_read += bytes;
+  num = bytes / sizeof(T);
+  if (bytes != max_keys * sizeof(T) && ferror(file)) return false;
+  return bytes % sizeof(T) == 0;
+}
+
+template <typename T>
+bool WriteKeys(FILE* file, const T* HWY_RESTRICT keys, size_t num,
+               ExternalSortStats& stats) {
+  const size_t bytes = fwrite(keys, 1, num * sizeof(T), file);
+  stats.bytes_written += bytes;
+  return bytes == num * sizeof(T);
+}
+
+// Creates uniquely named files in a directory and removes them when no longer
+// needed, or at the latest upon destruction.
+class TempFiles {
+ public:
+  explicit TempFiles(const std::string& dir) : dir_(dir) {}
+  ~TempFiles() {
+    for (const std::string& path : paths_) {
+      remove(path.c_str());
+    }
+  }
+
+  // Returns a new empty file opened for writing and sets `path`, or returns
+  // null if the file could not be created.
+  FilePtr Create(std::string& path) {
+    static std::atomic<uint64_t> counter{0};
+    // Other processes may be using the same names; "x" fails if the file
+    // already exists, in which case we try the next name.
+    for (int attempt = 0; attempt < 100; ++attempt) {
+      path = dir_ + "/hwy_sort_" +
+             std::to_string(reinterpret_cast<uintptr_t>(this)) + "_" +
+             std::to_string(counter.fetch_add(1));
+      FilePtr file(fopen(path.c_str(), "wbx"));
+      if (file) {
+        paths_.push_back(path);
+        return file;
+      }
+    }
+    return FilePtr();
+  }
+
+  void Remove(const std::string& path) {
+    remove(path.c_str());
+    for (size_t i = 0; i < paths_.size(); ++i) {
+      if (paths_[i] == path) {
+        paths_.erase(paths_.begin() + static_cast<ptrdiff_t>(i));
+        break;
+      }
+    }
+  }
+
+ private:
+  std::string dir_;
+  std::vector<std::string> paths_;
+};
+
+// Input of the run phase.
+template <typename T>
+class FileSource {
+ public:
+  explicit FileSource(FILE* file) : file_(file) {}
+
+  bool Read(T* HWY_RESTRICT keys, size_t max_keys, size_t& num,
+            ExternalSortStats& stats) {
+    return ReadKeys(file_.get(), keys, max_keys, num, stats);
+  }
+
+  // Allows overwriting the input with the output.
+  void Close() { file_.reset(); }
+
+ private:
+  FilePtr file_;
+};
+
+template <typename T>
+class MemorySource {
+ public:
+  MemorySource(const T* keys, size_t num) : keys_(keys), remaining_(num) {}
+
+  bool Read(T* HWY_RESTRICT keys, size_t max_keys, size_t& num,
+            ExternalSortStats& /* stats */) {
+    num = HWY_MIN(max_keys, remaining_);
+    if (num != 0) memcpy(keys, keys_, num * sizeof(T));
+    keys_ += num;
+    remaining_ -= num;
+    return true;
+  }
+
+  void Close() {}
+
+ private:
+  const T* keys_;
+  size_t remaining_;
+};
+
+// ------------------------------ MergeNode
+
+template <typename T, class Order>
+class MergeNode {
+ public:
+  // Leaf: streams the sorted keys of `file`.
+  MergeNode(FilePtr file, size_t capacity)
+      : file_(std::move(file)), capacity_(capacity) {
+    Allocate();
+  }
+
+  // Inner node: merges the output of two nodes.
+  MergeNode(std::unique_ptr<MergeNode> a, std::unique_ptr<MergeNode> b,
+            size_t capacity)
+      : a_(std::move(a)), b_(std::move(b)), capacity_(capacity) {
+    Allocate();
+  }
+
+  // Buffered keys in sort order, to be read and then consumed by the parent.
+  const T* Keys() const { return keys_.get() + pos_; }
+  size_t Size() const { return end_ - pos_; }
+  void Consume(size_t num) { pos_ += num; }
+
+  // Whether all remaining keys are buffered, so Refill would not add any.
+  bool Exhausted() const {
+    if (file_) return eof_;
+    return a_->Exhausted() && a_->Size() == 0 && b_->Exhausted() &&
+           b_->Size() == 0;
+  }
+
+  // Moves the buffered keys to the front of the buffer and appends as many
+  // more as are available, up to its capacity. Returns false on read error.
+  bool Refill(const Sorter& sorter, Order order, ExternalSortStats& stats) {
+    if (pos_ != 0) {
+      memmove(keys_.get(), Keys(), Size() * sizeof(T));
+      end_ -= pos_;
+      pos_ = 0;
+    }
+
+    if (file_) {
+      size_t num;
+      if (!ReadKeys(file_.get(), keys_.get() + end_, capacity_ - end_, num,
+                    stats)) {
+        return false;
+      }
+      eof_ = end_ + num != capacity_;
+      end_ += num;
+      return true;
+    }
+
+    while (end_ != capacity_) {
+      if (!RefillChild(*a_, sorter, order, stats) ||
+          !RefillChild(*b_, sorter, order, stats)) {
+        return false;
+      }
+      const T* HWY_RESTRICT a = a_->Keys();
+      const T* HWY_RESTRICT b = b_->Keys();
+      const size_t na = a_->Size();
+      const size_t nb = b_->Size();
+      if (na + nb == 0) break;  // both exhausted
+
+      // Keys after the last buffered key of a child that has more keys may
+      // be preceded by those keys, so only merge keys up to the first such
+      // last key. Children that are not exhausted are not empty after
+      // RefillChild.
+      size_t safe_a = na;
+      size_t safe_b = nb;
+      const bool bound_a = !a_->Exhausted();
+      const bool bound_b = !b_->Exhausted();
+      if (bound_a || bound_b) {
+        T bound = bound_a ? a[na - 1] : b[nb - 1];
+        if (bound_a && bound_b && Before(b[nb - 1], bound, order)) {
+          bound = b[nb - 1];
+        }
+        safe_a = UpperBound(a, na, bound, order);
+        safe_b = UpperBound(b, nb, bound, order);
+      }
+
+      const size_t num = HWY_MIN(safe_a + safe_b, capacity_ - end_);
+      const size_t take_a = num == safe_a + safe_b
+                                ? safe_a
+                                : SplitMerge(a, safe_a, b, safe_b, num, order);
+      const size_t take_b = num - take_a;
+      sorter.Merge(a, take_a, b, take_b, keys_.get() + end_, order);
+      a_->Consume(take_a);
+      b_->Consume(take_b);
+      end_ += num;
+    }
+    return true;
+  }
+
+ private:
+  void Allocate() {
+    keys_ = AllocateAligned<T>(capacity_);
+    HWY_ASSERT(keys_);
+  }
+
+  static bool RefillChild(MergeNode& child, const Sorter& sorter, Order order,
+                          ExternalSortStats& stats) {
+    if (child.Exhausted() || child.Size() >= child.capacity_ / 2) return true;
+    return child.Refill(sorter, order, stats);
+  }
+
+  FilePtr file_;  // only for leaves
+  bool eof_ = false;
+  std::unique_ptr<MergeNode> a_;  // only for inner nodes
+  std::unique_ptr<MergeNode> b_;
+
+  AlignedFreeUniquePtr<T[]> keys_;
+  size_t capacity_;
+  size_t pos_ = 0;
+  size_t end_ = 0;
+};
+
+// Returns a balanced tree whose leaves read files[begin, end).
+template <typename T, class Order>
+std::unique_ptr<MergeNode<T, Order>> BuildTree(std::vector<FilePtr>& files,
+                                               size_t begin, size_t end,
+                                               size_t capacity) {
+  using Node = MergeNode<T, Order>;
+  if (end - begin == 1) {
+    return std::unique_ptr<Node>(new Node(std::move(files[begin]), capacity));
+  }
+  const size_t mid = begin + (end - begin) / 2;
+  return std::unique_ptr<Node>(
+      new Node(BuildTree<T, Order>(files, begin, mid, capacity),
+               BuildTree<T, Order>(files, mid, end, capacity), capacity));
+}
+
+// Writes the merge of the runs in the files at paths[0, num) to `out`.
+template <typename T, class Order>
+bool MergeFiles(const Sorter& sorter, size_t budget,
+                const std::string* paths, size_t num, FILE* out, Order order,
+                ExternalSortStats& stats) {
+  std::vector<FilePtr> files;
+  for (size_t i = 0; i < num; ++i) {
+    files.emplace_back(fopen(paths[i].c_str(), "rb"));
+    if (!files.back()) return false;
+  }
+
+  // The tree has 2 * num - 1 nodes, each with a buffer of the same capacity.
+  const size_t capacity = HWY_MAX(budget / sizeof(T) / (2 * num - 1), size_t{1});
+  const auto root = BuildTree<T, Order>(files, 0, num, capacity);
+  for (;;) {
+    if (!root->Exhausted() && !root->Refill(sorter, order, stats)) {
+      return false;
+    }
+    if (root->Size() == 0) return true;
+    if (!WriteKeys(out, root->Keys(), root->Size(), stats)) return false;
+    root->Consume(root->Size());
+  }
+}
+
+template <typename T, class Order, class Source>
+bool ExternalSortImpl(const Sorter& sorter, const std::string& temp_dir,
+                      size_t budget, Source& source, const char* out_path,
+                      Order order, ExternalSortStats* stats_or_null) {
+  ExternalSortStats local_stats;
+  ExternalSortStats& stats = stats_or_null ? *stats_or_null : local_stats;
+  stats = ExternalSortStats();
+
+  TempFiles temp(temp_dir);
+  std::vector<std::string> runs;
+  {
+    // Freed before merging, which needs the entire budget.
+    const size_t run_keys = budget / sizeof(T);
+    auto keys = AllocateAligned<T>(run_keys);
+    HWY_ASSERT(keys);
+    for (;;) {
+      size_t num;
+      if (!source.Read(keys.get(), run_keys, num, stats)) return false;
+      if (num == 0) break;
+      sorter(keys.get(), num, order);
+
+      // The entire input fits into one run: write it directly.
+      if (runs.empty() && num != run_keys) {
+        source.Close();
+        FilePtr out(fopen(out_path, "wb"));
+        return out && WriteKeys(out.get(), keys.get(), num, stats) &&
+               Close(out);
+      }
+
+      std::string path;
+      FilePtr run = temp.Create(path);
+      if (!run || !WriteKeys(run.get(), keys.get(), num, stats) ||
+          !Close(run)) {
+        return false;
+      }
+      runs.push_back(path);
+      if (num != run_keys) break;
+    }
+  }
+  source.Close();
+  stats.runs = runs.size();
+
+  // Such that the 2 * max_fan_in - 1 buffers of the merge tree each have at
+  // least kMinBlockBytes. Otherwise, first merge groups of runs into fewer,
+  // longer runs.
+  const size_t max_fan_in =
+      HWY_MIN(HWY_MAX(budget / (2 * kMinBlockBytes), size_t{2}), kMaxFanIn);
+  while (runs.size() > max_fan_in) {
+    std::vector<std::string> merged;
+    for (size_t begin = 0; begin < runs.size(); begin += max_fan_in) {
+      const size_t num = HWY_MIN(max_fan_in, runs.size() - begin);
+      if (num == 1) {
+        merged.push_back(runs[begin]);
+        continue;
+      }
+      std::string path;
+      FilePtr out = temp.Create(path);
+      if (!out ||
+          !MergeFiles<T>(sorter, budget, runs.data() + begin, num, out.get(),
+                         order, stats) ||
+          !Close(out)) {
+        return false;
+      }
+      for (size_t i = 0; i < num; ++i) {
+        temp.Remove(runs[begin + i]);
+      }
+      merged.push_back(path);
+    }
+    runs.swap(merged);
+    stats.merge_passes += 1;
+  }
+
+  FilePtr out(fopen(out_path, "wb"));
+  if (!out) return false;
+  if (!runs.empty()) {  // else: empty input
+    if (!MergeFiles<T>(sorter, budget, runs.data(), runs.size(), out.get(),
+                       order, stats)) {
+      return false;
+    }
+    stats.merge_passes += 1;
+  }
+  return Close(out);
+}
+
+std::string DefaultTempDir() {
+  const char* dir = getenv("TMPDIR");
+  if (dir == nullptr || dir[0] == '\0') dir = getenv("TEMP");
+  if (dir == nullptr || dir[0] == '\0') dir = "/tmp";
+  return dir;
+}
+
+}  // namespace
+
+ExternalSorter::ExternalSorter()
+    : temp_dir_(DefaultTempDir()), budget_(kDefaultMemoryBudget) {}
+
+template <typename T, class Order>
+bool ExternalSorter::SortFile(const char* in_path, const char* out_path,
+                              Order order, ExternalSortStats* stats) const {
+  FILE* in = fopen(in_path, "rb");
+  if (in == nullptr) return false;
+  FileSource<T> source(in);
+  return ExternalSortImpl<T>(sorter_, temp_dir_, budget_, source, out_path,
+                             order, stats);
+}
+
+template <typename T, class Order>
+bool ExternalSorter::Sort(const T* HWY_RESTRICT keys, size_t n,
+                          const char* out_path, Order order,
+                          ExternalSortStats* stats) const {
+  MemorySource<T> source(keys, n);
+  return ExternalSortImpl<T>(sorter_, temp_dir_, budget_, source, out_path,
+                             order, stats);
+}
+
+#define HWY_EXTERNAL_SORT_INSTANTIATE(T, ORDER)                              \
+  template HWY_CONTRIB_DLLEXPORT bool ExternalSorter::SortFile<T, ORDER>(    \
+      const char*, const char*, ORDER, ExternalSortStats*) const;            \
+  template HWY_CONTRIB_DLLEXPORT bool ExternalSorter::Sort<T, ORDER>(        \
+      const T* HWY_RESTRICT, size_t, const char*, ORDER, ExternalSortStats*) \
+      const;
+#define HWY_EXTERNAL_SORT_INSTANTIATE_BOTH(T)     \
+  HWY_EXTERNAL_SORT_INSTANTIATE(T, SortAscending) \
+  HWY_EXTERNAL_SORT_INSTANTIATE(T, SortDescending)
+
+HWY_EXTERNAL_SORT_INSTANTIATE_BOTH(uint16_t)
+HWY_EXTERNAL_SORT_INSTANTIATE_BOTH(uint32_t)
+HWY_EXTERNAL_SORT_INSTANTIATE_BOTH(uint64_t)
+HWY_EXTERNAL_SORT_INSTANTIATE_BOTH(int16_t)
+HWY_EXTERNAL_SORT_INSTANTIATE_BOTH(int32_t)
+HWY_EXTERNAL_SORT_INSTANTIATE_BOTH(int64_t)
+HWY_EXTERNAL_SORT_INSTANTIATE_BOTH(float)
+HWY_EXTERNAL_SORT_INSTANTIATE_BOTH(double)
+HWY_EXTERNAL_SORT_INSTANTIATE_BOTH(uint128_t)
+HWY_EXTERNAL_SORT_INSTANTIATE_BOTH(K64V64)
+HWY_EXTERNAL_SORT_INSTANTIATE_BOTH(K32V32)
+
+#undef HWY_EXTERNAL_SORT_INSTANTIATE_BOTH
+#undef HWY_EXTERNAL_SORT_INSTANTIATE
+
+}  // namespace hwy
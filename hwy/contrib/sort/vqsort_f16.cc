@@ -0,0 +1,80 @@
+// Copyright 2022 Google LLC
+// SPDX-License-Identifier: Apache-2.0
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//      http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+// float16_t and bfloat16_t keys are sorted by converting them in-place to i16
+// whose signed order matches the IEEE-754 totalOrder of the floats (see
+// TotalOrderSigned in shared-inl.h), sorting those via the i16 kernels, and
+// then converting back. Both formats have the sign in the MSB followed by the
+// magnitude, hence one conversion suffices.
+
+#include "hwy/contrib/sort/vqsort.h"
+
+#undef HWY_TARGET_INCLUDE
+#define HWY_TARGET_INCLUDE "hwy/contrib/sort/vqsort_f16.cc"
+#include "hwy/foreach_target.h"
+
+// After foreach_target
+#include "hwy/contrib/sort/shared-inl.h"
+
+HWY_BEFORE_NAMESPACE();
+namespace hwy {
+namespace HWY_NAMESPACE {
+
+void ConvertTotalOrderI16(int16_t* HWY_RESTRICT keys, size_t num) {
+  detail::ConvertTotalOrder(keys, num);
+}
+
+// NOLINTNEXTLINE(google-readability-namespace-comments)
+}  // namespace HWY_NAMESPACE
+}  // namespace hwy
+HWY_AFTER_NAMESPACE();
+
+#if HWY_ONCE
+namespace hwy {
+namespace {
+HWY_EXPORT(ConvertTotalOrderI16);
+
+template <class Order>
+void SortOrdered16(const Sorter& sorter, int16_t* HWY_RESTRICT keys, size_t n,
+                   Order order) {
+  HWY_DYNAMIC_DISPATCH(ConvertTotalOrderI16)(keys, n);
+  sorter(keys, n, order);
+  HWY_DYNAMIC_DISPATCH(ConvertTotalOrderI16)(keys, n);
+}
+
+}  // namespace
+
+void Sorter::operator()(float16_t* HWY_RESTRICT keys, size_t n,
+                        SortAscending order) const {
+  SortOrdered16(*this, reinterpret_cast<int16_t*>(keys), n, order);
+}
+
+void Sorter::operator()(float16_t* HWY_RESTRICT keys, size_t n,
+                        SortDescending order) const {
+  SortOrdered16(*this, reinterpret_cast<int16_t*>(keys), n, order);
+}
+
+void Sorter::operator()(bfloat16_t* HWY_RESTRICT keys, size_t n,
+                        SortAscending order) const {
+  SortOrdered16(*this, reinterpret_cast<int16_t*>(keys), n, order);
+}
+
+void Sorter::operator()(bfloat16_t* HWY_RESTRICT keys, size_t n,
+                        SortDescending order) const {
+  SortOrdered16(*this, reinterpret_cast<int16_t*>(keys), n, order);
+}
+
+}  // namespace hwy
+#endif  // HWY_ONCE
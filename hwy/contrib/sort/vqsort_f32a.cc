@@ -27,10 +27,49 @@ HWY_BEFORE_NAMESPACE();
 namespace hwy {
 namespace HWY_NAMESPACE {
 
-void SortF32Asc(float* HWY_RESTRICT keys, size_t num, float* HWY_RESTRICT buf) {
+void SortF32Asc(float* HWY_RESTRICT keys, size_t num,
+                float* HWY_RESTRICT buf, bool detect_presorted,
+                SortStats* stats) {
   SortTag<float> d;
   detail::SharedTraits<detail::TraitsLane<detail::OrderAscending<float>>> st;
-  Sort(d, st, keys, num, buf);
+  Sort(d, st, keys, num, buf, detect_presorted, stats);
+}
+
+void SortF32AscParallel(float* HWY_RESTRICT keys, size_t num,
+                        ThreadPool& pool) {
+  SortTag<float> d;
+  detail::SharedTraits<detail::TraitsLane<detail::OrderAscending<float>>> st;
+  SortParallel(d, st, keys, num, pool);
+}
+
+void PartialSortF32Asc(float* HWY_RESTRICT keys, size_t num, size_t k,
+                       float* HWY_RESTRICT buf) {
+  SortTag<float> d;
+  detail::SharedTraits<detail::TraitsLane<detail::OrderAscending<float>>> st;
+  PartialSort(d, st, keys, num, k, buf);
+}
+
+void SelectF32Asc(float* HWY_RESTRICT keys, size_t num, size_t nth,
+                  float* HWY_RESTRICT buf) {
+  SortTag<float> d;
+  detail::SharedTraits<detail::TraitsLane<detail::OrderAscending<float>>> st;
+  Select(d, st, keys, num, nth, buf);
+}
+
+void MergeF32Asc(const float* HWY_RESTRICT a, size_t na,
+                 const float* HWY_RESTRICT b, size_t nb,
+                 float* HWY_RESTRICT out) {
+  SortTag<float> d;
+  detail::SharedTraits<detail::TraitsLane<detail::OrderAscending<float>>> st;
+  Merge(d, st, a, na, b, nb, out);
+}
+
+void SortSegmentsF32Asc(float* HWY_RESTRICT keys,
+                        const size_t* HWY_RESTRICT offsets,
+                        size_t num_segments, float* HWY_RESTRICT buf) {
+  SortTag<float> d;
+  detail::SharedTraits<detail::TraitsLane<detail::OrderAscending<float>>> st;
+  SortSegments(d, st, keys, offsets, num_segments, buf);
 }
 
 // NOLINTNEXTLINE(google-readability-namespace-comments)
@@ -42,11 +81,51 @@ HWY_AFTER_NAMESPACE();
 namespace hwy {
 namespace {
 HWY_EXPORT(SortF32Asc);
+HWY_EXPORT(SortF32AscParallel);
+HWY_EXPORT(PartialSortF32Asc);
+HWY_EXPORT(SelectF32Asc);
+HWY_EXPORT(MergeF32Asc);
+HWY_EXPORT(SortSegmentsF32Asc);
 }  // namespace
 
 void Sorter::operator()(float* HWY_RESTRICT keys, size_t n,
                         SortAscending) const {
-  HWY_DYNAMIC_DISPATCH(SortF32Asc)(keys, n, Get<float>());
+  HWY_DYNAMIC_DISPATCH(SortF32Asc)
+  (keys, n, Get<float>(), detect_presorted_, /*stats=*/nullptr);
+}
+
+void Sorter::operator()(float* HWY_RESTRICT keys, size_t n,
+                        SortAscending, SortStats& stats) const {
+  HWY_DYNAMIC_DISPATCH(SortF32Asc)
+  (keys, n, Get<float>(), detect_presorted_, &stats);
+}
+
+void Sorter::operator()(float* HWY_RESTRICT keys, size_t n,
+                        SortAscending, ThreadPool& pool) const {
+  HWY_DYNAMIC_DISPATCH(SortF32AscParallel)(keys, n, pool);
+}
+
+void Sorter::PartialSort(float* HWY_RESTRICT keys, size_t n, size_t k,
+                         SortAscending) const {
+  HWY_DYNAMIC_DISPATCH(PartialSortF32Asc)(keys, n, k, Get<float>());
+}
+
+void Sorter::Select(float* HWY_RESTRICT keys, size_t n, size_t nth,
+                    SortAscending) const {
+  HWY_DYNAMIC_DISPATCH(SelectF32Asc)(keys, n, nth, Get<float>());
+}
+
+void Sorter::Merge(const float* HWY_RESTRICT a, size_t na,
+                   const float* HWY_RESTRICT b, size_t nb,
+                   float* HWY_RESTRICT out, SortAscending) const {
+  HWY_DYNAMIC_DISPATCH(MergeF32Asc)(a, na, b, nb, out);
+}
+
+void Sorter::SortSegments(float* HWY_RESTRICT keys,
+                          const size_t* HWY_RESTRICT offsets,
+                          size_t num_segments, SortAscending) const {
+  HWY_DYNAMIC_DISPATCH(SortSegmentsF32Asc)
+  (keys, offsets, num_segments, Get<float>());
 }
 
 }  // namespace hwy
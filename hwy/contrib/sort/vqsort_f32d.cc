@@ -28,10 +28,48 @@ namespace hwy {
 namespace HWY_NAMESPACE {
 
 void SortF32Desc(float* HWY_RESTRICT keys, size_t num,
-                 float* HWY_RESTRICT buf) {
+                 float* HWY_RESTRICT buf, bool detect_presorted,
+                 SortStats* stats) {
   SortTag<float> d;
   detail::SharedTraits<detail::TraitsLane<detail::OrderDescending<float>>> st;
-  Sort(d, st, keys, num, buf);
+  Sort(d, st, keys, num, buf, detect_presorted, stats);
+}
+
+void SortF32DescParallel(float* HWY_RESTRICT keys, size_t num,
+                         ThreadPool& pool) {
+  SortTag<float> d;
+  detail::SharedTraits<detail::TraitsLane<detail::OrderDescending<float>>> st;
+  SortParallel(d, st, keys, num, pool);
+}
+
+void PartialSortF32Desc(float* HWY_RESTRICT keys, size_t num, size_t k,
+                        float* HWY_RESTRICT buf) {
+  SortTag<float> d;
+  detail::SharedTraits<detail::TraitsLane<detail::OrderDescending<float>>> st;
+  PartialSort(d, st, keys, num, k, buf);
+}
+
+void SelectF32Desc(float* HWY_RESTRICT keys, size_t num, size_t nth,
+                   float* HWY_RESTRICT buf) {
+  SortTag<float> d;
+  detail::SharedTraits<detail::TraitsLane<detail::OrderDescending<float>>> st;
+  Select(d, st, keys, num, nth, buf);
+}
+
+void MergeF32Desc(const float* HWY_RESTRICT a, size_t na,
+                  const float* HWY_RESTRICT b, size_t nb,
+                  float* HWY_RESTRICT out) {
+  SortTag<float> d;
+  detail::SharedTraits<detail::TraitsLane<detail::OrderDescending<float>>> st;
+  Merge(d, st, a, na, b, nb, out);
+}
+
+void SortSegmentsF32Desc(float* HWY_RESTRICT keys,
+                         const size_t* HWY_RESTRICT offsets,
+                         size_t num_segments, float* HWY_RESTRICT buf) {
+  SortTag<float> d;
+  detail::SharedTraits<detail::TraitsLane<detail::OrderDescending<float>>> st;
+  SortSegments(d, st, keys, offsets, num_segments, buf);
 }
 
 // NOLINTNEXTLINE(google-readability-namespace-comments)
@@ -43,11 +81,51 @@ HWY_AFTER_NAMESPACE();
 namespace hwy {
 namespace {
 HWY_EXPORT(SortF32Desc);
+HWY_EXPORT(SortF32DescParallel);
+HWY_EXPORT(PartialSortF32Desc);
+HWY_EXPORT(SelectF32Desc);
+HWY_EXPORT(MergeF32Desc);
+HWY_EXPORT(SortSegmentsF32Desc);
 }  // namespace
 
 void Sorter::operator()(float* HWY_RESTRICT keys, size_t n,
                         SortDescending) const {
-  HWY_DYNAMIC_DISPATCH(SortF32Desc)(keys, n, Get<float>());
+  HWY_DYNAMIC_DISPATCH(SortF32Desc)
+  (keys, n, Get<float>(), detect_presorted_, /*stats=*/nullptr);
+}
+
+void Sorter::operator()(float* HWY_RESTRICT keys, size_t n,
+                        SortDescending, SortStats& stats) const {
+  HWY_DYNAMIC_DISPATCH(SortF32Desc)
+  (keys, n, Get<float>(), detect_presorted_, &stats);
+}
+
+void Sorter::operator()(float* HWY_RESTRICT keys, size_t n,
+                        SortDescending, ThreadPool& pool) const {
+  HWY_DYNAMIC_DISPATCH(SortF32DescParallel)(keys, n, pool);
+}
+
+void Sorter::PartialSort(float* HWY_RESTRICT keys, size_t n, size_t k,
+                         SortDescending) const {
+  HWY_DYNAMIC_DISPATCH(PartialSortF32Desc)(keys, n, k, Get<float>());
+}
+
+void Sorter::Select(float* HWY_RESTRICT keys, size_t n, size_t nth,
+                    SortDescending) const {
+  HWY_DYNAMIC_DISPATCH(SelectF32Desc)(keys, n, nth, Get<float>());
+}
+
+void Sorter::Merge(const float* HWY_RESTRICT a, size_t na,
+                   const float* HWY_RESTRICT b, size_t nb,
+                   float* HWY_RESTRICT out, SortDescending) const {
+  HWY_DYNAMIC_DISPATCH(MergeF32Desc)(a, na, b, nb, out);
+}
+
+void Sorter::SortSegments(float* HWY_RESTRICT keys,
+                          const size_t* HWY_RESTRICT offsets,
+                          size_t num_segments, SortDescending) const {
+  HWY_DYNAMIC_DISPATCH(SortSegmentsF32Desc)
+  (keys, offsets, num_segments, Get<float>());
 }
 
 }  // namespace hwy
@@ -28,15 +28,93 @@ namespace hwy {
 namespace HWY_NAMESPACE {
 
 void SortF64Asc(double* HWY_RESTRICT keys, size_t num,
-                double* HWY_RESTRICT buf) {
+                double* HWY_RESTRICT buf, bool detect_presorted,
+                SortStats* stats) {
 #if HWY_HAVE_FLOAT64
   SortTag<double> d;
   detail::SharedTraits<detail::TraitsLane<detail::OrderAscending<double>>> st;
-  Sort(d, st, keys, num, buf);
+  Sort(d, st, keys, num, buf, detect_presorted, stats);
 #else
   (void)keys;
   (void)num;
   (void)buf;
+  (void)detect_presorted;
+  (void)stats;
+  HWY_ASSERT(0);
+#endif
+}
+
+void SortF64AscParallel(double* HWY_RESTRICT keys, size_t num,
+                        ThreadPool& pool) {
+#if HWY_HAVE_FLOAT64
+  SortTag<double> d;
+  detail::SharedTraits<detail::TraitsLane<detail::OrderAscending<double>>> st;
+  SortParallel(d, st, keys, num, pool);
+#else
+  (void)keys;
+  (void)num;
+  (void)buf;
+  HWY_ASSERT(0);
+#endif
+}
+
+void PartialSortF64Asc(double* HWY_RESTRICT keys, size_t num, size_t k,
+                       double* HWY_RESTRICT buf) {
+#if HWY_HAVE_FLOAT64
+  SortTag<double> d;
+  detail::SharedTraits<detail::TraitsLane<detail::OrderAscending<double>>> st;
+  PartialSort(d, st, keys, num, k, buf);
+#else
+  (void)keys;
+  (void)num;
+  (void)buf;
+  HWY_ASSERT(0);
+#endif
+}
+
+void SelectF64Asc(double* HWY_RESTRICT keys, size_t num, size_t nth,
+                  double* HWY_RESTRICT buf) {
+#if HWY_HAVE_FLOAT64
+  SortTag<double> d;
+  detail::SharedTraits<detail::TraitsLane<detail::OrderAscending<double>>> st;
+  Select(d, st, keys, num, nth, buf);
+#else
+  (void)keys;
+  (void)num;
+  (void)buf;
+  HWY_ASSERT(0);
+#endif
+}
+
+void MergeF64Asc(const double* HWY_RESTRICT a, size_t na,
+                 const double* HWY_RESTRICT b, size_t nb,
+                 double* HWY_RESTRICT out) {
+#if HWY_HAVE_FLOAT64
+  SortTag<double> d;
+  detail::SharedTraits<detail::TraitsLane<detail::OrderAscending<double>>> st;
+  Merge(d, st, a, na, b, nb, out);
+#else
+  (void)a;
+  (void)na;
+  (void)b;
+  (void)nb;
+  (void)out;
+  HWY_ASSERT(0);
+#endif
+}
+
+void SortSegmentsF64Asc(double* HWY_RESTRICT keys,
+                        const size_t* HWY_RESTRICT offsets,
+                        size_t num_segments, double* HWY_RESTRICT buf) {
+#if HWY_HAVE_FLOAT64
+  SortTag<double> d;
+  detail::SharedTraits<detail::TraitsLane<detail::OrderAscending<double>>> st;
+  SortSegments(d, st, keys, offsets, num_segments, buf);
+#else
+  (void)keys;
+  (void)offsets;
+  (void)num_segments;
+  (void)buf;
   HWY_ASSERT(0);
 #endif
 }
@@ -50,11 +128,51 @@ HWY_AFTER_NAMESPACE();
 namespace hwy {
 namespace {
 HWY_EXPORT(SortF64Asc);
+HWY_EXPORT(SortF64AscParallel);
+HWY_EXPORT(PartialSortF64Asc);
+HWY_EXPORT(SelectF64Asc);
+HWY_EXPORT(MergeF64Asc);
+HWY_EXPORT(SortSegmentsF64Asc);
 }  // namespace
 
 void Sorter::operator()(double* HWY_RESTRICT keys, size_t n,
                         SortAscending) const {
-  HWY_DYNAMIC_DISPATCH(SortF64Asc)(keys, n, Get<double>());
+  HWY_DYNAMIC_DISPATCH(SortF64Asc)
+  (keys, n, Get<double>(), detect_presorted_, /*stats=*/nullptr);
+}
+
+void Sorter::operator()(double* HWY_RESTRICT keys, size_t n,
+                        SortAscending, SortStats& stats) const {
+  HWY_DYNAMIC_DISPATCH(SortF64Asc)
+  (keys, n, Get<double>(), detect_presorted_, &stats);
+}
+
+void Sorter::operator()(double* HWY_RESTRICT keys, size_t n,
+                        SortAscending, ThreadPool& pool) const {
+  HWY_DYNAMIC_DISPATCH(SortF64AscParallel)(keys, n, pool);
+}
+
+void Sorter::PartialSort(double* HWY_RESTRICT keys, size_t n, size_t k,
+                         SortAscending) const {
+  HWY_DYNAMIC_DISPATCH(PartialSortF64Asc)(keys, n, k, Get<double>());
+}
+
+void Sorter::Select(double* HWY_RESTRICT keys, size_t n, size_t nth,
+                    SortAscending) const {
+  HWY_DYNAMIC_DISPATCH(SelectF64Asc)(keys, n, nth, Get<double>());
+}
+
+void Sorter::Merge(const double* HWY_RESTRICT a, size_t na,
+                   const double* HWY_RESTRICT b, size_t nb,
+                   double* HWY_RESTRICT out, SortAscending) const {
+  HWY_DYNAMIC_DISPATCH(MergeF64Asc)(a, na, b, nb, out);
+}
+
+void Sorter::SortSegments(double* HWY_RESTRICT keys,
+                          const size_t* HWY_RESTRICT offsets,
+                          size_t num_segments, SortAscending) const {
+  HWY_DYNAMIC_DISPATCH(SortSegmentsF64Asc)
+  (keys, offsets, num_segments, Get<double>());
 }
 
 }  // namespace hwy
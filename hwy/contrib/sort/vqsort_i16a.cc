@@ -28,10 +28,48 @@ namespace hwy {
 namespace HWY_NAMESPACE {
 
 void SortI16Asc(int16_t* HWY_RESTRICT keys, size_t num,
-                int16_t* HWY_RESTRICT buf) {
+                int16_t* HWY_RESTRICT buf, bool detect_presorted,
+                SortStats* stats) {
   SortTag<int16_t> d;
   detail::SharedTraits<detail::TraitsLane<detail::OrderAscending<int16_t>>> st;
-  Sort(d, st, keys, num, buf);
+  Sort(d, st, keys, num, buf, detect_presorted, stats);
+}
+
+void SortI16AscParallel(int16_t* HWY_RESTRICT keys, size_t num,
+                        ThreadPool& pool) {
+  SortTag<int16_t> d;
+  detail::SharedTraits<detail::TraitsLane<detail::OrderAscending<int16_t>>> st;
+  SortParallel(d, st, keys, num, pool);
+}
+
+void PartialSortI16Asc(int16_t* HWY_RESTRICT keys, size_t num, size_t k,
+                       int16_t* HWY_RESTRICT buf) {
+  SortTag<int16_t> d;
+  detail::SharedTraits<detail::TraitsLane<detail::OrderAscending<int16_t>>> st;
+  PartialSort(d, st, keys, num, k, buf);
+}
+
+void SelectI16Asc(int16_t* HWY_RESTRICT keys, size_t num, size_t nth,
+                  int16_t* HWY_RESTRICT buf) {
+  SortTag<int16_t> d;
+  detail::SharedTraits<detail::TraitsLane<detail::OrderAscending<int16_t>>> st;
+  Select(d, st, keys, num, nth, buf);
+}
+
+void MergeI16Asc(const int16_t* HWY_RESTRICT a, size_t na,
+                 const int16_t* HWY_RESTRICT b, size_t nb,
+                 int16_t* HWY_RESTRICT out) {
+  SortTag<int16_t> d;
+  detail::SharedTraits<detail::TraitsLane<detail::OrderAscending<int16_t>>> st;
+  Merge(d, st, a, na, b, nb, out);
+}
+
+void SortSegmentsI16Asc(int16_t* HWY_RESTRICT keys,
+                        const size_t* HWY_RESTRICT offsets,
+                        size_t num_segments, int16_t* HWY_RESTRICT buf) {
+  SortTag<int16_t> d;
+  detail::SharedTraits<detail::TraitsLane<detail::OrderAscending<int16_t>>> st;
+  SortSegments(d, st, keys, offsets, num_segments, buf);
 }
 
 // NOLINTNEXTLINE(google-readability-namespace-comments)
@@ -43,11 +81,51 @@ HWY_AFTER_NAMESPACE();
 namespace hwy {
 namespace {
 HWY_EXPORT(SortI16Asc);
+HWY_EXPORT(SortI16AscParallel);
+HWY_EXPORT(PartialSortI16Asc);
+HWY_EXPORT(SelectI16Asc);
+HWY_EXPORT(MergeI16Asc);
+HWY_EXPORT(SortSegmentsI16Asc);
 }  // namespace
 
 void Sorter::operator()(int16_t* HWY_RESTRICT keys, size_t n,
                         SortAscending) const {
-  HWY_DYNAMIC_DISPATCH(SortI16Asc)(keys, n, Get<int16_t>());
+  HWY_DYNAMIC_DISPATCH(SortI16Asc)
+  (keys, n, Get<int16_t>(), detect_presorted_, /*stats=*/nullptr);
+}
+
+void Sorter::operator()(int16_t* HWY_RESTRICT keys, size_t n,
+                        SortAscending, SortStats& stats) const {
+  HWY_DYNAMIC_DISPATCH(SortI16Asc)
+  (keys, n, Get<int16_t>(), detect_presorted_, &stats);
+}
+
+void Sorter::operator()(int16_t* HWY_RESTRICT keys, size_t n,
+                        SortAscending, ThreadPool& pool) const {
+  HWY_DYNAMIC_DISPATCH(SortI16AscParallel)(keys, n, pool);
+}
+
+void Sorter::PartialSort(int16_t* HWY_RESTRICT keys, size_t n, size_t k,
+                         SortAscending) const {
+  HWY_DYNAMIC_DISPATCH(PartialSortI16Asc)(keys, n, k, Get<int16_t>());
+}
+
+void Sorter::Select(int16_t* HWY_RESTRICT keys, size_t n, size_t nth,
+                    SortAscending) const {
+  HWY_DYNAMIC_DISPATCH(SelectI16Asc)(keys, n, nth, Get<int16_t>());
+}
+
+void Sorter::Merge(const int16_t* HWY_RESTRICT a, size_t na,
+                   const int16_t* HWY_RESTRICT b, size_t nb,
+                   int16_t* HWY_RESTRICT out, SortAscending) const {
+  HWY_DYNAMIC_DISPATCH(MergeI16Asc)(a, na, b, nb, out);
+}
+
+void Sorter::SortSegments(int16_t* HWY_RESTRICT keys,
+                          const size_t* HWY_RESTRICT offsets,
+                          size_t num_segments, SortAscending) const {
+  HWY_DYNAMIC_DISPATCH(SortSegmentsI16Asc)
+  (keys, offsets, num_segments, Get<int16_t>());
 }
 
 }  // namespace hwy
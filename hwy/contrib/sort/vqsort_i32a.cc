@@ -28,10 +28,48 @@ namespace hwy {
 namespace HWY_NAMESPACE {
 
 void SortI32Asc(int32_t* HWY_RESTRICT keys, size_t num,
-                int32_t* HWY_RESTRICT buf) {
+                int32_t* HWY_RESTRICT buf, bool detect_presorted,
+                SortStats* stats) {
   SortTag<int32_t> d;
   detail::SharedTraits<detail::TraitsLane<detail::OrderAscending<int32_t>>> st;
-  Sort(d, st, keys, num, buf);
+  Sort(d, st, keys, num, buf, detect_presorted, stats);
+}
+
+void SortI32AscParallel(int32_t* HWY_RESTRICT keys, size_t num,
+                        ThreadPool& pool) {
+  SortTag<int32_t> d;
+  detail::SharedTraits<detail::TraitsLane<detail::OrderAscending<int32_t>>> st;
+  SortParallel(d, st, keys, num, pool);
+}
+
+void PartialSortI32Asc(int32_t* HWY_RESTRICT keys, size_t num, size_t k,
+                       int32_t* HWY_RESTRICT buf) {
+  SortTag<int32_t> d;
+  detail::SharedTraits<detail::TraitsLane<detail::OrderAscending<int32_t>>> st;
+  PartialSort(d, st, keys, num, k, buf);
+}
+
+void SelectI32Asc(int32_t* HWY_RESTRICT keys, size_t num, size_t nth,
+                  int32_t* HWY_RESTRICT buf) {
+  SortTag<int32_t> d;
+  detail::SharedTraits<detail::TraitsLane<detail::OrderAscending<int32_t>>> st;
+  Select(d, st, keys, num, nth, buf);
+}
+
+void MergeI32Asc(const int32_t* HWY_RESTRICT a, size_t na,
+                 const int32_t* HWY_RESTRICT b, size_t nb,
+                 int32_t* HWY_RESTRICT out) {
+  SortTag<int32_t> d;
+  detail::SharedTraits<detail::TraitsLane<detail::OrderAscending<int32_t>>> st;
+  Merge(d, st, a, na, b, nb, out);
+}
+
+void SortSegmentsI32Asc(int32_t* HWY_RESTRICT keys,
+                        const size_t* HWY_RESTRICT offsets,
+                        size_t num_segments, int32_t* HWY_RESTRICT buf) {
+  SortTag<int32_t> d;
+  detail::SharedTraits<detail::TraitsLane<detail::OrderAscending<int32_t>>> st;
+  SortSegments(d, st, keys, offsets, num_segments, buf);
 }
 
 // NOLINTNEXTLINE(google-readability-namespace-comments)
@@ -43,11 +81,51 @@ HWY_AFTER_NAMESPACE();
 namespace hwy {
 namespace {
 HWY_EXPORT(SortI32Asc);
+HWY_EXPORT(SortI32AscParallel);
+HWY_EXPORT(PartialSortI32Asc);
+HWY_EXPORT(SelectI32Asc);
+HWY_EXPORT(MergeI32Asc);
+HWY_EXPORT(SortSegmentsI32Asc);
 }  // namespace
 
 void Sorter::operator()(int32_t* HWY_RESTRICT keys, size_t n,
                         SortAscending) const {
-  HWY_DYNAMIC_DISPATCH(SortI32Asc)(keys, n, Get<int32_t>());
+  HWY_DYNAMIC_DISPATCH(SortI32Asc)
+  (keys, n, Get<int32_t>(), detect_presorted_, /*stats=*/nullptr);
+}
+
+void Sorter::operator()(int32_t* HWY_RESTRICT keys, size_t n,
+                        SortAscending, SortStats& stats) const {
+  HWY_DYNAMIC_DISPATCH(SortI32Asc)
+  (keys, n, Get<int32_t>(), detect_presorted_, &stats);
+}
+
+void Sorter::operator()(int32_t* HWY_RESTRICT keys, size_t n,
+                        SortAscending, ThreadPool& pool) const {
+  HWY_DYNAMIC_DISPATCH(SortI32AscParallel)(keys, n, pool);
+}
+
+void Sorter::PartialSort(int32_t* HWY_RESTRICT keys, size_t n, size_t k,
+                         SortAscending) const {
+  HWY_DYNAMIC_DISPATCH(PartialSortI32Asc)(keys, n, k, Get<int32_t>());
+}
+
+void Sorter::Select(int32_t* HWY_RESTRICT keys, size_t n, size_t nth,
+                    SortAscending) const {
+  HWY_DYNAMIC_DISPATCH(SelectI32Asc)(keys, n, nth, Get<int32_t>());
+}
+
+void Sorter::Merge(const int32_t* HWY_RESTRICT a, size_t na,
+                   const int32_t* HWY_RESTRICT b, size_t nb,
+                   int32_t* HWY_RESTRICT out, SortAscending) const {
+  HWY_DYNAMIC_DISPATCH(MergeI32Asc)(a, na, b, nb, out);
+}
+
+void Sorter::SortSegments(int32_t* HWY_RESTRICT keys,
+                          const size_t* HWY_RESTRICT offsets,
+                          size_t num_segments, SortAscending) const {
+  HWY_DYNAMIC_DISPATCH(SortSegmentsI32Asc)
+  (keys, offsets, num_segments, Get<int32_t>());
 }
 
 }  // namespace hwy
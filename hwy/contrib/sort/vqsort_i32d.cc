@@ -28,10 +28,48 @@ namespace hwy {
 namespace HWY_NAMESPACE {
 
 void SortI32Desc(int32_t* HWY_RESTRICT keys, size_t num,
-                 int32_t* HWY_RESTRICT buf) {
+                 int32_t* HWY_RESTRICT buf, bool detect_presorted,
+                 SortStats* stats) {
   SortTag<int32_t> d;
   detail::SharedTraits<detail::TraitsLane<detail::OrderDescending<int32_t>>> st;
-  Sort(d, st, keys, num, buf);
+  Sort(d, st, keys, num, buf, detect_presorted, stats);
+}
+
+void SortI32DescParallel(int32_t* HWY_RESTRICT keys, size_t num,
+                         ThreadPool& pool) {
+  SortTag<int32_t> d;
+  detail::SharedTraits<detail::TraitsLane<detail::OrderDescending<int32_t>>> st;
+  SortParallel(d, st, keys, num, pool);
+}
+
+void PartialSortI32Desc(int32_t* HWY_RESTRICT keys, size_t num, size_t k,
+                        int32_t* HWY_RESTRICT buf) {
+  SortTag<int32_t> d;
+  detail::SharedTraits<detail::TraitsLane<detail::OrderDescending<int32_t>>> st;
+  PartialSort(d, st, keys, num, k, buf);
+}
+
+void SelectI32Desc(int32_t* HWY_RESTRICT keys, size_t num, size_t nth,
+                   int32_t* HWY_RESTRICT buf) {
+  SortTag<int32_t> d;
+  detail::SharedTraits<detail::TraitsLane<detail::OrderDescending<int32_t>>> st;
+  Select(d, st, keys, num, nth, buf);
+}
+
+void MergeI32Desc(const int32_t* HWY_RESTRICT a, size_t na,
+                  const int32_t* HWY_RESTRICT b, size_t nb,
+                  int32_t* HWY_RESTRICT out) {
+  SortTag<int32_t> d;
+  detail::SharedTraits<detail::TraitsLane<detail::OrderDescending<int32_t>>> st;
+  Merge(d, st, a, na, b, nb, out);
+}
+
+void SortSegmentsI32Desc(int32_t* HWY_RESTRICT keys,
+                         const size_t* HWY_RESTRICT offsets,
+                         size_t num_segments, int32_t* HWY_RESTRICT buf) {
+  SortTag<int32_t> d;
+  detail::SharedTraits<detail::TraitsLane<detail::OrderDescending<int32_t>>> st;
+  SortSegments(d, st, keys, offsets, num_segments, buf);
 }
 
 // NOLINTNEXTLINE(google-readability-namespace-comments)
@@ -43,11 +81,51 @@ HWY_AFTER_NAMESPACE();
 namespace hwy {
 namespace {
 HWY_EXPORT(SortI32Desc);
+HWY_EXPORT(SortI32DescParallel);
+HWY_EXPORT(PartialSortI32Desc);
+HWY_EXPORT(SelectI32Desc);
+HWY_EXPORT(MergeI32Desc);
+HWY_EXPORT(SortSegmentsI32Desc);
 }  // namespace
 
 void Sorter::operator()(int32_t* HWY_RESTRICT keys, size_t n,
                         SortDescending) const {
-  HWY_DYNAMIC_DISPATCH(SortI32Desc)(keys, n, Get<int32_t>());
+  HWY_DYNAMIC_DISPATCH(SortI32Desc)
+  (keys, n, Get<int32_t>(), detect_presorted_, /*stats=*/nullptr);
+}
+
+void Sorter::operator()(int32_t* HWY_RESTRICT keys, size_t n,
+                        SortDescending, SortStats& stats) const {
+  HWY_DYNAMIC_DISPATCH(SortI32Desc)
+  (keys, n, Get<int32_t>(), detect_presorted_, &stats);
+}
+
+void Sorter::operator()(int32_t* HWY_RESTRICT keys, size_t n,
+                        SortDescending, ThreadPool& pool) const {
+  HWY_DYNAMIC_DISPATCH(SortI32DescParallel)(keys, n, pool);
+}
+
+void Sorter::PartialSort(int32_t* HWY_RESTRICT keys, size_t n, size_t k,
+                         SortDescending) const {
+  HWY_DYNAMIC_DISPATCH(PartialSortI32Desc)(keys, n, k, Get<int32_t>());
+}
+
+void Sorter::Select(int32_t* HWY_RESTRICT keys, size_t n, size_t nth,
+                    SortDescending) const {
+  HWY_DYNAMIC_DISPATCH(SelectI32Desc)(keys, n, nth, Get<int32_t>());
+}
+
+void Sorter::Merge(const int32_t* HWY_RESTRICT a, size_t na,
+                   const int32_t* HWY_RESTRICT b, size_t nb,
+                   int32_t* HWY_RESTRICT out, SortDescending) const {
+  HWY_DYNAMIC_DISPATCH(MergeI32Desc)(a, na, b, nb, out);
+}
+
+void Sorter::SortSegments(int32_t* HWY_RESTRICT keys,
+                          const size_t* HWY_RESTRICT offsets,
+                          size_t num_segments, SortDescending) const {
+  HWY_DYNAMIC_DISPATCH(SortSegmentsI32Desc)
+  (keys, offsets, num_segments, Get<int32_t>());
 }
 
 }  // namespace hwy
@@ -28,10 +28,48 @@ namespace hwy {
 namespace HWY_NAMESPACE {
 
 void SortI64Asc(int64_t* HWY_RESTRICT keys, size_t num,
-                int64_t* HWY_RESTRICT buf) {
+                int64_t* HWY_RESTRICT buf, bool detect_presorted,
+                SortStats* stats) {
   SortTag<int64_t> d;
   detail::SharedTraits<detail::TraitsLane<detail::OrderAscending<int64_t>>> st;
-  Sort(d, st, keys, num, buf);
+  Sort(d, st, keys, num, buf, detect_presorted, stats);
+}
+
+void SortI64AscParallel(int64_t* HWY_RESTRICT keys, size_t num,
+                        ThreadPool& pool) {
+  SortTag<int64_t> d;
+  detail::SharedTraits<detail::TraitsLane<detail::OrderAscending<int64_t>>> st;
+  SortParallel(d, st, keys, num, pool);
+}
+
+void PartialSortI64Asc(int64_t* HWY_RESTRICT keys, size_t num, size_t k,
+                       int64_t* HWY_RESTRICT buf) {
+  SortTag<int64_t> d;
+  detail::SharedTraits<detail::TraitsLane<detail::OrderAscending<int64_t>>> st;
+  PartialSort(d, st, keys, num, k, buf);
+}
+
+void SelectI64Asc(int64_t* HWY_RESTRICT keys, size_t num, size_t nth,
+                  int64_t* HWY_RESTRICT buf) {
+  SortTag<int64_t> d;
+  detail::SharedTraits<detail::TraitsLane<detail::OrderAscending<int64_t>>> st;
+  Select(d, st, keys, num, nth, buf);
+}
+
+void MergeI64Asc(const int64_t* HWY_RESTRICT a, size_t na,
+                 const int64_t* HWY_RESTRICT b, size_t nb,
+                 int64_t* HWY_RESTRICT out) {
+  SortTag<int64_t> d;
+  detail::SharedTraits<detail::TraitsLane<detail::OrderAscending<int64_t>>> st;
+  Merge(d, st, a, na, b, nb, out);
+}
+
+void SortSegmentsI64Asc(int64_t* HWY_RESTRICT keys,
+                        const size_t* HWY_RESTRICT offsets,
+                        size_t num_segments, int64_t* HWY_RESTRICT buf) {
+  SortTag<int64_t> d;
+  detail::SharedTraits<detail::TraitsLane<detail::OrderAscending<int64_t>>> st;
+  SortSegments(d, st, keys, offsets, num_segments, buf);
 }
 
 // NOLINTNEXTLINE(google-readability-namespace-comments)
@@ -43,11 +81,51 @@ HWY_AFTER_NAMESPACE();
 namespace hwy {
 namespace {
 HWY_EXPORT(SortI64Asc);
+HWY_EXPORT(SortI64AscParallel);
+HWY_EXPORT(PartialSortI64Asc);
+HWY_EXPORT(SelectI64Asc);
+HWY_EXPORT(MergeI64Asc);
+HWY_EXPORT(SortSegmentsI64Asc);
 }  // namespace
 
 void Sorter::operator()(int64_t* HWY_RESTRICT keys, size_t n,
                         SortAscending) const {
-  HWY_DYNAMIC_DISPATCH(SortI64Asc)(keys, n, Get<int64_t>());
+  HWY_DYNAMIC_DISPATCH(SortI64Asc)
+  (keys, n, Get<int64_t>(), detect_presorted_, /*stats=*/nullptr);
+}
+
+void Sorter::operator()(int64_t* HWY_RESTRICT keys, size_t n,
+                        SortAscending, SortStats& stats) const {
+  HWY_DYNAMIC_DISPATCH(SortI64Asc)
+  (keys, n, Get<int64_t>(), detect_presorted_, &stats);
+}
+
+void Sorter::operator()(int64_t* HWY_RESTRICT keys, size_t n,
+                        SortAscending, ThreadPool& pool) const {
+  HWY_DYNAMIC_DISPATCH(SortI64AscParallel)(keys, n, pool);
+}
+
+void Sorter::PartialSort(int64_t* HWY_RESTRICT keys, size_t n, size_t k,
+                         SortAscending) const {
+  HWY_DYNAMIC_DISPATCH(PartialSortI64Asc)(keys, n, k, Get<int64_t>());
+}
+
+void Sorter::Select(int64_t* HWY_RESTRICT keys, size_t n, size_t nth,
+                    SortAscending) const {
+  HWY_DYNAMIC_DISPATCH(SelectI64Asc)(keys, n, nth, Get<int64_t>());
+}
+
+void Sorter::Merge(const int64_t* HWY_RESTRICT a, size_t na,
+                   const int64_t* HWY_RESTRICT b, size_t nb,
+                   int64_t* HWY_RESTRICT out, SortAscending) const {
+  HWY_DYNAMIC_DISPATCH(MergeI64Asc)(a, na, b, nb, out);
+}
+
+void Sorter::SortSegments(int64_t* HWY_RESTRICT keys,
+                          const size_t* HWY_RESTRICT offsets,
+                          size_t num_segments, SortAscending) const {
+  HWY_DYNAMIC_DISPATCH(SortSegmentsI64Asc)
+  (keys, offsets, num_segments, Get<int64_t>());
 }
 
 }  // namespace hwy
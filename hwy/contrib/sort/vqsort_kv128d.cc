@@ -31,15 +31,95 @@ namespace hwy {
 namespace HWY_NAMESPACE {
 
 void SortKV128Desc(uint64_t* HWY_RESTRICT keys, size_t num,
-                   uint64_t* HWY_RESTRICT buf) {
+                   uint64_t* HWY_RESTRICT buf, bool detect_presorted,
+                   SortStats* stats) {
 #if VQSORT_ENABLED
   SortTag<uint64_t> d;
   detail::SharedTraits<detail::Traits128<detail::OrderDescendingKV128>> st;
-  Sort(d, st, keys, num, buf);
+  Sort(d, st, keys, num, buf, detect_presorted, stats);
 #else
   (void) keys;
   (void) num;
   (void) buf;
+  (void) detect_presorted;
+  (void) stats;
+  HWY_ASSERT(0);
+#endif
+}
+
+void SortKV128DescParallel(uint64_t* HWY_RESTRICT keys, size_t num,
+                           ThreadPool& pool) {
+#if VQSORT_ENABLED
+  SortTag<uint64_t> d;
+  detail::SharedTraits<detail::Traits128<detail::OrderDescendingKV128>> st;
+  SortParallel(d, st, keys, num, pool);
+#else
+  (void) keys;
+  (void) num;
+  (void) pool;
+  HWY_ASSERT(0);
+#endif
+}
+
+void PartialSortKV128Desc(uint64_t* HWY_RESTRICT keys, size_t num, size_t k,
+                          uint64_t* HWY_RESTRICT buf) {
+#if VQSORT_ENABLED
+  SortTag<uint64_t> d;
+  detail::SharedTraits<detail::Traits128<detail::OrderDescendingKV128>> st;
+  PartialSort(d, st, keys, num, k, buf);
+#else
+  (void) keys;
+  (void) num;
+  (void) k;
+  (void) buf;
+  HWY_ASSERT(0);
+#endif
+}
+
+void SelectKV128Desc(uint64_t* HWY_RESTRICT keys, size_t num, size_t nth,
+                     uint64_t* HWY_RESTRICT buf) {
+#if VQSORT_ENABLED
+  SortTag<uint64_t> d;
+  detail::SharedTraits<detail::Traits128<detail::OrderDescendingKV128>> st;
+  Select(d, st, keys, num, nth, buf);
+#else
+  (void) keys;
+  (void) num;
+  (void) nth;
+  (void) buf;
+  HWY_ASSERT(0);
+#endif
+}
+
+void MergeKV128Desc(const uint64_t* HWY_RESTRICT a, size_t na,
+                    const uint64_t* HWY_RESTRICT b, size_t nb,
+                    uint64_t* HWY_RESTRICT out) {
+#if VQSORT_ENABLED
+  SortTag<uint64_t> d;
+  detail::SharedTraits<detail::Traits128<detail::OrderDescendingKV128>> st;
+  Merge(d, st, a, na, b, nb, out);
+#else
+  (void) a;
+  (void) na;
+  (void) b;
+  (void) nb;
+  (void) out;
+  HWY_ASSERT(0);
+#endif
+}
+
+void SortSegmentsKV128Desc(uint64_t* HWY_RESTRICT keys,
+                           const size_t* HWY_RESTRICT offsets,
+                           size_t num_segments, uint64_t* HWY_RESTRICT buf) {
+#if VQSORT_ENABLED
+  SortTag<uint64_t> d;
+  detail::SharedTraits<detail::Traits128<detail::OrderDescendingKV128>> st;
+  SortSegments(d, st, keys, offsets, num_segments, buf);
+#else
+  (void) keys;
+  (void) offsets;
+  (void) num_segments;
+  (void) buf;
   HWY_ASSERT(0);
 #endif
 }
@@ -53,12 +133,59 @@ HWY_AFTER_NAMESPACE();
 namespace hwy {
 namespace {
 HWY_EXPORT(SortKV128Desc);
+HWY_EXPORT(SortKV128DescParallel);
+HWY_EXPORT(PartialSortKV128Desc);
+HWY_EXPORT(SelectKV128Desc);
+HWY_EXPORT(MergeKV128Desc);
+HWY_EXPORT(SortSegmentsKV128Desc);
 }  // namespace
 
 void Sorter::operator()(K64V64* HWY_RESTRICT keys, size_t n,
                         SortDescending) const {
   HWY_DYNAMIC_DISPATCH(SortKV128Desc)
-  (reinterpret_cast<uint64_t*>(keys), n * 2, Get<uint64_t>());
+  (reinterpret_cast<uint64_t*>(keys), n * 2, Get<uint64_t>(), detect_presorted_,
+   /*stats=*/nullptr);
+}
+
+void Sorter::operator()(K64V64* HWY_RESTRICT keys, size_t n,
+                        SortDescending, SortStats& stats) const {
+  HWY_DYNAMIC_DISPATCH(SortKV128Desc)
+  (reinterpret_cast<uint64_t*>(keys), n * 2, Get<uint64_t>(), detect_presorted_,
+   &stats);
+}
+
+void Sorter::operator()(K64V64* HWY_RESTRICT keys, size_t n,
+                        SortDescending, ThreadPool& pool) const {
+  HWY_DYNAMIC_DISPATCH(SortKV128DescParallel)
+  (reinterpret_cast<uint64_t*>(keys), n * 2, pool);
+}
+
+void Sorter::PartialSort(K64V64* HWY_RESTRICT keys, size_t n, size_t k,
+                         SortDescending) const {
+  HWY_DYNAMIC_DISPATCH(PartialSortKV128Desc)
+  (reinterpret_cast<uint64_t*>(keys), n * 2, k * 2, Get<uint64_t>());
+}
+
+void Sorter::Select(K64V64* HWY_RESTRICT keys, size_t n, size_t nth,
+                    SortDescending) const {
+  HWY_DYNAMIC_DISPATCH(SelectKV128Desc)
+  (reinterpret_cast<uint64_t*>(keys), n * 2, nth * 2, Get<uint64_t>());
+}
+
+void Sorter::Merge(const K64V64* HWY_RESTRICT a, size_t na,
+                   const K64V64* HWY_RESTRICT b, size_t nb,
+                   K64V64* HWY_RESTRICT out, SortDescending) const {
+  HWY_DYNAMIC_DISPATCH(MergeKV128Desc)
+  (reinterpret_cast<const uint64_t*>(a), na * 2,
+   reinterpret_cast<const uint64_t*>(b), nb * 2,
+   reinterpret_cast<uint64_t*>(out));
+}
+
+void Sorter::SortSegments(K64V64* HWY_RESTRICT keys,
+                          const size_t* HWY_RESTRICT offsets,
+                          size_t num_segments, SortDescending) const {
+  HWY_DYNAMIC_DISPATCH(SortSegmentsKV128Desc)
+  (reinterpret_cast<uint64_t*>(keys), offsets, num_segments, Get<uint64_t>());
 }
 
 }  // namespace hwy
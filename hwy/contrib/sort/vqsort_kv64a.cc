@@ -0,0 +1,143 @@
+// Copyright 2022 Google LLC
+// SPDX-License-Identifier: Apache-2.0
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//      http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#include "hwy/contrib/sort/vqsort.h"
+
+#undef HWY_TARGET_INCLUDE
+// clang-format off
+// (avoid line break, which would prevent Copybara rules from matching)
+#define HWY_TARGET_INCLUDE "hwy/contrib/sort/vqsort_kv64a.cc"
+// clang-format on
+#include "hwy/foreach_target.h"
+
+// After foreach_target
+#include "hwy/contrib/sort/traits-inl.h"
+#include "hwy/contrib/sort/vqsort-inl.h"
+
+HWY_BEFORE_NAMESPACE();
+namespace hwy {
+namespace HWY_NAMESPACE {
+
+void SortKV64Asc(uint64_t* HWY_RESTRICT keys, size_t num,
+                 uint64_t* HWY_RESTRICT buf, bool detect_presorted,
+                 SortStats* stats) {
+  SortTag<uint64_t> d;
+  detail::SharedTraits<detail::TraitsLane<detail::OrderAscendingKV64>> st;
+  Sort(d, st, keys, num, buf, detect_presorted, stats);
+}
+
+void SortKV64AscParallel(uint64_t* HWY_RESTRICT keys, size_t num,
+                         ThreadPool& pool) {
+  SortTag<uint64_t> d;
+  detail::SharedTraits<detail::TraitsLane<detail::OrderAscendingKV64>> st;
+  SortParallel(d, st, keys, num, pool);
+}
+
+void PartialSortKV64Asc(uint64_t* HWY_RESTRICT keys, size_t num, size_t k,
+                        uint64_t* HWY_RESTRICT buf) {
+  SortTag<uint64_t> d;
+  detail::SharedTraits<detail::TraitsLane<detail::OrderAscendingKV64>> st;
+  PartialSort(d, st, keys, num, k, buf);
+}
+
+void SelectKV64Asc(uint64_t* HWY_RESTRICT keys, size_t num, size_t nth,
+                   uint64_t* HWY_RESTRICT buf) {
+  SortTag<uint64_t> d;
+  detail::SharedTraits<detail::TraitsLane<detail::OrderAscendingKV64>> st;
+  Select(d, st, keys, num, nth, buf);
+}
+
+void MergeKV64Asc(const uint64_t* HWY_RESTRICT a, size_t na,
+                  const uint64_t* HWY_RESTRICT b, size_t nb,
+                  uint64_t* HWY_RESTRICT out) {
+  SortTag<uint64_t> d;
+  detail::SharedTraits<detail::TraitsLane<detail::OrderAscendingKV64>> st;
+  Merge(d, st, a, na, b, nb, out);
+}
+
+void SortSegmentsKV64Asc(uint64_t* HWY_RESTRICT keys,
+                         const size_t* HWY_RESTRICT offsets,
+                         size_t num_segments, uint64_t* HWY_RESTRICT buf) {
+  SortTag<uint64_t> d;
+  detail::SharedTraits<detail::TraitsLane<detail::OrderAscendingKV64>> st;
+  SortSegments(d, st, keys, offsets, num_segments, buf);
+}
+
+// NOLINTNEXTLINE(google-readability-namespace-comments)
+}  // namespace HWY_NAMESPACE
+}  // namespace hwy
+HWY_AFTER_NAMESPACE();
+
+#if HWY_ONCE
+namespace hwy {
+namespace {
+HWY_EXPORT(SortKV64Asc);
+HWY_EXPORT(SortKV64AscParallel);
+HWY_EXPORT(PartialSortKV64Asc);
+HWY_EXPORT(SelectKV64Asc);
+HWY_EXPORT(MergeKV64Asc);
+HWY_EXPORT(SortSegmentsKV64Asc);
+}  // namespace
+
+void Sorter::operator()(K32V32* HWY_RESTRICT keys, size_t n,
+                        SortAscending) const {
+  HWY_DYNAMIC_DISPATCH(SortKV64Asc)
+  (reinterpret_cast<uint64_t*>(keys), n, Get<uint64_t>(), detect_presorted_,
+   /*stats=*/nullptr);
+}
+
+void Sorter::operator()(K32V32* HWY_RESTRICT keys, size_t n,
+                        SortAscending, SortStats& stats) const {
+  HWY_DYNAMIC_DISPATCH(SortKV64Asc)
+  (reinterpret_cast<uint64_t*>(keys), n, Get<uint64_t>(), detect_presorted_,
+   &stats);
+}
+
+void Sorter::operator()(K32V32* HWY_RESTRICT keys, size_t n,
+                        SortAscending, ThreadPool& pool) const {
+  HWY_DYNAMIC_DISPATCH(SortKV64AscParallel)
+  (reinterpret_cast<uint64_t*>(keys), n, pool);
+}
+
+void Sorter::PartialSort(K32V32* HWY_RESTRICT keys, size_t n, size_t k,
+                         SortAscending) const {
+  HWY_DYNAMIC_DISPATCH(PartialSortKV64Asc)
+  (reinterpret_cast<uint64_t*>(keys), n, k, Get<uint64_t>());
+}
+
+void Sorter::Select(K32V32* HWY_RESTRICT keys, size_t n, size_t nth,
+                    SortAscending) const {
+  HWY_DYNAMIC_DISPATCH(SelectKV64Asc)
+  (reinterpret_cast<uint64_t*>(keys), n, nth, Get<uint64_t>());
+}
+
+void Sorter::Merge(const K32V32* HWY_RESTRICT a, size_t na,
+                   const K32V32* HWY_RESTRICT b, size_t nb,
+                   K32V32* HWY_RESTRICT out, SortAscending) const {
+  HWY_DYNAMIC_DISPATCH(MergeKV64Asc)
+  (reinterpret_cast<const uint64_t*>(a), na,
+   reinterpret_cast<const uint64_t*>(b), nb,
+   reinterpret_cast<uint64_t*>(out));
+}
+
+void Sorter::SortSegments(K32V32* HWY_RESTRICT keys,
+                          const size_t* HWY_RESTRICT offsets,
+                          size_t num_segments, SortAscending) const {
+  HWY_DYNAMIC_DISPATCH(SortSegmentsKV64Asc)
+  (reinterpret_cast<uint64_t*>(keys), offsets, num_segments, Get<uint64_t>());
+}
+
+}  // namespace hwy
+#endif  // HWY_ONCE
@@ -0,0 +1,143 @@
+// Copyright 2022 Google LLC
+// SPDX-License-Identifier: Apache-2.0
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//      http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#include "hwy/contrib/sort/vqsort.h"
+
+#undef HWY_TARGET_INCLUDE
+// clang-format off
+// (avoid line break, which would prevent Copybara rules from matching)
+#define HWY_TARGET_INCLUDE "hwy/contrib/sort/vqsort_kv64d.cc"
+// clang-format on
+#include "hwy/foreach_target.h"
+
+// After foreach_target
+#include "hwy/contrib/sort/traits-inl.h"
+#include "hwy/contrib/sort/vqsort-inl.h"
+
+HWY_BEFORE_NAMESPACE();
+namespace hwy {
+namespace HWY_NAMESPACE {
+
+void SortKV64Desc(uint64_t* HWY_RESTRICT keys, size_t num,
+                  uint64_t* HWY_RESTRICT buf, bool detect_presorted,
+                  SortStats* stats) {
+  SortTag<uint64_t> d;
+  detail::SharedTraits<detail::TraitsLane<detail::OrderDescendingKV64>> st;
+  Sort(d, st, keys, num, buf, detect_presorted, stats);
+}
+
+void SortKV64DescParallel(uint64_t* HWY_RESTRICT keys, size_t num,
+                          ThreadPool& pool) {
+  SortTag<uint64_t> d;
+  detail::SharedTraits<detail::TraitsLane<detail::OrderDescendingKV64>> st;
+  SortParallel(d, st, keys, num, pool);
+}
+
+void PartialSortKV64Desc(uint64_t* HWY_RESTRICT keys, size_t num, size_t k,
+                         uint64_t* HWY_RESTRICT buf) {
+  SortTag<uint64_t> d;
+  detail::SharedTraits<detail::TraitsLane<detail::OrderDescendingKV64>> st;
+  PartialSort(d, st, keys, num, k, buf);
+}
+
+void SelectKV64Desc(uint64_t* HWY_RESTRICT keys, size_t num, size_t nth,
+                    uint64_t* HWY_RESTRICT buf) {
+  SortTag<uint64_t> d;
+  detail::SharedTraits<detail::TraitsLane<detail::OrderDescendingKV64>> st;
+  Select(d, st, keys, num, nth, buf);
+}
+
+void MergeKV64Desc(const uint64_t* HWY_RESTRICT a, size_t na,
+                   const uint64_t* HWY_RESTRICT b, size_t nb,
+                   uint64_t* HWY_RESTRICT out) {
+  SortTag<uint64_t> d;
+  detail::SharedTraits<detail::TraitsLane<detail::OrderDescendingKV64>> st;
+  Merge(d, st, a, na, b, nb, out);
+}
+
+void SortSegmentsKV64Desc(uint64_t* HWY_RESTRICT keys,
+                          const size_t* HWY_RESTRICT offsets,
+                          size_t num_segments, uint64_t* HWY_RESTRICT buf) {
+  SortTag<uint64_t> d;
+  detail::SharedTraits<detail::TraitsLane<detail::OrderDescendingKV64>> st;
+  SortSegments(d, st, keys, offsets, num_segments, buf);
+}
+
+// NOLINTNEXTLINE(google-readability-namespace-comments)
+}  // namespace HWY_NAMESPACE
+}  // namespace hwy
+HWY_AFTER_NAMESPACE();
+
+#if HWY_ONCE
+namespace hwy {
+namespace {
+HWY_EXPORT(SortKV64Desc);
+HWY_EXPORT(SortKV64DescParallel);
+HWY_EXPORT(PartialSortKV64Desc);
+HWY_EXPORT(SelectKV64Desc);
+HWY_EXPORT(MergeKV64Desc);
+HWY_EXPORT(SortSegmentsKV64Desc);
+}  // namespace
+
+void Sorter::operator()(K32V32* HWY_RESTRICT keys, size_t n,
+                        SortDescending) const {
+  HWY_DYNAMIC_DISPATCH(SortKV64Desc)
+  (reinterpret_cast<uint64_t*>(keys), n, Get<uint64_t>(), detect_presorted_,
+   /*stats=*/nullptr);
+}
+
+void Sorter::operator()(K32V32* HWY_RESTRICT keys, size_t n,
+                        SortDescending, SortStats& stats) const {
+  HWY_DYNAMIC_DISPATCH(SortKV64Desc)
+  (reinterpret_cast<uint64_t*>(keys), n, Get<uint64_t>(), detect_presorted_,
+   &stats);
+}
+
+void Sorter::operator()(K32V32* HWY_RESTRICT keys, size_t n,
+                        SortDescending, ThreadPool& pool) const {
+  HWY_DYNAMIC_DISPATCH(SortKV64DescParallel)
+  (reinterpret_cast<uint64_t*>(keys), n, pool);
+}
+
+void Sorter::PartialSort(K32V32* HWY_RESTRICT keys, size_t n, size_t k,
+                         SortDescending) const {
+  HWY_DYNAMIC_DISPATCH(PartialSortKV64Desc)
+  (reinterpret_cast<uint64_t*>(keys), n, k, Get<uint64_t>());
+}
+
+void Sorter::Select(K32V32* HWY_RESTRICT keys, size_t n, size_t nth,
+                    SortDescending) const {
+  HWY_DYNAMIC_DISPATCH(SelectKV64Desc)
+  (reinterpret_cast<uint64_t*>(keys), n, nth, Get<uint64_t>());
+}
+
+void Sorter::Merge(const K32V32* HWY_RESTRICT a, size_t na,
+                   const K32V32* HWY_RESTRICT b, size_t nb,
+                   K32V32* HWY_RESTRICT out, SortDescending) const {
+  HWY_DYNAMIC_DISPATCH(MergeKV64Desc)
+  (reinterpret_cast<const uint64_t*>(a), na,
+   reinterpret_cast<const uint64_t*>(b), nb,
+   reinterpret_cast<uint64_t*>(out));
+}
+
+void Sorter::SortSegments(K32V32* HWY_RESTRICT keys,
+                          const size_t* HWY_RESTRICT offsets,
+                          size_t num_segments, SortDescending) const {
+  HWY_DYNAMIC_DISPATCH(SortSegmentsKV64Desc)
+  (reinterpret_cast<uint64_t*>(keys), offsets, num_segments, Get<uint64_t>());
+}
+
+}  // namespace hwy
+#endif  // HWY_ONCE
@@ -0,0 +1,228 @@
+// Copyright 2022 Google LLC
+// SPDX-License-Identifier: Apache-2.0
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//      http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+// ArgSortStrings is a most-significant-digit radix sort whose digits are 8-byte
+// big-endian string prefixes, each sorted by vqsort. Every string is
+// represented by a K64V64 whose key is the prefix at the current depth and
+// whose value is the string index. After sorting a range by key, each run of
+// equal keys is resolved: strings that end within these 8 bytes are identical
+// except for their length, so they are ordered by length and then index. The
+// remaining strings are longer than all of those; they receive their next
+// prefix and are pushed as a new range. Small ranges are instead sorted by
+// comparing the string suffixes.
+
+#include <stdint.h>
+#include <string.h>  // memcmp
+
+#include <algorithm>  // std::sort
+#include <vector>
+
+#include "hwy/aligned_allocator.h"
+#include "hwy/base.h"
+#include "hwy/contrib/sort/vqsort.h"
+
+namespace hwy {
+namespace {
+
+// Ranges up to this size are sorted by std::sort with a suffix comparison,
+// which is cheaper than vqsort plus a scan for runs of equal prefixes.
+constexpr size_t kMaxCompareSort = 16;
+
+// Within a run of equal prefixes, the key of a string is its length class in
+// the upper kClassShift bits and its index in the lower bits.
+constexpr int kClassShift = 60;
+
+// Returns s[depth, depth + 8) as a big-endian u64, padded with zeros if the
+// string ends before that.
+HWY_INLINE uint64_t Prefix(const uint8_t* HWY_RESTRICT s, size_t len,
+                           size_t depth) {
+  if (len >= depth + 8) {
+    const uint8_t* p = s + depth;
+    return (uint64_t{p[0]} << 56) | (uint64_t{p[1]} << 48) |
+           (uint64_t{p[2]} << 40) | (uint64_t{p[3]} << 32) |
+           (uint64_t{p[4]} << 24) | (uint64_t{p[5]} << 16) |
+           (uint64_t{p[6]} << 8) | uint64_t{p[7]};
+  }
+  uint64_t bits = 0;
+  for (size_t i = depth; i < len; ++i) {
+    bits |= uint64_t{s[i]} << (8 * (7 - (i - depth)));
+  }
+  return bits;
+}
+
+template <class Order>
+class StringArgSorter {
+ public:
+  StringArgSorter(const Sorter& sorter, const char* const* strings,
+                  const size_t* lengths, Order order)
+      : sorter_(sorter), strings_(strings), lengths_(lengths), order_(order) {}
+
+  template <typename TI>
+  void operator()(size_t n, TI* HWY_RESTRICT indices) {
+    auto kv = AllocateAligned<K64V64>(n);
+    HWY_ASSERT(kv);
+    for (size_t i = 0; i < n; ++i) {
+      kv[i].key = PrefixKey(i, 0);
+      kv[i].value = i;
+    }
+
+    ranges_.push_back(Range{0, n, 0});
+    while (!ranges_.empty()) {
+      const Range r = ranges_.back();
+      ranges_.pop_back();
+      SortRange(kv.get(), r);
+    }
+
+    for (size_t i = 0; i < n; ++i) {
+      indices[i] = static_cast<TI>(kv[i].value);
+    }
+  }
+
+ private:
+  // Keys in kv[begin, end) are the prefixes at `depth`, and all strings there
+  // are equal before `depth`.
+  struct Range {
+    size_t begin;
+    size_t end;
+    size_t depth;
+  };
+
+  const uint8_t* Bytes(uint64_t index) const {
+    return reinterpret_cast<const uint8_t*>(strings_[index]);
+  }
+
+  uint64_t PrefixKey(uint64_t index, size_t depth) const {
+    const uint64_t bits = Prefix(Bytes(index), lengths_[index], depth);
+    return order_.IsAscending() ? bits : ~bits;
+  }
+
+  // Whether string `a` precedes `b`, given that they are equal before
+  // `depth`. Equal strings are ordered by index.
+  bool Precedes(const K64V64& a, const K64V64& b, size_t depth) const {
+    const size_t len_a = lengths_[a.value];
+    const size_t len_b = lengths_[b.value];
+    const size_t len = HWY_MIN(len_a, len_b);
+    // Empty strings may have null pointers, which memcmp must not receive.
+    int cmp = len == depth ? 0
+                           : memcmp(Bytes(a.value) + depth,
+                                    Bytes(b.value) + depth, len - depth);
+    if (cmp == 0 && len_a != len_b) cmp = len_a < len_b ? -1 : 1;
+    if (cmp == 0) return a.value < b.value;
+    return order_.IsAscending() ? cmp < 0 : cmp > 0;
+  }
+
+  void SortRange(K64V64* HWY_RESTRICT kv, const Range& r) {
+    const size_t depth = r.depth;
+    if (r.end - r.begin <= kMaxCompareSort) {
+      std::sort(kv + r.begin, kv + r.end,
+                [this, depth](const K64V64& a, const K64V64& b) {
+                  return Precedes(a, b, depth);
+                });
+      return;
+    }
+
+    sorter_(kv + r.begin, r.end - r.begin, SortAscending());
+    size_t i = r.begin;
+    while (i < r.end) {
+      size_t end = i + 1;
+      while (end < r.end && kv[end].key == kv[i].key) ++end;
+      if (end - i > 1) {
+        ResolveRun(kv, i, end, depth);
+      }
+      i = end;
+    }
+  }
+
+  // Orders kv[begin, end), whose prefixes at `depth` are all equal.
+  void ResolveRun(K64V64* HWY_RESTRICT kv, size_t begin, size_t end,
+                  size_t depth) {
+    // Strings that end within the prefix are ordered by their length; longer
+    // strings follow (precede if descending) all of them and are ordered by
+    // their next prefix. The class is thus the length, or 9 for longer.
+    size_t num_longer = 0;
+    for (size_t i = begin; i < end; ++i) {
+      const uint64_t len = lengths_[kv[i].value] - depth;
+      uint64_t length_class = HWY_MIN(len, uint64_t{9});
+      if (!order_.IsAscending()) length_class = 9 - length_class;
+      num_longer += static_cast<size_t>(len > 8);
+      kv[i].key = (length_class << kClassShift) | kv[i].value;
+    }
+
+    size_t longer_begin = begin;
+    if (num_longer != end - begin) {
+      if (end - begin <= kMaxCompareSort) {
+        std::sort(kv + begin, kv + end);
+      } else {
+        sorter_(kv + begin, end - begin, SortAscending());
+      }
+      if (order_.IsAscending()) longer_begin = end - num_longer;
+    }
+    if (num_longer < 2) return;
+
+    const size_t longer_end = longer_begin + num_longer;
+    for (size_t i = longer_begin; i < longer_end; ++i) {
+      kv[i].key = PrefixKey(kv[i].value, depth + 8);
+    }
+    ranges_.push_back(Range{longer_begin, longer_end, depth + 8});
+  }
+
+  const Sorter& sorter_;
+  const char* const* strings_;
+  const size_t* lengths_;
+  Order order_;
+  std::vector<Range> ranges_;
+};
+
+template <typename TI, class Order>
+void ArgSortStringsImpl(const Sorter& sorter,
+                        const char* const* HWY_RESTRICT strings,
+                        const size_t* HWY_RESTRICT lengths, size_t n,
+                        TI* HWY_RESTRICT indices, Order order) {
+  // Indices must be representable, also next to the length class.
+  HWY_DASSERT(n == 0 || static_cast<uint64_t>(n - 1) <=
+                            static_cast<uint64_t>(LimitsMax<TI>()));
+  HWY_DASSERT(static_cast<uint64_t>(n) < (uint64_t{1} << kClassShift));
+  if (n == 0) return;
+  StringArgSorter<Order>(sorter, strings, lengths, order)(n, indices);
+}
+
+}  // namespace
+
+void Sorter::ArgSortStrings(const char* const* HWY_RESTRICT strings,
+                            const size_t* HWY_RESTRICT lengths, size_t n,
+                            uint32_t* HWY_RESTRICT indices,
+                            SortAscending order) const {
+  ArgSortStringsImpl(*this, strings, lengths, n, indices, order);
+}
+void Sorter::ArgSortStrings(const char* const* HWY_RESTRICT strings,
+                            const size_t* HWY_RESTRICT lengths, size_t n,
+                            uint32_t* HWY_RESTRICT indices,
+                            SortDescending order) const {
+  ArgSortStringsImpl(*this, strings, lengths, n, indices, order);
+}
+void Sorter::ArgSortStrings(const char* const* HWY_RESTRICT strings,
+                            const size_t* HWY_RESTRICT lengths, size_t n,
+                            uint64_t* HWY_RESTRICT indices,
+                            SortAscending order) const {
+  ArgSortStringsImpl(*this, strings, lengths, n, indices, order);
+}
+void Sorter::ArgSortStrings(const char* const* HWY_RESTRICT strings,
+                            const size_t* HWY_RESTRICT lengths, size_t n,
+                            uint64_t* HWY_RESTRICT indices,
+                            SortDescending order) const {
+  ArgSortStringsImpl(*this, strings, lengths, n, indices, order);
+}
+
+}  // namespace hwy
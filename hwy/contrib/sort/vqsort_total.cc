@@ -0,0 +1,86 @@
+// Copyright 2022 Google LLC
+// SPDX-License-Identifier: Apache-2.0
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//      http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+// SortTotalOrder converts floating-point keys in place to signed integers with
+// the same order as the IEEE 754 totalOrder predicate (see TotalOrderSigned in
+// shared-inl.h), sorts those with the existing i32/i64 vqsort and then converts
+// them back. Both conversions are a single vectorized pass.
+
+#include "hwy/contrib/sort/vqsort.h"
+
+#undef HWY_TARGET_INCLUDE
+#define HWY_TARGET_INCLUDE "hwy/contrib/sort/vqsort_total.cc"
+#include "hwy/foreach_target.h"
+
+// After foreach_target
+#include "hwy/contrib/sort/shared-inl.h"
+
+HWY_BEFORE_NAMESPACE();
+namespace hwy {
+namespace HWY_NAMESPACE {
+
+void ConvertTotalOrderI32(int32_t* HWY_RESTRICT keys, size_t num) {
+  detail::ConvertTotalOrder(keys, num);
+}
+void ConvertTotalOrderI64(int64_t* HWY_RESTRICT keys, size_t num) {
+  detail::ConvertTotalOrder(keys, num);
+}
+
+// NOLINTNEXTLINE(google-readability-namespace-comments)
+}  // namespace HWY_NAMESPACE
+}  // namespace hwy
+HWY_AFTER_NAMESPACE();
+
+#if HWY_ONCE
+namespace hwy {
+namespace {
+HWY_EXPORT(ConvertTotalOrderI32);
+HWY_EXPORT(ConvertTotalOrderI64);
+}  // namespace
+
+void Sorter::SortTotalOrder(float* HWY_RESTRICT keys, size_t n,
+                            SortAscending order) const {
+  int32_t* bits = reinterpret_cast<int32_t*>(keys);
+  HWY_DYNAMIC_DISPATCH(ConvertTotalOrderI32)(bits, n);
+  (*this)(bits, n, order);
+  HWY_DYNAMIC_DISPATCH(ConvertTotalOrderI32)(bits, n);
+}
+
+void Sorter::SortTotalOrder(float* HWY_RESTRICT keys, size_t n,
+                            SortDescending order) const {
+  int32_t* bits = reinterpret_cast<int32_t*>(keys);
+  HWY_DYNAMIC_DISPATCH(ConvertTotalOrderI32)(bits, n);
+  (*this)(bits, n, order);
+  HWY_DYNAMIC_DISPATCH(ConvertTotalOrderI32)(bits, n);
+}
+
+void Sorter::SortTotalOrder(double* HWY_RESTRICT keys, size_t n,
+                            SortAscending order) const {
+  int64_t* bits = reinterpret_cast<int64_t*>(keys);
+  HWY_DYNAMIC_DISPATCH(ConvertTotalOrderI64)(bits, n);
+  (*this)(bits, n, order);
+  HWY_DYNAMIC_DISPATCH(ConvertTotalOrderI64)(bits, n);
+}
+
+void Sorter::SortTotalOrder(double* HWY_RESTRICT keys, size_t n,
+                            SortDescending order) const {
+  int64_t* bits = reinterpret_cast<int64_t*>(keys);
+  HWY_DYNAMIC_DISPATCH(ConvertTotalOrderI64)(bits, n);
+  (*this)(bits, n, order);
+  HWY_DYNAMIC_DISPATCH(ConvertTotalOrderI64)(bits, n);
+}
+
+}  // namespace hwy
+#endif  // HWY_ONCE
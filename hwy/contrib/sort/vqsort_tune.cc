@@ -0,0 +1,265 @@
+// Copyright 2022 Google LLC
+// SPDX-License-Identifier: Apache-2.0
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//      http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+// SortTuning selects among instantiations of Partition and ChoosePivot and
+// sets the BaseCase threshold at runtime (see vqsort-inl.h). Autotune sorts the
+// same random inputs with each combination of supported values, interleaved
+// over several rounds so that frequency changes affect all of them alike, and
+// keeps the default unless another combination is clearly faster. Each
+// combination is passed to Sort directly, so sorts on other threads continue
+// to use Sorter::Tuning().
+
+#include <stdint.h>
+#include <stdio.h>
+#include <string.h>  // memcpy
+
+#include <chrono>  // NOLINT
+#include <limits>
+
+#include "hwy/aligned_allocator.h"
+#include "hwy/contrib/sort/vqsort.h"
+
+#undef HWY_TARGET_INCLUDE
+#define HWY_TARGET_INCLUDE "hwy/contrib/sort/vqsort_tune.cc"
+#include "hwy/foreach_target.h"
+
+// After foreach_target
+#include "hwy/contrib/sort/traits-inl.h"
+#include "hwy/contrib/sort/vqsort-inl.h"
+
+HWY_BEFORE_NAMESPACE();
+namespace hwy {
+namespace HWY_NAMESPACE {
+
+uint32_t TuningTarget() { return static_cast<uint32_t>(HWY_TARGET); }
+
+void SortTunedU32(uint32_t* HWY_RESTRICT keys, size_t num,
+                  uint32_t* HWY_RESTRICT buf, const SortTuning& tuning) {
+  SortTag<uint32_t> d;
+  detail::SharedTraits<detail::TraitsLane<detail::OrderAscending<uint32_t>>> st;
+  Sort(d, st, keys, num, buf, /*detect_presorted=*/false, /*stats=*/nullptr,
+       &tuning);
+}
+
+void SortTunedU64(uint64_t* HWY_RESTRICT keys, size_t num,
+                  uint64_t* HWY_RESTRICT buf, const SortTuning& tuning) {
+  SortTag<uint64_t> d;
+  detail::SharedTraits<detail::TraitsLane<detail::OrderAscending<uint64_t>>> st;
+  Sort(d, st, keys, num, buf, /*detect_presorted=*/false, /*stats=*/nullptr,
+       &tuning);
+}
+
+// NOLINTNEXTLINE(google-readability-namespace-comments)
+}  // namespace HWY_NAMESPACE
+}  // namespace hwy
+HWY_AFTER_NAMESPACE();
+
+#if HWY_ONCE
+namespace hwy {
+namespace {
+HWY_EXPORT(TuningTarget);
+HWY_EXPORT(SortTunedU32);
+HWY_EXPORT(SortTunedU64);
+
+// Returns the name of the instruction set that the sorts dispatch to.
+const char* TuningTargetName() {
+  return TargetName(HWY_DYNAMIC_DISPATCH(TuningTarget)());
+}
+
+// Sizes of the benchmark inputs: large arrays of both key sizes, plus many
+// small arrays whose sorts are dominated by the base case.
+constexpr size_t kNum32 = size_t{1} << 20;
+constexpr size_t kNum64 = size_t{1} << 19;
+constexpr size_t kNumSmall = 256;
+constexpr size_t kSmallSize = size_t{1} << 12;
+constexpr size_t kRounds = 3;
+
+// block_partition = 1 is only a candidate if it is compiled.
+constexpr uint32_t kNumBlockValues = 1 + VQSORT_BLOCK_PARTITION;
+constexpr size_t kMaxCandidates = 3 * 2 * 2 * kNumBlockValues;
+
+// Another tuning must be at least this much faster than the default.
+constexpr double kMinSpeedup = 1.02;
+
+uint64_t SplitMix64(uint64_t& state) {
+  uint64_t z = (state += 0x9E3779B97F4A7C15ull);
+  z = (z ^ (z >> 30)) * 0xBF58476D1CE4E5B9ull;
+  z = (z ^ (z >> 27)) * 0x94D049BB133111EBull;
+  return z ^ (z >> 31);
+}
+
+void SortTuned(uint32_t* HWY_RESTRICT keys, size_t num,
+               uint32_t* HWY_RESTRICT buf, const SortTuning& tuning) {
+  HWY_DYNAMIC_DISPATCH(SortTunedU32)(keys, num, buf, tuning);
+}
+
+void SortTuned(uint64_t* HWY_RESTRICT keys, size_t num,
+               uint64_t* HWY_RESTRICT buf, const SortTuning& tuning) {
+  HWY_DYNAMIC_DISPATCH(SortTunedU64)(keys, num, buf, tuning);
+}
+
+// Returns the time to sort a copy of input[0, num) with `tuning` as
+// `num_arrays` separate arrays of equal size.
+template <typename T>
+double SecondsToSort(const SortTuning& tuning, const T* input, T* keys,
+                     size_t num, size_t num_arrays, T* buf) {
+  memcpy(keys, input, num * sizeof(T));
+  const size_t size = num / num_arrays;
+  const auto t0 = std::chrono::steady_clock::now();
+  for (size_t i = 0; i < num_arrays; ++i) {
+    SortTuned(keys + i * size, size, buf, tuning);
+  }
+  const auto t1 = std::chrono::steady_clock::now();
+  return std::chrono::duration<double>(t1 - t0).count();
+}
+
+}  // namespace
+
+SortTuning Sorter::tuning_;
+
+bool Sorter::SetTuning(const SortTuning& tuning) {
+  if (!tuning.IsValid()) return false;
+  tuning_ = tuning;
+  return true;
+}
+
+SortTuning Sorter::Autotune() {
+  SortTuning candidates[kMaxCandidates];
+  size_t num_candidates = 0;
+  size_t default_index = 0;
+  // stream_partition_mib keeps its default because these inputs are too small
+  // to benefit from non-temporal stores, and radix_max_passes because only the
+  // caller can decide whether O(n) scratch space is acceptable.
+  for (uint32_t rows : {4u, 8u, 16u}) {
+    for (uint32_t unroll : {2u, 4u}) {
+      for (uint32_t chunks : {3u, 9u}) {
+        for (uint32_t block = 0; block < kNumBlockValues; ++block) {
+          SortTuning& tuning = candidates[num_candidates];
+          tuning.base_case_rows = rows;
+          tuning.partition_unroll = unroll;
+          tuning.pivot_chunks = chunks;
+          tuning.block_partition = block;
+          const SortTuning defaults;
+          if (rows == defaults.base_case_rows &&
+              unroll == defaults.partition_unroll &&
+              chunks == defaults.pivot_chunks &&
+              block == defaults.block_partition) {
+            default_index = num_candidates;
+          }
+          ++num_candidates;
+        }
+      }
+    }
+  }
+
+  auto input32 = AllocateAligned<uint32_t>(kNum32);
+  auto keys32 = AllocateAligned<uint32_t>(kNum32);
+  auto input64 = AllocateAligned<uint64_t>(kNum64);
+  auto keys64 = AllocateAligned<uint64_t>(kNum64);
+  HWY_ASSERT(input32 && keys32 && input64 && keys64);
+  uint64_t state = 0x243F6A8885A308D3ull;  // Fixed for comparable results.
+  for (size_t i = 0; i < kNum32; ++i) {
+    input32[i] = static_cast<uint32_t>(SplitMix64(state));
+  }
+  for (size_t i = 0; i < kNum64; ++i) {
+    input64[i] = SplitMix64(state);
+  }
+
+  // Provides the buffers that Sort requires on targets with scalable vectors.
+  const Sorter sorter;
+  uint32_t* buf32 = sorter.Get<uint32_t>();
+  uint64_t* buf64 = sorter.Get<uint64_t>();
+  double seconds[kMaxCandidates];
+  for (double& s : seconds) s = std::numeric_limits<double>::max();
+  for (size_t round = 0; round < kRounds; ++round) {
+    for (size_t c = 0; c < num_candidates; ++c) {
+      const SortTuning& tuning = candidates[c];
+      const double total =
+          SecondsToSort(tuning, input32.get(), keys32.get(), kNum32, 1,
+                        buf32) +
+          SecondsToSort(tuning, input64.get(), keys64.get(), kNum64, 1,
+                        buf64) +
+          SecondsToSort(tuning, input32.get(), keys32.get(),
+                        kNumSmall * kSmallSize, kNumSmall, buf32);
+      seconds[c] = HWY_MIN(seconds[c], total);
+    }
+  }
+
+  size_t best = default_index;
+  for (size_t c = 0; c < num_candidates; ++c) {
+    if (seconds[c] * kMinSpeedup < seconds[default_index] &&
+        seconds[c] < seconds[best]) {
+      best = c;
+    }
+  }
+  return candidates[best];
+}
+
+bool Sorter::SaveTuning(const char* path, const SortTuning& tuning) {
+  FILE* file = fopen(path, "w");
+  if (file == nullptr) return false;
+  const int written = fprintf(
+      file,
+      "# vqsort tuning, see Sorter::Autotune\n"
+      "target=%s\nbase_case_rows=%u\npartition_unroll=%u\npivot_chunks=%u\n"
+      "block_partition=%u\nstream_partition_mib=%u\nradix_max_passes=%u\n",
+      TuningTargetName(), tuning.base_case_rows, tuning.partition_unroll,
+      tuning.pivot_chunks, tuning.block_partition, tuning.stream_partition_mib,
+      tuning.radix_max_passes);
+  return fclose(file) == 0 && written > 0;
+}
+
+bool Sorter::LoadTuning(const char* path) {
+  FILE* file = fopen(path, "r");
+  if (file == nullptr) return false;
+  SortTuning tuning;
+  bool same_target = false;
+  bool ok = true;
+  char line[128];
+  while (ok && fgets(line, sizeof(line), file) != nullptr) {
+    if (line[0] == '#' || line[0] == '\n') continue;
+    char name[64];
+    char value[64];
+    if (sscanf(line, "%63[^=]=%63s", name, value) != 2) {
+      ok = false;
+    } else if (strcmp(name, "target") == 0) {
+      same_target = strcmp(value, TuningTargetName()) == 0;
+    } else {
+      unsigned number = 0;
+      ok = sscanf(value, "%u", &number) == 1;
+      if (strcmp(name, "base_case_rows") == 0) {
+        tuning.base_case_rows = number;
+      } else if (strcmp(name, "partition_unroll") == 0) {
+        tuning.partition_unroll = number;
+      } else if (strcmp(name, "pivot_chunks") == 0) {
+        tuning.pivot_chunks = number;
+      } else if (strcmp(name, "block_partition") == 0) {
+        tuning.block_partition = number;
+      } else if (strcmp(name, "stream_partition_mib") == 0) {
+        tuning.stream_partition_mib = number;
+      } else if (strcmp(name, "radix_max_passes") == 0) {
+        tuning.radix_max_passes = number;
+      } else {
+        ok = false;
+      }
+    }
+  }
+  fclose(file);
+  // A tuning measured for another instruction set may be counterproductive.
+  return ok && same_target && SetTuning(tuning);
+}
+
+}  // namespace hwy
+#endif  // HWY_ONCE
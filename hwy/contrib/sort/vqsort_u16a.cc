@@ -28,10 +28,48 @@ namespace hwy {
 namespace HWY_NAMESPACE {
 
 void SortU16Asc(uint16_t* HWY_RESTRICT keys, size_t num,
-                uint16_t* HWY_RESTRICT buf) {
+                uint16_t* HWY_RESTRICT buf, bool detect_presorted,
+                SortStats* stats) {
   SortTag<uint16_t> d;
   detail::SharedTraits<detail::TraitsLane<detail::OrderAscending<uint16_t>>> st;
-  Sort(d, st, keys, num, buf);
+  Sort(d, st, keys, num, buf, detect_presorted, stats);
+}
+
+void SortU16AscParallel(uint16_t* HWY_RESTRICT keys, size_t num,
+                        ThreadPool& pool) {
+  SortTag<uint16_t> d;
+  detail::SharedTraits<detail::TraitsLane<detail::OrderAscending<uint16_t>>> st;
+  SortParallel(d, st, keys, num, pool);
+}
+
+void PartialSortU16Asc(uint16_t* HWY_RESTRICT keys, size_t num, size_t k,
+                       uint16_t* HWY_RESTRICT buf) {
+  SortTag<uint16_t> d;
+  detail::SharedTraits<detail::TraitsLane<detail::OrderAscending<uint16_t>>> st;
+  PartialSort(d, st, keys, num, k, buf);
+}
+
+void SelectU16Asc(uint16_t* HWY_RESTRICT keys, size_t num, size_t nth,
+                  uint16_t* HWY_RESTRICT buf) {
+  SortTag<uint16_t> d;
+  detail::SharedTraits<detail::TraitsLane<detail::OrderAscending<uint16_t>>> st;
+  Select(d, st, keys, num, nth, buf);
+}
+
+void MergeU16Asc(const uint16_t* HWY_RESTRICT a, size_t na,
+                 const uint16_t* HWY_RESTRICT b, size_t nb,
+                 uint16_t* HWY_RESTRICT out) {
+  SortTag<uint16_t> d;
+  detail::SharedTraits<detail::TraitsLane<detail::OrderAscending<uint16_t>>> st;
+  Merge(d, st, a, na, b, nb, out);
+}
+
+void SortSegmentsU16Asc(uint16_t* HWY_RESTRICT keys,
+                        const size_t* HWY_RESTRICT offsets,
+                        size_t num_segments, uint16_t* HWY_RESTRICT buf) {
+  SortTag<uint16_t> d;
+  detail::SharedTraits<detail::TraitsLane<detail::OrderAscending<uint16_t>>> st;
+  SortSegments(d, st, keys, offsets, num_segments, buf);
 }
 
 // NOLINTNEXTLINE(google-readability-namespace-comments)
@@ -43,11 +81,51 @@ HWY_AFTER_NAMESPACE();
 namespace hwy {
 namespace {
 HWY_EXPORT(SortU16Asc);
+HWY_EXPORT(SortU16AscParallel);
+HWY_EXPORT(PartialSortU16Asc);
+HWY_EXPORT(SelectU16Asc);
+HWY_EXPORT(MergeU16Asc);
+HWY_EXPORT(SortSegmentsU16Asc);
 }  // namespace
 
 void Sorter::operator()(uint16_t* HWY_RESTRICT keys, size_t n,
                         SortAscending) const {
-  HWY_DYNAMIC_DISPATCH(SortU16Asc)(keys, n, Get<uint16_t>());
+  HWY_DYNAMIC_DISPATCH(SortU16Asc)
+  (keys, n, Get<uint16_t>(), detect_presorted_, /*stats=*/nullptr);
+}
+
+void Sorter::operator()(uint16_t* HWY_RESTRICT keys, size_t n,
+                        SortAscending, SortStats& stats) const {
+  HWY_DYNAMIC_DISPATCH(SortU16Asc)
+  (keys, n, Get<uint16_t>(), detect_presorted_, &stats);
+}
+
+void Sorter::operator()(uint16_t* HWY_RESTRICT keys, size_t n,
+                        SortAscending, ThreadPool& pool) const {
+  HWY_DYNAMIC_DISPATCH(SortU16AscParallel)(keys, n, pool);
+}
+
+void Sorter::PartialSort(uint16_t* HWY_RESTRICT keys, size_t n, size_t k,
+                         SortAscending) const {
+  HWY_DYNAMIC_DISPATCH(PartialSortU16Asc)(keys, n, k, Get<uint16_t>());
+}
+
+void Sorter::Select(uint16_t* HWY_RESTRICT keys, size_t n, size_t nth,
+                    SortAscending) const {
+  HWY_DYNAMIC_DISPATCH(SelectU16Asc)(keys, n, nth, Get<uint16_t>());
+}
+
+void Sorter::Merge(const uint16_t* HWY_RESTRICT a, size_t na,
+                   const uint16_t* HWY_RESTRICT b, size_t nb,
+                   uint16_t* HWY_RESTRICT out, SortAscending) const {
+  HWY_DYNAMIC_DISPATCH(MergeU16Asc)(a, na, b, nb, out);
+}
+
+void Sorter::SortSegments(uint16_t* HWY_RESTRICT keys,
+                          const size_t* HWY_RESTRICT offsets,
+                          size_t num_segments, SortAscending) const {
+  HWY_DYNAMIC_DISPATCH(SortSegmentsU16Asc)
+  (keys, offsets, num_segments, Get<uint16_t>());
 }
 
 }  // namespace hwy
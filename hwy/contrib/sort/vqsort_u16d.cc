@@ -28,11 +28,54 @@ namespace hwy {
 namespace HWY_NAMESPACE {
 
 void SortU16Desc(uint16_t* HWY_RESTRICT keys, size_t num,
-                 uint16_t* HWY_RESTRICT buf) {
+                 uint16_t* HWY_RESTRICT buf, bool detect_presorted,
+                 SortStats* stats) {
   SortTag<uint16_t> d;
   detail::SharedTraits<detail::TraitsLane<detail::OrderDescending<uint16_t>>>
       st;
-  Sort(d, st, keys, num, buf);
+  Sort(d, st, keys, num, buf, detect_presorted, stats);
+}
+
+void SortU16DescParallel(uint16_t* HWY_RESTRICT keys, size_t num,
+                         ThreadPool& pool) {
+  SortTag<uint16_t> d;
+  detail::SharedTraits<detail::TraitsLane<detail::OrderDescending<uint16_t>>>
+      st;
+  SortParallel(d, st, keys, num, pool);
+}
+
+void PartialSortU16Desc(uint16_t* HWY_RESTRICT keys, size_t num, size_t k,
+                        uint16_t* HWY_RESTRICT buf) {
+  SortTag<uint16_t> d;
+  detail::SharedTraits<detail::TraitsLane<detail::OrderDescending<uint16_t>>>
+      st;
+  PartialSort(d, st, keys, num, k, buf);
+}
+
+void SelectU16Desc(uint16_t* HWY_RESTRICT keys, size_t num, size_t nth,
+                   uint16_t* HWY_RESTRICT buf) {
+  SortTag<uint16_t> d;
+  detail::SharedTraits<detail::TraitsLane<detail::OrderDescending<uint16_t>>>
+      st;
+  Select(d, st, keys, num, nth, buf);
+}
+
+void MergeU16Desc(const uint16_t* HWY_RESTRICT a, size_t na,
+                  const uint16_t* HWY_RESTRICT b, size_t nb,
+                  uint16_t* HWY_RESTRICT out) {
+  SortTag<uint16_t> d;
+  detail::SharedTraits<detail::TraitsLane<detail::OrderDescending<uint16_t>>>
+      st;
+  Merge(d, st, a, na, b, nb, out);
+}
+
+void SortSegmentsU16Desc(uint16_t* HWY_RESTRICT keys,
+                         const size_t* HWY_RESTRICT offsets,
+                         size_t num_segments, uint16_t* HWY_RESTRICT buf) {
+  SortTag<uint16_t> d;
+  detail::SharedTraits<detail::TraitsLane<detail::OrderDescending<uint16_t>>>
+      st;
+  SortSegments(d, st, keys, offsets, num_segments, buf);
 }
 
 // NOLINTNEXTLINE(google-readability-namespace-comments)
@@ -44,11 +87,51 @@ HWY_AFTER_NAMESPACE();
 namespace hwy {
 namespace {
 HWY_EXPORT(SortU16Desc);
+HWY_EXPORT(SortU16DescParallel);
+HWY_EXPORT(PartialSortU16Desc);
+HWY_EXPORT(SelectU16Desc);
+HWY_EXPORT(MergeU16Desc);
+HWY_EXPORT(SortSegmentsU16Desc);
 }  // namespace
 
 void Sorter::operator()(uint16_t* HWY_RESTRICT keys, size_t n,
                         SortDescending) const {
-  HWY_DYNAMIC_DISPATCH(SortU16Desc)(keys, n, Get<uint16_t>());
+  HWY_DYNAMIC_DISPATCH(SortU16Desc)
+  (keys, n, Get<uint16_t>(), detect_presorted_, /*stats=*/nullptr);
+}
+
+void Sorter::operator()(uint16_t* HWY_RESTRICT keys, size_t n,
+                        SortDescending, SortStats& stats) const {
+  HWY_DYNAMIC_DISPATCH(SortU16Desc)
+  (keys, n, Get<uint16_t>(), detect_presorted_, &stats);
+}
+
+void Sorter::operator()(uint16_t* HWY_RESTRICT keys, size_t n,
+                        SortDescending, ThreadPool& pool) const {
+  HWY_DYNAMIC_DISPATCH(SortU16DescParallel)(keys, n, pool);
+}
+
+void Sorter::PartialSort(uint16_t* HWY_RESTRICT keys, size_t n, size_t k,
+                         SortDescending) const {
+  HWY_DYNAMIC_DISPATCH(PartialSortU16Desc)(keys, n, k, Get<uint16_t>());
+}
+
+void Sorter::Select(uint16_t* HWY_RESTRICT keys, size_t n, size_t nth,
+                    SortDescending) const {
+  HWY_DYNAMIC_DISPATCH(SelectU16Desc)(keys, n, nth, Get<uint16_t>());
+}
+
+void Sorter::Merge(const uint16_t* HWY_RESTRICT a, size_t na,
+                   const uint16_t* HWY_RESTRICT b, size_t nb,
+                   uint16_t* HWY_RESTRICT out, SortDescending) const {
+  HWY_DYNAMIC_DISPATCH(MergeU16Desc)(a, na, b, nb, out);
+}
+
+void Sorter::SortSegments(uint16_t* HWY_RESTRICT keys,
+                          const size_t* HWY_RESTRICT offsets,
+                          size_t num_segments, SortDescending) const {
+  HWY_DYNAMIC_DISPATCH(SortSegmentsU16Desc)
+  (keys, offsets, num_segments, Get<uint16_t>());
 }
 
 }  // namespace hwy
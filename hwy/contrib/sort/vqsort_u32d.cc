@@ -28,11 +28,54 @@ namespace hwy {
 namespace HWY_NAMESPACE {
 
 void SortU32Desc(uint32_t* HWY_RESTRICT keys, size_t num,
-                 uint32_t* HWY_RESTRICT buf) {
+                 uint32_t* HWY_RESTRICT buf, bool detect_presorted,
+                 SortStats* stats) {
   SortTag<uint32_t> d;
   detail::SharedTraits<detail::TraitsLane<detail::OrderDescending<uint32_t>>>
       st;
-  Sort(d, st, keys, num, buf);
+  Sort(d, st, keys, num, buf, detect_presorted, stats);
+}
+
+void SortU32DescParallel(uint32_t* HWY_RESTRICT keys, size_t num,
+                         ThreadPool& pool) {
+  SortTag<uint32_t> d;
+  detail::SharedTraits<detail::TraitsLane<detail::OrderDescending<uint32_t>>>
+      st;
+  SortParallel(d, st, keys, num, pool);
+}
+
+void PartialSortU32Desc(uint32_t* HWY_RESTRICT keys, size_t num, size_t k,
+                        uint32_t* HWY_RESTRICT buf) {
+  SortTag<uint32_t> d;
+  detail::SharedTraits<detail::TraitsLane<detail::OrderDescending<uint32_t>>>
+      st;
+  PartialSort(d, st, keys, num, k, buf);
+}
+
+void SelectU32Desc(uint32_t* HWY_RESTRICT keys, size_t num, size_t nth,
+                   uint32_t* HWY_RESTRICT buf) {
+  SortTag<uint32_t> d;
+  detail::SharedTraits<detail::TraitsLane<detail::OrderDescending<uint32_t>>>
+      st;
+  Select(d, st, keys, num, nth, buf);
+}
+
+void MergeU32Desc(const uint32_t* HWY_RESTRICT a, size_t na,
+                  const uint32_t* HWY_RESTRICT b, size_t nb,
+                  uint32_t* HWY_RESTRICT out) {
+  SortTag<uint32_t> d;
+  detail::SharedTraits<detail::TraitsLane<detail::OrderDescending<uint32_t>>>
+      st;
+  Merge(d, st, a, na, b, nb, out);
+}
+
+void SortSegmentsU32Desc(uint32_t* HWY_RESTRICT keys,
+                         const size_t* HWY_RESTRICT offsets,
+                         size_t num_segments, uint32_t* HWY_RESTRICT buf) {
+  SortTag<uint32_t> d;
+  detail::SharedTraits<detail::TraitsLane<detail::OrderDescending<uint32_t>>>
+      st;
+  SortSegments(d, st, keys, offsets, num_segments, buf);
 }
 
 // NOLINTNEXTLINE(google-readability-namespace-comments)
@@ -44,11 +87,51 @@ HWY_AFTER_NAMESPACE();
 namespace hwy {
 namespace {
 HWY_EXPORT(SortU32Desc);
+HWY_EXPORT(SortU32DescParallel);
+HWY_EXPORT(PartialSortU32Desc);
+HWY_EXPORT(SelectU32Desc);
+HWY_EXPORT(MergeU32Desc);
+HWY_EXPORT(SortSegmentsU32Desc);
 }  // namespace
 
 void Sorter::operator()(uint32_t* HWY_RESTRICT keys, size_t n,
                         SortDescending) const {
-  HWY_DYNAMIC_DISPATCH(SortU32Desc)(keys, n, Get<uint32_t>());
+  HWY_DYNAMIC_DISPATCH(SortU32Desc)
+  (keys, n, Get<uint32_t>(), detect_presorted_, /*stats=*/nullptr);
+}
+
+void Sorter::operator()(uint32_t* HWY_RESTRICT keys, size_t n,
+                        SortDescending, SortStats& stats) const {
+  HWY_DYNAMIC_DISPATCH(SortU32Desc)
+  (keys, n, Get<uint32_t>(), detect_presorted_, &stats);
+}
+
+void Sorter::operator()(uint32_t* HWY_RESTRICT keys, size_t n,
+                        SortDescending, ThreadPool& pool) const {
+  HWY_DYNAMIC_DISPATCH(SortU32DescParallel)(keys, n, pool);
+}
+
+void Sorter::PartialSort(uint32_t* HWY_RESTRICT keys, size_t n, size_t k,
+                         SortDescending) const {
+  HWY_DYNAMIC_DISPATCH(PartialSortU32Desc)(keys, n, k, Get<uint32_t>());
+}
+
+void Sorter::Select(uint32_t* HWY_RESTRICT keys, size_t n, size_t nth,
+                    SortDescending) const {
+  HWY_DYNAMIC_DISPATCH(SelectU32Desc)(keys, n, nth, Get<uint32_t>());
+}
+
+void Sorter::Merge(const uint32_t* HWY_RESTRICT a, size_t na,
+                   const uint32_t* HWY_RESTRICT b, size_t nb,
+                   uint32_t* HWY_RESTRICT out, SortDescending) const {
+  HWY_DYNAMIC_DISPATCH(MergeU32Desc)(a, na, b, nb, out);
+}
+
+void Sorter::SortSegments(uint32_t* HWY_RESTRICT keys,
+                          const size_t* HWY_RESTRICT offsets,
+                          size_t num_segments, SortDescending) const {
+  HWY_DYNAMIC_DISPATCH(SortSegmentsU32Desc)
+  (keys, offsets, num_segments, Get<uint32_t>());
 }
 
 }  // namespace hwy
@@ -28,10 +28,48 @@ namespace hwy {
 namespace HWY_NAMESPACE {
 
 void SortU64Asc(uint64_t* HWY_RESTRICT keys, size_t num,
-                uint64_t* HWY_RESTRICT buf) {
+                uint64_t* HWY_RESTRICT buf, bool detect_presorted,
+                SortStats* stats) {
   SortTag<uint64_t> d;
   detail::SharedTraits<detail::TraitsLane<detail::OrderAscending<uint64_t>>> st;
-  Sort(d, st, keys, num, buf);
+  Sort(d, st, keys, num, buf, detect_presorted, stats);
+}
+
+void SortU64AscParallel(uint64_t* HWY_RESTRICT keys, size_t num,
+                        ThreadPool& pool) {
+  SortTag<uint64_t> d;
+  detail::SharedTraits<detail::TraitsLane<detail::OrderAscending<uint64_t>>> st;
+  SortParallel(d, st, keys, num, pool);
+}
+
+void PartialSortU64Asc(uint64_t* HWY_RESTRICT keys, size_t num, size_t k,
+                       uint64_t* HWY_RESTRICT buf) {
+  SortTag<uint64_t> d;
+  detail::SharedTraits<detail::TraitsLane<detail::OrderAscending<uint64_t>>> st;
+  PartialSort(d, st, keys, num, k, buf);
+}
+
+void SelectU64Asc(uint64_t* HWY_RESTRICT keys, size_t num, size_t nth,
+                  uint64_t* HWY_RESTRICT buf) {
+  SortTag<uint64_t> d;
+  detail::SharedTraits<detail::TraitsLane<detail::OrderAscending<uint64_t>>> st;
+  Select(d, st, keys, num, nth, buf);
+}
+
+void MergeU64Asc(const uint64_t* HWY_RESTRICT a, size_t na,
+                 const uint64_t* HWY_RESTRICT b, size_t nb,
+                 uint64_t* HWY_RESTRICT out) {
+  SortTag<uint64_t> d;
+  detail::SharedTraits<detail::TraitsLane<detail::OrderAscending<uint64_t>>> st;
+  Merge(d, st, a, na, b, nb, out);
+}
+
+void SortSegmentsU64Asc(uint64_t* HWY_RESTRICT keys,
+                        const size_t* HWY_RESTRICT offsets,
+                        size_t num_segments, uint64_t* HWY_RESTRICT buf) {
+  SortTag<uint64_t> d;
+  detail::SharedTraits<detail::TraitsLane<detail::OrderAscending<uint64_t>>> st;
+  SortSegments(d, st, keys, offsets, num_segments, buf);
 }
 
 // NOLINTNEXTLINE(google-readability-namespace-comments)
@@ -43,11 +81,51 @@ HWY_AFTER_NAMESPACE();
 namespace hwy {
 namespace {
 HWY_EXPORT(SortU64Asc);
+HWY_EXPORT(SortU64AscParallel);
+HWY_EXPORT(PartialSortU64Asc);
+HWY_EXPORT(SelectU64Asc);
+HWY_EXPORT(MergeU64Asc);
+HWY_EXPORT(SortSegmentsU64Asc);
 }  // namespace
 
 void Sorter::operator()(uint64_t* HWY_RESTRICT keys, size_t n,
                         SortAscending) const {
-  HWY_DYNAMIC_DISPATCH(SortU64Asc)(keys, n, Get<uint64_t>());
+  HWY_DYNAMIC_DISPATCH(SortU64Asc)
+  (keys, n, Get<uint64_t>(), detect_presorted_, /*stats=*/nullptr);
+}
+
+void Sorter::operator()(uint64_t* HWY_RESTRICT keys, size_t n,
+                        SortAscending, SortStats& stats) const {
+  HWY_DYNAMIC_DISPATCH(SortU64Asc)
+  (keys, n, Get<uint64_t>(), detect_presorted_, &stats);
+}
+
+void Sorter::operator()(uint64_t* HWY_RESTRICT keys, size_t n,
+                        SortAscending, ThreadPool& pool) const {
+  HWY_DYNAMIC_DISPATCH(SortU64AscParallel)(keys, n, pool);
+}
+
+void Sorter::PartialSort(uint64_t* HWY_RESTRICT keys, size_t n, size_t k,
+                         SortAscending) const {
+  HWY_DYNAMIC_DISPATCH(PartialSortU64Asc)(keys, n, k, Get<uint64_t>());
+}
+
+void Sorter::Select(uint64_t* HWY_RESTRICT keys, size_t n, size_t nth,
+                    SortAscending) const {
+  HWY_DYNAMIC_DISPATCH(SelectU64Asc)(keys, n, nth, Get<uint64_t>());
+}
+
+void Sorter::Merge(const uint64_t* HWY_RESTRICT a, size_t na,
+                   const uint64_t* HWY_RESTRICT b, size_t nb,
+                   uint64_t* HWY_RESTRICT out, SortAscending) const {
+  HWY_DYNAMIC_DISPATCH(MergeU64Asc)(a, na, b, nb, out);
+}
+
+void Sorter::SortSegments(uint64_t* HWY_RESTRICT keys,
+                          const size_t* HWY_RESTRICT offsets,
+                          size_t num_segments, SortAscending) const {
+  HWY_DYNAMIC_DISPATCH(SortSegmentsU64Asc)
+  (keys, offsets, num_segments, Get<uint64_t>());
 }
 
 }  // namespace hwy
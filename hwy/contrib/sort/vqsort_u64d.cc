@@ -28,11 +28,54 @@ namespace hwy {
 namespace HWY_NAMESPACE {
 
 void SortU64Desc(uint64_t* HWY_RESTRICT keys, size_t num,
-                 uint64_t* HWY_RESTRICT buf) {
+                 uint64_t* HWY_RESTRICT buf, bool detect_presorted,
+                 SortStats* stats) {
   SortTag<uint64_t> d;
   detail::SharedTraits<detail::TraitsLane<detail::OrderDescending<uint64_t>>>
       st;
-  Sort(d, st, keys, num, buf);
+  Sort(d, st, keys, num, buf, detect_presorted, stats);
+}
+
+void SortU64DescParallel(uint64_t* HWY_RESTRICT keys, size_t num,
+                         ThreadPool& pool) {
+  SortTag<uint64_t> d;
+  detail::SharedTraits<detail::TraitsLane<detail::OrderDescending<uint64_t>>>
+      st;
+  SortParallel(d, st, keys, num, pool);
+}
+
+void PartialSortU64Desc(uint64_t* HWY_RESTRICT keys, size_t num, size_t k,
+                        uint64_t* HWY_RESTRICT buf) {
+  SortTag<uint64_t> d;
+  detail::SharedTraits<detail::TraitsLane<detail::OrderDescending<uint64_t>>>
+      st;
+  PartialSort(d, st, keys, num, k, buf);
+}
+
+void SelectU64Desc(uint64_t* HWY_RESTRICT keys, size_t num, size_t nth,
+                   uint64_t* HWY_RESTRICT buf) {
+  SortTag<uint64_t> d;
+  detail::SharedTraits<detail::TraitsLane<detail::OrderDescending<uint64_t>>>
+      st;
+  Select(d, st, keys, num, nth, buf);
+}
+
+void MergeU64Desc(const uint64_t* HWY_RESTRICT a, size_t na,
+                  const uint64_t* HWY_RESTRICT b, size_t nb,
+                  uint64_t* HWY_RESTRICT out) {
+  SortTag<uint64_t> d;
+  detail::SharedTraits<detail::TraitsLane<detail::OrderDescending<uint64_t>>>
+      st;
+  Merge(d, st, a, na, b, nb, out);
+}
+
+void SortSegmentsU64Desc(uint64_t* HWY_RESTRICT keys,
+                         const size_t* HWY_RESTRICT offsets,
+                         size_t num_segments, uint64_t* HWY_RESTRICT buf) {
+  SortTag<uint64_t> d;
+  detail::SharedTraits<detail::TraitsLane<detail::OrderDescending<uint64_t>>>
+      st;
+  SortSegments(d, st, keys, offsets, num_segments, buf);
 }
 
 // NOLINTNEXTLINE(google-readability-namespace-comments)
@@ -44,11 +87,51 @@ HWY_AFTER_NAMESPACE();
 namespace hwy {
 namespace {
 HWY_EXPORT(SortU64Desc);
+HWY_EXPORT(SortU64DescParallel);
+HWY_EXPORT(PartialSortU64Desc);
+HWY_EXPORT(SelectU64Desc);
+HWY_EXPORT(MergeU64Desc);
+HWY_EXPORT(SortSegmentsU64Desc);
 }  // namespace
 
 void Sorter::operator()(uint64_t* HWY_RESTRICT keys, size_t n,
                         SortDescending) const {
-  HWY_DYNAMIC_DISPATCH(SortU64Desc)(keys, n, Get<uint64_t>());
+  HWY_DYNAMIC_DISPATCH(SortU64Desc)
+  (keys, n, Get<uint64_t>(), detect_presorted_, /*stats=*/nullptr);
+}
+
+void Sorter::operator()(uint64_t* HWY_RESTRICT keys, size_t n,
+                        SortDescending, SortStats& stats) const {
+  HWY_DYNAMIC_DISPATCH(SortU64Desc)
+  (keys, n, Get<uint64_t>(), detect_presorted_, &stats);
+}
+
+void Sorter::operator()(uint64_t* HWY_RESTRICT keys, size_t n,
+                        SortDescending, ThreadPool& pool) const {
+  HWY_DYNAMIC_DISPATCH(SortU64DescParallel)(keys, n, pool);
+}
+
+void Sorter::PartialSort(uint64_t* HWY_RESTRICT keys, size_t n, size_t k,
+                         SortDescending) const {
+  HWY_DYNAMIC_DISPATCH(PartialSortU64Desc)(keys, n, k, Get<uint64_t>());
+}
+
+void Sorter::Select(uint64_t* HWY_RESTRICT keys, size_t n, size_t nth,
+                    SortDescending) const {
+  HWY_DYNAMIC_DISPATCH(SelectU64Desc)(keys, n, nth, Get<uint64_t>());
+}
+
+void Sorter::Merge(const uint64_t* HWY_RESTRICT a, size_t na,
+                   const uint64_t* HWY_RESTRICT b, size_t nb,
+                   uint64_t* HWY_RESTRICT out, SortDescending) const {
+  HWY_DYNAMIC_DISPATCH(MergeU64Desc)(a, na, b, nb, out);
+}
+
+void Sorter::SortSegments(uint64_t* HWY_RESTRICT keys,
+                          const size_t* HWY_RESTRICT offsets,
+                          size_t num_segments, SortDescending) const {
+  HWY_DYNAMIC_DISPATCH(SortSegmentsU64Desc)
+  (keys, offsets, num_segments, Get<uint64_t>());
 }
 
 }  // namespace hwy
@@ -4352,22 +4352,28 @@ HWY_INLINE Vec128<T> MaxOfLanes(hwy::SizeTag<8> /* tag */,
 template <typename T, size_t N, HWY_IF_LANE_SIZE(T, 2), HWY_IF_GE32(T, N)>
 HWY_API Vec128<T, N> MinOfLanes(hwy::SizeTag<2> /* tag */, Vec128<T, N> v) {
   const DFromV<decltype(v)> d;
-  const Repartition<int32_t, decltype(d)> d32;
-  const auto even = And(BitCast(d32, v), Set(d32, 0xFFFF));
-  const auto odd = ShiftRight<16>(BitCast(d32, v));
+  const Repartition<MakeWide<T>, decltype(d)> d32;
+  // Sign- or zero-extend both halves, depending on T.
+  const auto v32 = BitCast(d32, v);
+  const auto even = ShiftRight<16>(ShiftLeft<16>(v32));
+  const auto odd = ShiftRight<16>(v32);
   const auto min = MinOfLanes(d32, Min(even, odd));
-  // Also broadcast into odd lanes.
-  return BitCast(d, Or(min, ShiftLeft<16>(min)));
+  // Also broadcast into odd lanes; the upper half may hold sign bits.
+  const auto lower = And(min, Set(d32, 0xFFFF));
+  return BitCast(d, Or(lower, ShiftLeft<16>(min)));
 }
 template <typename T, size_t N, HWY_IF_LANE_SIZE(T, 2), HWY_IF_GE32(T, N)>
 HWY_API Vec128<T, N> MaxOfLanes(hwy::SizeTag<2> /* tag */, Vec128<T, N> v) {
   const DFromV<decltype(v)> d;
-  const Repartition<int32_t, decltype(d)> d32;
-  const auto even = And(BitCast(d32, v), Set(d32, 0xFFFF));
-  const auto odd = ShiftRight<16>(BitCast(d32, v));
+  const Repartition<MakeWide<T>, decltype(d)> d32;
+  // Sign- or zero-extend both halves, depending on T.
+  const auto v32 = BitCast(d32, v);
+  const auto even = ShiftRight<16>(ShiftLeft<16>(v32));
+  const auto odd = ShiftRight<16>(v32);
   const auto min = MaxOfLanes(d32, Max(even, odd));
-  // Also broadcast into odd lanes.
-  return BitCast(d, Or(min, ShiftLeft<16>(min)));
+  // Also broadcast into odd lanes; the upper half may hold sign bits.
+  const auto lower = And(min, Set(d32, 0xFFFF));
+  return BitCast(d, Or(lower, ShiftLeft<16>(min)));
 }
 
 }  // namespace detail
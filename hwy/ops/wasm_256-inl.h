@@ -2969,21 +2969,27 @@ HWY_INLINE Vec256<T> MaxOfLanes(hwy::SizeTag<8> /* tag */,
 // u16/i16
 template <typename T, HWY_IF_LANE_SIZE(T, 2)>
 HWY_API Vec256<T> MinOfLanes(hwy::SizeTag<2> /* tag */, Vec256<T> v) {
-  const Repartition<int32_t, Full256<T>> d32;
-  const auto even = And(BitCast(d32, v), Set(d32, 0xFFFF));
-  const auto odd = ShiftRight<16>(BitCast(d32, v));
+  const Repartition<MakeWide<T>, Full256<T>> d32;
+  // Sign- or zero-extend both halves, depending on T.
+  const auto v32 = BitCast(d32, v);
+  const auto even = ShiftRight<16>(ShiftLeft<16>(v32));
+  const auto odd = ShiftRight<16>(v32);
   const auto min = MinOfLanes(d32, Min(even, odd));
-  // Also broadcast into odd lanes.
-  return BitCast(Full256<T>(), Or(min, ShiftLeft<16>(min)));
+  // Also broadcast into odd lanes; the upper half may hold sign bits.
+  const auto lower = And(min, Set(d32, 0xFFFF));
+  return BitCast(Full256<T>(), Or(lower, ShiftLeft<16>(min)));
 }
 template <typename T, HWY_IF_LANE_SIZE(T, 2)>
 HWY_API Vec256<T> MaxOfLanes(hwy::SizeTag<2> /* tag */, Vec256<T> v) {
-  const Repartition<int32_t, Full256<T>> d32;
-  const auto even = And(BitCast(d32, v), Set(d32, 0xFFFF));
-  const auto odd = ShiftRight<16>(BitCast(d32, v));
+  const Repartition<MakeWide<T>, Full256<T>> d32;
+  // Sign- or zero-extend both halves, depending on T.
+  const auto v32 = BitCast(d32, v);
+  const auto even = ShiftRight<16>(ShiftLeft<16>(v32));
+  const auto odd = ShiftRight<16>(v32);
   const auto min = MaxOfLanes(d32, Max(even, odd));
-  // Also broadcast into odd lanes.
-  return BitCast(Full256<T>(), Or(min, ShiftLeft<16>(min)));
+  // Also broadcast into odd lanes; the upper half may hold sign bits.
+  const auto lower = And(min, Set(d32, 0xFFFF));
+  return BitCast(Full256<T>(), Or(lower, ShiftLeft<16>(min)));
 }
 
 }  // namespace detail